@@ -11,6 +11,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
 #include "ArgParser.h"
 #include "ArgParser_local.h"
 
@@ -19,19 +26,89 @@
 static int addParam(ArgParser *obj,
         VarType varType, void *dest, Val *defVal, const char *sOpt, const char *lOpt, const char *name, const char *desc);
 static char* copyStr(ArgParser *obj, const char *str);
+static void* allocArena(ArgParser *obj, size_t size, size_t align);
+static int splitWords(ArgParser *obj, PrmDef *pdef);
 static bool isOptParam(const char *sOpt, const char *lOpt);
 static bool isPosParam(const char *sOpt, const char *lOpt);
-static PrmDef* findOptionalParam(ArgParser *obj, const char *arg);
+static int addNegation(ArgParser *obj, PrmDef *pdef, const char *lOpt);
+static int addFlagBit(ArgParser *obj,
+        VarType varType, uint64_t *words, unsigned int bit, Val *defVal, char *sOpt, char *lOpt, const char *name, const char *desc);
+static int findGroup(ArgParser *obj, const char *path, size_t len, bool create);
+static bool isInGroup(ArgParser *obj, PrmDef *pdef, int group);
+static int governingGroup(ArgParser *obj, int g, int bound);
+static bool isInStruct(const char *base, size_t size, const char *field, size_t fieldLen);
+static int bindField(ArgParser *obj, PrmDef *pdef);
+static void placeFields(ArgParser *obj);
+static size_t fieldSize(PrmDef *pdef);
+static void printValue(PrmDef *pdef, FILE *fp);
+static int appendAlias(ArgParser *obj, PrmDef *pdef, const char *str, bool isNegated);
+static inline LookupKey* findOptionalParam(ArgParser *obj, const char *arg);
+static LookupKey* findOptionWithValue(ArgParser *obj, const char *arg, const char **value);
+static PrmDef* findParamByName(ArgParser *obj, const char *name);
+static PrmDef* findUniqueParam(ArgParser *obj, const char *name);
+static inline LookupKey* findKey(LookupIndex *index, const char *str);
+static int buildIndex(ArgParser *obj);
+static int buildFlagWords(ArgParser *obj);
+static int allocKeys(ArgParser *obj, LookupIndex *index, unsigned int maxKeys);
+static void addKey(LookupIndex *index, const char *str, PrmDef *pdef, bool isNegated);
+static int hashKeys(ArgParser *obj, LookupIndex *index);
+static int checkConflict(ArgParser *obj, LookupKey *key, LookupKey *other);
+static inline Namespace* findNamespace(ArgParser *obj, const char *arg);
+static int prepareNamespace(ArgParser *obj, ArgParser *sub);
+static int readSelfCmdline(ArgParser *obj, int *argc);
+static SchemaMark* markSchema(ArgParser *obj);
+static void rollbackSchema(ArgParser *obj, const SchemaMark *mark);
+static void freeIndex(LookupIndex *index);
+static inline Prefix packPrefix(const char *str);
+static inline uint64_t hashStr(const char *str);
 static int writeDefaultParams(ArgParser *obj);
-static int writeDefaultValue(PrmDef *pdef);
-static int writeArg(const char *arg, PrmDef *pdef);
-static ArgType determineArgType(const char *arg);
-static bool isHelpOption(const char *arg);
-static bool isVerOption(const char *arg);
-static int setErrorMsg(ArgParser *obj, char *fmt, ...);
-static int printHelp(ArgParser *obj, FILE *fp);
+static int addDefault(ArgParser *obj, PrmDef *pdef, const Val *val, bool isConfig);
+static void clearDefaults(ArgParser *obj);
+static void freeOverrides(DefaultOverride *defaults, unsigned int num);
+static bool checkNotShared(ArgParser *obj);
+static inline void addRest(ArgParser *obj, char **argv, int i);
+static inline int writeDefaultValue(PrmDef *pdef, const Val *defVal);
+static inline void storeFlag(PrmDef *pdef, bool value);
+static inline bool loadFlag(PrmDef *pdef);
+static int runDefaultProviders(ArgParser *obj);
+static int provideDefault(ArgParser *obj, PrmDef *pdef);
+static inline int writeArg(const char *arg, PrmDef *pdef);
+static inline int parseSigned(const char *arg, int64_t lo, int64_t hi, const Validator *check, int64_t *v);
+static inline int parseUnsigned(const char *arg, uint64_t hi, const Validator *check, uint64_t *v);
+static inline int checkString(const char *arg, const Validator *check);
+static int convertDefault(ArgParser *obj, const char *value, PrmDef *pdef, Val *val);
+static inline int convertArg(ArgParser *obj, const char *arg, PrmDef *pdef);
+static inline PrmState* stateOf(ArgParser *obj, PrmDef *pdef);
+static inline int storeArg(ArgParser *obj, const char *arg, PrmDef *pdef);
+static int setArgError(ArgParser *obj, const char *arg, PrmDef *pdef, int status);
+static Validator* validatorOf(ArgParser *obj, const char *name, PrmDef **pdef);
+static int compileCharset(const char *charset, uint64_t *charBits);
+static inline uint64_t shapeOf(int argc, char **argv);
+static int runPlan(ArgParser *obj, uint64_t shape, int argc, char **argv);
+static PlanStep* preparePlanSteps(ArgParser *obj, int argc);
+static void storePlan(ArgParser *obj, uint64_t shape, int argc, PlanStep *steps, unsigned int numSteps);
+static void clearPlans(ArgParser *obj);
+static PrmDef* getParam(ArgParser *obj, const char *name, VarType varType);
+static int convertPending(ArgParser *obj, PrmDef *pdef);
+static inline ArgType determineArgType(const char *arg);
+static inline void copyBounded(char *dest, const char *src, unsigned int size);
+static int runAction(ArgParser *obj, PrmDef *pdef, const char *arg);
+static int helpAction(ArgParser *obj, const char *arg, void *ctx);
+static int versionAction(ArgParser *obj, const char *arg, void *ctx);
+static bool checkNotShrunk(ArgParser *obj);
+static int printHelp(ArgParser *obj, FILE *fp, unsigned int width);
+static void renderHelp(ArgParser *obj, FILE *fp, unsigned int width);
+static unsigned int printParamCell(PrmDef *pdef, FILE *fp);
+static unsigned int detectWidth(FILE *fp);
+static void clearHelpCache(ArgParser *obj);
+static int searchHelp(ArgParser *obj, FILE *fp, const char *keyword);
+static int buildSearchIndex(ArgParser *obj);
+static unsigned int countWords(const char *str, size_t *textLen);
+static unsigned int addWords(const char *str, unsigned int param, char *text, SearchEntry *entries);
+static int compareEntries(const void *a, const void *b);
+static int compareParams(const void *a, const void *b);
 static int printVersion(ArgParser *obj, FILE *fp);
-static int printParamDescription(PrmDef *pdef, FILE *fp);
+static int printParamDescription(PrmDef *pdef, FILE *fp, unsigned int cellWidth, unsigned int width);
 
 
 /* Functions */
@@ -54,6 +131,8 @@ ArgParser* ArgParser_new(char *progName, char *progDesc)
         goto error;
     }
     memset(obj, 0x00, sizeof(ArgParser));
+    obj->schema   = NULL;
+    obj->refCount = 1;
 
     /* Initialize the created object. */
     obj->progName = NULL;
@@ -64,10 +143,27 @@ ArgParser* ArgParser_new(char *progName, char *progDesc)
 
     obj->numOptPrms = 0;
     obj->numPosPrms = 0;
+    obj->isShrunk   = false;
+
+    obj->isFrozen = false;
+    obj->lookupThreshold = APARSER_LINEAR_LOOKUP_MAX;
+    obj->exitOnHelp = true;
 
     obj->hasError = false;
     strcpy(obj->errorMsg, "OK.");
 
+    /* Allocate the definition tables and the string buffer. */
+    obj->optPrms   = (PrmDef *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmDef));
+    obj->posPrms   = (PrmDef *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmDef));
+    obj->optStates = (PrmState *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmState));
+    obj->posStates = (PrmState *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmState));
+    obj->buf       = (char *) malloc(APARSER_MAX_BUF);
+    if((obj->optPrms == NULL) || (obj->posPrms == NULL) || (obj->optStates == NULL) || (obj->posStates == NULL) || (obj->buf == NULL))
+    {
+        fprintf(stderr, "Error: Cannot allocate memory.\n");
+        goto error;
+    }
+
     obj->bufIdx = 0;
     obj->buf[0] = '\0';
   
@@ -98,30 +194,28 @@ ArgParser* ArgParser_new(char *progName, char *progDesc)
 
     /* Register help option. */
     v.b = false;
-    status = addParam(obj, VarType_True, &(obj->isHelpSpecified), &v, "-h", "--help",  "help", "Show help message.");
+    status = addParam(obj, VarType_Action, &(obj->isHelpSpecified), &v, "-h", "--help",  "help", "Show help message.");
     if(status != 0)
     {
-        setErrorMsg(obj, "Cannot set help option.");
+        ArgParserError_set(obj, "Cannot set help option.");
         goto error;
     }
+    obj->optPrms[obj->numOptPrms - 1].action = helpAction;
     
     /* Register version option. */
-    status = addParam(obj, VarType_True, &(obj->isVerSpecified), &v, "-v", "--version",  "version", "Show version string.");
+    status = addParam(obj, VarType_Action, &(obj->isVerSpecified), &v, "-v", "--version",  "version", "Show version string.");
     if(status != 0)
     {
-        setErrorMsg(obj, "Cannot set version option.");
+        ArgParserError_set(obj, "Cannot set version option.");
         goto error;
     }
+    obj->optPrms[obj->numOptPrms - 1].action = versionAction;
 
     return obj;
 
 error: /* error handling */
 
-    if(obj == NULL)
-        return NULL;
-
-    free(obj);
-
+    ArgParser_delete(obj);
     return NULL;
 }
 
@@ -133,8 +227,231 @@ error: /* error handling */
  */
 int ArgParser_delete(ArgParser *obj)
 {
-    free(obj);
+    if(obj == NULL)
+        return 0;
+
+    /* Release the instance data. */
+    clearPlans(obj);
+    clearHelpCache(obj);
+    free(obj->planScratch);
+    clearDefaults(obj);
+    free(obj->rest);
+    free(obj->restIdx);
+    free(obj->selfArgs);
+    free(obj->selfArgv);
+    ArgParserConfig_freeFragments(obj);
+    free(obj->cacheDeps);
+    free(obj->optStates);
+    free(obj->posStates);
+#if defined(APARSER_TRACE)
+    free(obj->trace);
+#endif
+
+    ArgParser *owner = (obj->schema != NULL) ? obj->schema : obj;
+    if(obj != owner)
+        free(obj);
+
+    /* Release the schema with the last object which shares it. */
+    owner->refCount--;
+    if(owner->refCount != 0)
+        return 0;
+
+    freeIndex(&(owner->index));
+    freeIndex(&(owner->names));
+    free(owner->flagWords);
+    free(owner->optPrms);
+    free(owner->posPrms);
+    free(owner->buf);
+    free(owner);
+    return 0;
+}
+
+
+/**
+ *  @brief Create a clone which shares the schema.
+ *         The parameter definitions, the strings and the lookup index are shared,
+ *         and only the default values changed by ArgParser_setDefault() are copied.
+ *         The parse states (given and pending values) are per object.
+ *         The clones write to the same destinations, so parse them one at a time.
+ *         The shared schema cannot be changed any more.
+ *  @param [in] schema ArgParser object to clone
+ *  @return A new ArgParser object if success, NULL otherwise.
+ */
+ArgParser* ArgParser_clone(ArgParser *schema)
+{
+    unsigned int i;
+
+    if(checkNotShrunk(schema) == false)
+        return NULL;
+
+    /* The lookup index is shared, so build it before sharing. */
+    if(schema->isFrozen == false)
+    {
+        if(ArgParser_freeze(schema) != 0)
+            return NULL;
+    }
+
+    /* Start from an empty object, so that no instance data is shared by mistake. */
+    ArgParser *obj = (ArgParser *) calloc(1, sizeof(ArgParser));
+    if(obj == NULL)
+    {
+        fprintf(stderr, "Error: Cannot allocate memory.\n");
+        return NULL;
+    }
+
+    obj->optStates = (PrmState *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmState));
+    obj->posStates = (PrmState *) calloc(APARSER_MAX_ARG_PRMS, sizeof(PrmState));
+    if((obj->optStates == NULL) || (obj->posStates == NULL))
+    {
+        fprintf(stderr, "Error: Cannot allocate memory.\n");
+        free(obj->optStates);
+        free(obj->posStates);
+        free(obj);
+        return NULL;
+    }
+
+    /* Share the definitions. */
+    obj->schema   = (schema->schema != NULL) ? schema->schema : schema;
+    obj->refCount = 0;
+
+    obj->progName = schema->progName;
+    obj->progDesc = schema->progDesc;
+    obj->version  = schema->version;
+    obj->date     = schema->date;
+    obj->author   = schema->author;
+    obj->bufIdx   = schema->bufIdx;
+    obj->buf      = schema->buf;
+
+    obj->numOptPrms = schema->numOptPrms;
+    obj->optPrms    = schema->optPrms;
+    obj->numPosPrms = schema->numPosPrms;
+    obj->posPrms    = schema->posPrms;
+
+    obj->isFrozen        = schema->isFrozen;
+    obj->lookupThreshold = schema->lookupThreshold;
+    obj->index           = schema->index;
+    obj->names           = schema->names;
+    obj->numFlagWords    = schema->numFlagWords;
+    obj->flagWords       = schema->flagWords;
+
+    obj->numNamespaces = schema->numNamespaces;
+    memcpy(obj->namespaces, schema->namespaces, sizeof(obj->namespaces));
+    memcpy(obj->nsHeads, schema->nsHeads, sizeof(obj->nsHeads));
+    obj->numGroups = schema->numGroups;
+    memcpy(obj->groups, schema->groups, sizeof(obj->groups));
+
+    /* Copy the settings. */
+    obj->exitOnHelp       = schema->exitOnHelp;
+    obj->ignoreUnknownConfig = schema->ignoreUnknownConfig;
+    obj->reqFullPosParams = schema->reqFullPosParams;
+    obj->usePlanCache     = schema->usePlanCache;
+    obj->isLazy           = schema->isLazy;
+    obj->collectRest      = schema->collectRest;
+    obj->useTelemetry     = schema->useTelemetry;
+    obj->telemetryId      = schema->telemetryId;
+
+    obj->hasError = false;
+    strcpy(obj->errorMsg, "OK.");
+
+    obj->schema->refCount++;
+
+    /* Inherit the overridden default values. */
+    for(i = 0; i < schema->numDefaults; i++)
+    {
+        if(addDefault(obj, schema->defaults[i].pdef, &(schema->defaults[i].val), schema->defaults[i].isConfig) != 0)
+        {
+            ArgParser_delete(obj);
+            return NULL;
+        }
+    }
+
+    return obj;
+}
+
+
+/**
+ *  @brief Override the default value of a parameter on this object.
+ *         The other objects sharing the schema keep their default values.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] name  Parameter name
+ *  @param [in] value Default value, in the command line format
+ *  @return Execution status
+ */
+int ArgParser_setDefault(ArgParser *obj, const char *name, const char *value)
+{
+    Val val;
+
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    PrmDef *pdef = findUniqueParam(obj, name);
+    if(pdef == NULL)
+        return 1;
+
+    if(convertDefault(obj, value, pdef, &val) != 0)
+        return 1;
+
+    return addDefault(obj, pdef, &val, false);
+}
+
+
+/**
+ *  @brief Apply a value of a config file to an option, as its default value on this object.
+ *         The command line overrides the value, and the value overrides the default value provider.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] spelling Long option spelling ("--db.pool.size")
+ *  @param [in] value    Value, in the command line format
+ *  @retval 0  Applied
+ *  @retval 1  Error
+ *  @retval -1 Unknown option (skipped)
+ */
+int ArgParserConfig_apply(ArgParser *obj, const char *spelling, const char *value)
+{
+    Val val;
+
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    /* Route the prefixed options to the schema of their namespace. */
+    ArgParser *target = obj;
+    if(obj->numNamespaces != 0)
+    {
+        Namespace *ns = findNamespace(obj, spelling);
+        if(ns != NULL)
+            target = ns->sub;
+    }
+
+    if((target->isFrozen == false) && (ArgParser_freeze(target) != 0))
+        goto error;
+
+    LookupKey *key = findOptionalParam(target, spelling);
+    if(key == NULL)
+        return -1;
+
+    PrmDef *pdef = key->pdef;
+    if(pdef->varType == VarType_Action)
+    {
+        ArgParserError_set(obj, "Cannot set the action option '%s' from a config file.", spelling);
+        return 1;
+    }
+
+    if(convertDefault(obj, value, pdef, &val) != 0)
+        return 1;
+
+    // A negated flag ("no-verbose = 1") sets the opposite value.
+    if(key->isNegated == true)
+        val.b = !val.b;
+
+    if(addDefault(target, pdef, &val, true) != 0)
+        goto error;
+
     return 0;
+
+error: /* error handling */
+
+    if(target != obj)
+        ArgParserError_set(obj, "%s", target->errorMsg);
+    return 1;
 }
 
 
@@ -151,6 +468,48 @@ int ArgParser_requireFullPosParams(ArgParser *obj)
 }
 
 
+/**
+ *  @brief Set the maximum number of option spellings searched linearly.
+ *         Schemas with more spellings are looked up through a hash table.
+ *  @param [in] obj       ArgParser object
+ *  @param [in] threshold Maximum number of spellings for the linear scan
+ *  @return Execution status
+ */
+int ArgParser_setLookupThreshold(ArgParser *obj, unsigned int threshold)
+{
+    if(checkNotShared(obj) == false)
+        return 1;
+
+    obj->lookupThreshold = threshold;
+    obj->isFrozen = false;
+    return 0;
+}
+
+
+/**
+ *  @brief Build the option lookup index.
+ *         The lookup strategy is chosen by the number of option spellings.
+ *         Invoked automatically by ArgParser_parse() if the schema has been changed.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_freeze(ArgParser *obj)
+{
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    // The shared index is built already.
+    if((obj->isFrozen == true) && (checkNotShared(obj) == false))
+        return 0;
+
+    if(buildIndex(obj) != 0)
+        return 1;
+
+    obj->isFrozen = true;
+    return 0;
+}
+
+
 /**
  *  @brief Set version string.
  *  @param [in] obj     ArgParser object
@@ -159,10 +518,13 @@ int ArgParser_requireFullPosParams(ArgParser *obj)
  */
 int ArgParser_addVersion(ArgParser *obj, char *version)
 {
+    if(checkNotShared(obj) == false)
+        return 1;
+
     obj->version = copyStr(obj, version);
     if(obj->version == NULL)
     {
-        setErrorMsg(obj, "Cannot add version string.");
+        ArgParserError_set(obj, "Cannot add version string.");
         return 1;
     }
 
@@ -178,10 +540,13 @@ int ArgParser_addVersion(ArgParser *obj, char *version)
  */
 int ArgParser_addDate(ArgParser *obj, char *date)
 {
+    if(checkNotShared(obj) == false)
+        return 1;
+
     obj->date = copyStr(obj, date);
     if(obj->date == NULL)
     {
-        setErrorMsg(obj, "Cannot add release date.");
+        ArgParserError_set(obj, "Cannot add release date.");
         return 1;
     }
 
@@ -197,10 +562,13 @@ int ArgParser_addDate(ArgParser *obj, char *date)
  */
 int ArgParser_addAuthor(ArgParser *obj, char *author)
 {
+    if(checkNotShared(obj) == false)
+        return 1;
+
     obj->author = copyStr(obj, author);
     if(obj->author == NULL)
     {
-        setErrorMsg(obj, "Cannot add author name.");
+        ArgParserError_set(obj, "Cannot add author name.");
         return 1;
     }
 
@@ -316,7 +684,7 @@ int ArgParser_addInt32(ArgParser *obj, int32_t *dest, int32_t defVal, char *sOpt
  *  @param [in] desc   Parameter description
  *  @return Execution status
  */
-int ArgParser_addUInt32(ArgParser *obj, int32_t *dest, int32_t defVal, char *sOpt, char *lOpt, const char *name, const char *desc)
+int ArgParser_addUInt32(ArgParser *obj, uint32_t *dest, uint32_t defVal, char *sOpt, char *lOpt, const char *name, const char *desc)
 {
     Val v;
     v.u32 = defVal;
@@ -381,772 +749,4784 @@ int ArgParser_addTrue(ArgParser *obj, bool *dest, char *sOpt, char *lOpt, const
 
 
 /**
- *  @brief ---
+ *  @brief Add bool-type option bound to a bit of a word array.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] words  Word array
+ *  @param [in] bit    Bit index in the array
+ *  @param [in] defVal Default value
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @param [in] name   Parameter name
+ *  @param [in] desc   Parameter description
+ *  @return Execution status
  */
-int ArgParser_rest(ArgParser *obj, int *restNum, char ***rest)
+int ArgParser_addBoolBit(ArgParser *obj, uint64_t *words, unsigned int bit, bool defVal, char *sOpt, char *lOpt, const char *name, const char *desc)
 {
-    return 0;
+    Val v;
+    v.b = defVal;
+    return addFlagBit(obj, VarType_Bool, words, bit, &v, sOpt, lOpt, name, desc);
 }
 
 
 /**
- *  @brief Parser command line arguments.
- *  @param [in] obj      ArgParser object
- *  @param [in] argc     Number of command line arguments
- *  @param [in] argv[]   Command line argument array
- *  @return Execution status
+ *  @brief Add switch-type option bound to a bit of a word array.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] words Word array
+ *  @param [in] bit   Bit index in the array
+ *  @param [in] sOpt  Short option
+ *  @param [in] lOpt  Long option
+ *  @param [in] name  Parameter name
+ *  @param [in] desc  Parameter description
+ *  @return   Execution status
  */
-int ArgParser_parse(ArgParser *obj, int argc, char **argv)
+int ArgParser_addTrueBit(ArgParser *obj, uint64_t *words, unsigned int bit, char *sOpt, char *lOpt, const char *name, const char *desc)
 {
-    int status;
-    ArgType argType;
-    int posIdx = 0;
-    int i = 1;
+    Val v;
+    v.b = false;
+    return addFlagBit(obj, VarType_True, words, bit, &v, sOpt, lOpt, name, desc);
+}
 
-    /* Write default parameter values. */
-    status = writeDefaultParams(obj);
-    if(status != 0)
-        goto error;
 
-    while(i < argc)
-    {
-        /* Determine argument type. */
-        argType = determineArgType(argv[i]);
+/**
+ *  @brief Add action-type option.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] action Action callback
+ *  @param [in] ctx    User context passed to the action
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @param [in] name   Parameter name
+ *  @param [in] desc   Parameter description
+ *  @return   Execution status
+ */
+int ArgParser_addAction(ArgParser *obj, ArgParser_ActionFn action, void *ctx, char *sOpt, char *lOpt, const char *name, const char *desc)
+{
+    Val v;
+    v.b = false;
 
-        // Invalid argument
-        if(argType == ArgType_Error)
-        {
-            setErrorMsg(obj, "Irregal argument type: Near the arg '%s'.", argv[i]);
-            goto error;
-        }
+    if(action == NULL)
+    {
+        ArgParserError_set(obj, "No action is given: '%s'.", name);
+        return 1;
+    }
 
-        // Normal argument
-        if(argType == ArgType_NoOpt)
-        {
-            // Too many positional parameters.
-            if(posIdx == obj->numPosPrms)
-            {
-                setErrorMsg(obj, "Too many positonal arguments: Near the arg '%s'. Needs %d positional args. But has more args.", argv[i], obj->numPosPrms);
-                goto error;
-            }
+    if(isOptParam(sOpt, lOpt) == false)
+    {
+        ArgParserError_set(obj, "An action needs an option spelling: '%s'.", name);
+        return 1;
+    }
 
-            // Write positional parameter to destination.
-            PrmDef *pdef = &(obj->posPrms[posIdx]);
-            if(writeArg(argv[i], pdef) != 0)
-            {
-                setErrorMsg(obj, "Invalid value: arg %s, %s", argv[i], pdef->name);
-                goto error;
-            }
-            posIdx++;
+    if(addParam(obj, VarType_Action, NULL, &v, sOpt, lOpt, name, desc) != 0)
+        return 1;
 
-            i++;
-            continue;
-        }
+    PrmDef *pdef = &(obj->optPrms[obj->numOptPrms - 1]);
+    pdef->action    = action;
+    pdef->actionCtx = ctx;
+    return 0;
+}
 
-        /* Find Option infomation */
-        PrmDef *pdef = findOptionalParam(obj, argv[i]);
-        if(pdef == NULL)
-        {
-            setErrorMsg(obj, "Unknown option: Near the arg. %s", argv[i]);
-            return 1;
-        }
 
-        /* Check if the help option is specified. */
-        if(isHelpOption(argv[i]) == true)
-        {
-            printHelp(obj, stdout);
-            exit(0);   
-        }
-        
-        /* Check if the version option is specified. */
-        if(isVerOption(argv[i]) == true)
-        {
-            printVersion(obj, stdout);
-            exit(0);   
-        }
+/**
+ *  @brief Add another spelling of an optional parameter.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] name     Parameter name
+ *  @param [in] spelling Option spelling
+ *  @return Execution status
+ */
+int ArgParser_addAlias(ArgParser *obj, const char *name, const char *spelling)
+{
+    unsigned int bufIdx = obj->bufIdx;
 
-        /* Switch-type option. */
-        if(pdef->varType == VarType_True)
-        {
-            if(writeArg("1", pdef) != 0)
-            {
-                setErrorMsg(obj, "Invalid value: arg %s, %s", argv[i], pdef->name);
-                return 1;    
-            }
-            i++;
-            continue;
-        }
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
 
-        if(i == (argc - 1))
-        {
-            setErrorMsg(obj, "Lack of the last argument: Near the arg %s.", argv[i]);
-            return 1;
-        }
-        i++;
+    PrmDef *pdef = findUniqueParam(obj, name);
+    if(pdef == NULL)
+        return 1;
 
-        if(writeArg(argv[i], pdef) != 0)
-        {
-            setErrorMsg(obj, "Invalid value: arg %s, %s", argv[i], pdef->name);
-            return 1;    
-        }
-        i++;
+    if((isOptParam(pdef->sOpt, pdef->lOpt) == false) || (spelling == NULL) || (spelling[0] != '-') || (spelling[1] == '\0'))
+    {
+        ArgParserError_set(obj, "Invalid alias: '%s' for '%s'.", (spelling != NULL) ? spelling : "", name);
+        return 1;
     }
 
-    /* Too few arguments. */
-    if((posIdx < obj->numPosPrms) && (obj->reqFullPosParams == true))
+    if(appendAlias(obj, pdef, copyStr(obj, spelling), false) != 0)
+        goto error;
+
+    if((pdef->varType == VarType_Bool) || (pdef->varType == VarType_True))
     {
-        setErrorMsg(obj, "Too few positonal arguments: Needs %d args. But has only %d args.", obj->numPosPrms, posIdx);
-        return 1;
+        if(addNegation(obj, pdef, spelling) != 0)
+            goto error;
     }
 
+    // The lookup index must be rebuilt.
+    obj->isFrozen = false;
     return 0;
 
 error: /* error handling */
+
+    // Roll back the buffer, with the aliases in it.
+    Alias **link = &(pdef->aliases);
+    while((*link != NULL) && ((char *) *link < &(obj->buf[bufIdx])))
+        link = &((*link)->next);
+    *link = NULL;
+
+    obj->bufIdx = bufIdx;
     return 1;
 }
 
 
 /**
- *  @brief Print internal variables.
- *  @param [in] obj ArgParser object
- *  @param [in] fp  Output file pointer
+ *  @brief Choose whether the help and version options terminate the process.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] exit If set, exit(0) after the help or version message.
  *  @return Execution status
  */
-int ArgParser_dump(ArgParser *obj, FILE *fp)
+int ArgParser_setExitOnHelp(ArgParser *obj, bool exit)
 {
-    fprintf(fp, "*** ArgParser ***\n");
-    fprintf(fp, "progName = '%s' \n", obj->progName);
-    fprintf(fp, "progDesc = '%s' \n", obj->progDesc);
-    fprintf(fp, "hasError = '%d' \n", obj->hasError);
-    fprintf(fp, "errorMsg = '%s' \n", obj->errorMsg);
-
+    obj->exitOnHelp = exit;
     return 0;
 }
 
 
 /**
- *  @brief Print help message.
- *  @param [in] obj ArgParser object
- *  @param [in] fp  Output file pointer
+ *  @brief Choose whether the config loaders skip the keys which are not options.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] ignore If set, the unknown keys are skipped.
  *  @return Execution status
  */
-int ArgParser_printHelp(ArgParser *obj, FILE *fp)
+int ArgParser_setIgnoreUnknownConfig(ArgParser *obj, bool ignore)
 {
-    return printHelp(obj, fp);
+    obj->ignoreUnknownConfig = ignore;
+    return 0;
 }
 
 
 /**
- *  @brief Get error message.
+ *  @brief Check if the last parse was stopped by an action.
  *  @param [in] obj ArgParser object
- *  @return Execution status
+ *  @retval true  An action stopped the parse.
+ *  @retval false The parse examined all arguments (or failed).
  */
-const char* ArgParser_getErrorMsg(ArgParser *obj)
+bool ArgParser_isStopped(ArgParser *obj)
 {
-    return obj->errorMsg;
+    return obj->isStopped;
 }
 
 
-
-
 /**
- *  @brief Add a new optional/positional parameter.
- *  @param [in] obj     ArgParser object
- *  @param [in] varType Variable type
- *  @param [in] dest    Destination
- *  @param [in] defVal  Default value
- *  @param [in] sOpt    Short option
- *  @param [in] lOpt    Long option
- *  @param [in] name    Parameter name
- *  @param [in] desc    Parameter description
- *  @return 
+ *  @brief Add an option module.
+ *         The options registered by the module are merged into the same lookup index
+ *         as the others. An option spelling or a parameter name defined by two modules
+ *         (or by a module and the application) makes the freeze step fail.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] name   Module name (used in the error messages)
+ *  @param [in] module Module function
+ *  @param [in] ctx    User context passed to the module function
+ *  @return Execution status
  */
-static int addParam(ArgParser *obj,
-        VarType varType, void *dest, Val *defVal, const char *sOpt, const char *lOpt, const char *name, const char *desc)
+int ArgParser_addModule(ArgParser *obj, const char *name, ArgParser_ModuleFn module, void *ctx)
 {
-    unsigned int bufIdx = obj->bufIdx;
-    PrmDef *pdef = NULL;
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
 
-    if(isOptParam(sOpt, lOpt) == true) // Optional parameter
+    if(obj->curModule != NULL)
     {
-        if(obj->numOptPrms >= APARSER_MAX_ARG_PRMS)
-        {
-            setErrorMsg(obj, "Maximum number of optional parameters reached.\n");
-            goto error;
-        }
-
-        pdef = &(obj->optPrms[obj->numOptPrms]);
+        ArgParserError_set(obj, "Cannot add module '%s' inside module '%s'.", name, obj->curModule);
+        return 1;
     }
-    else // Positional parameter
+
+    SchemaMark *mark = markSchema(obj);
+    if(mark == NULL)
+        return 1;
+
+    obj->curModule = copyStr(obj, name);
+    if(obj->curModule == NULL)
     {
-        if(obj->numPosPrms >= APARSER_MAX_ARG_PRMS)
-        {
-            setErrorMsg(obj, "Maximum number of positional parameters reached.\n");
-            goto error;
-        }
+        free(mark);
+        return 1;
+    }
 
-        pdef = &(obj->posPrms[obj->numPosPrms]);
+    // Tell the errors of the module from its silent failures.
+    bool hadError = obj->hasError;
+    obj->hasError = false;
+
+    int status = module(obj, ctx);
+    obj->curModule = NULL;
+
+    bool isReported = obj->hasError;
+    obj->hasError = hadError || isReported;
+    if(status != 0)
+    {
+        rollbackSchema(obj, mark);
+        if(isReported == false)
+            ArgParserError_set(obj, "Cannot add module '%s'.", name);
     }
-  
-    pdef->varType = varType;
-    pdef->dest    = dest;
-    
-    switch(varType)
+
+    free(mark);
+    return (status != 0) ? 1 : 0;
+}
+
+
+/**
+ *  @brief Set a lazily evaluated default value.
+ *         The provider runs only if the parameter is still unset after parsing,
+ *         so expensive defaults are not computed when the user overrides them.
+ *         The static default value is written before, so it stays if the provider fails.
+ *         A name shared by several parameters (of different modules) is rejected.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] name     Parameter name
+ *  @param [in] provider Default value provider
+ *  @param [in] ctx      User context passed to the provider
+ *  @return Execution status
+ */
+int ArgParser_setDefaultProvider(ArgParser *obj, const char *name, ArgParser_DefaultFn provider, void *ctx)
+{
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
+
+    PrmDef *pdef = findUniqueParam(obj, name);
+    if(pdef == NULL)
+        return 1;
+
+    if(pdef->varType == VarType_Action)
     {
-        case VarType_String:
-            pdef->defVal.s.len  = (*defVal).s.len;
-            pdef->defVal.s.data = copyStr(obj, (*defVal).s.data);
-            if(pdef->defVal.s.data == NULL)
-            {
-                setErrorMsg(obj, "Cannot store string-type default value. '%s'\n", (*defVal).s.data);
-                goto error;
-            }
-            break;
-        
-        case VarType_Int:
-            pdef->defVal.i = (*defVal).i;
-            break;
+        ArgParserError_set(obj, "The action '%s' has no value.", name);
+        return 1;
+    }
 
-        case VarType_UInt:  
-            pdef->defVal.u = (*defVal).u;
-            break;
+    pdef->defFn  = provider;
+    pdef->defCtx = ctx;
+    return 0;
+}
 
-        case VarType_Bool: 
-            pdef->defVal.b = (*defVal).b;
-            break;
 
-        case VarType_Int32: 
-            pdef->defVal.i32 = (*defVal).i32;
-            break;
+/**
+ *  @brief Enable/disable the lazy conversion mode.
+ *         In the lazy mode, ArgParser_parse() only records the value token of each parameter.
+ *         The value is converted and written to the destination on the first access through
+ *         the ArgParser_get*() functions. The command line arguments must stay alive until then.
+ *         A value which fails the conversion is reported once, and the default value is kept.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] lazy If true, the lazy mode is enabled.
+ *  @return Execution status
+ */
+int ArgParser_setLazy(ArgParser *obj, bool lazy)
+{
+    obj->isLazy = lazy;
+    return 0;
+}
 
-        case VarType_UInt32:
-            pdef->defVal.u32 = (*defVal).u32;
-            break;
 
-        case VarType_Float:
-            pdef->defVal.f = (*defVal).f;
-            break;
+/**
+ *  @brief Bind a group of dotted options to a struct.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path Group path ("db.pool")
+ *  @param [in] base Struct of the group
+ *  @param [in] size Size of the struct
+ *  @return Execution status
+ */
+int ArgParser_bindGroup(ArgParser *obj, const char *path, void *base, size_t size)
+{
+    unsigned int numGroups = obj->numGroups;
+    unsigned int i;
 
-        case VarType_Double:
-            pdef->defVal.d = (*defVal).d;
-            break;
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
 
-        case VarType_True:
-            pdef->defVal.b = false;
-            break;
+    if((base == NULL) || (size == 0))
+    {
+        ArgParserError_set(obj, "No struct is given for the group '%s'.", path);
+        return 1;
+    }
 
-        default:
+    int group = findGroup(obj, path, strlen(path), true);
+    if(group < 0)
+        return 1;
+
+    Group *gdef    = &(obj->groups[group]);
+    char  *newBase = (char *) base;
+
+    /* Check the fields which the group takes over: the destinations and the bound subgroups
+       with no bound group in between. The fields of the old struct keep their offsets. */
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        if((pdef->group == 0) || (pdef->varType == VarType_Action) || (governingGroup(obj, pdef->group - 1, group) != group))
+            continue;
+
+        bool isFit = (pdef->owner == group + 1) ?
+            isInStruct(newBase, size, newBase + pdef->offset, fieldSize(pdef)) :
+            isInStruct(newBase, size, (char *) pdef->dest, fieldSize(pdef));
+        if(isFit == false)
+        {
+            ArgParserError_set(obj, "The destination of '%s' is outside the struct bound to '%s'.", pdef->lOpt, path);
             goto error;
+        }
     }
 
-    // Short option
-    pdef->sOpt = copyStr(obj, sOpt);
-    if(pdef->sOpt == NULL)
+    for(i = group + 1; i < obj->numGroups; i++)
     {
-        setErrorMsg(obj, "Cannot store short option. '%s'\n", sOpt);
-        goto error;
+        Group *sub = &(obj->groups[i]);
+        if((sub->base == NULL) || (sub->owner != group) || (governingGroup(obj, sub->parent, group) != group))
+            continue;
+
+        if(isInStruct(newBase, size, newBase + sub->offset, sub->size) == false)
+        {
+            ArgParserError_set(obj, "The struct bound to '%s' is outside the struct bound to '%s'.", sub->path, path);
+            goto error;
+        }
     }
 
-    // Long option
-    pdef->lOpt = copyStr(obj, lOpt);
-    if(pdef->lOpt == NULL)
-        goto error;
+    /* Record the offsets in the new struct. */
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        if((pdef->group == 0) || (pdef->varType == VarType_Action) || (pdef->owner == group + 1) ||
+           (governingGroup(obj, pdef->group - 1, group) != group))
+            continue;
 
-    // Parameter name
-    pdef->name = copyStr(obj, name);
-    if(pdef->name == NULL)
-        goto error;
+        pdef->owner  = group + 1;
+        pdef->offset = (size_t) ((char *) pdef->dest - newBase);
+    }
 
-    // Parameter description 
-    pdef->desc = copyStr(obj, desc);
-    if(pdef->desc == NULL)
-        goto error;
+    for(i = group + 1; i < obj->numGroups; i++)
+    {
+        Group *sub = &(obj->groups[i]);
+        if((sub->base == NULL) || (sub->owner == group) || (governingGroup(obj, sub->parent, group) != group))
+            continue;
 
-    if(isOptParam(sOpt, lOpt) == true) // Optional parameter
-        obj->numOptPrms++;
-    else
-        obj->numPosPrms++; // Positional parameter
+        // A subgroup bound to a struct of its own stays there.
+        bool isNested = isInStruct(newBase, size, sub->base, sub->size);
+        sub->owner  = isNested ? group : -1;
+        sub->offset = isNested ? (size_t) (sub->base - newBase) : 0;
+    }
+
+    int parent = (gdef->parent < 0) ? -1 : governingGroup(obj, gdef->parent, -1);
+    bool isNested = (parent >= 0) && isInStruct(obj->groups[parent].base, obj->groups[parent].size, newBase, size);
+    gdef->owner  = isNested ? parent : -1;
+    gdef->offset = isNested ? (size_t) (newBase - obj->groups[parent].base) : 0;
+    gdef->base   = newBase;
+    gdef->size   = size;
 
+    placeFields(obj);
+
+    // The words of the bit-packed flags must be collected again.
+    obj->isFrozen = false;
     return 0;
 
 error: /* error handling */
 
-    // Roll back the temporary buffer index.
-    obj->bufIdx = bufIdx;
+    obj->numGroups = numGroups;
     return 1;
 }
 
 
 /**
- *  @brief Copy string to the internal buffer and returns the copied one.
- *         If the string is NULL, An empty string ("") is copied.
- *  @param [in] obj   ArgParser object
- *  @param [in] str   String to copy.
- *  @return   A new copied string if success, NULL otherwise.
+ *  @brief Take the default values of a group subtree from a struct.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] path     Group path
+ *  @param [in] defaults Struct of the same type as the bound one
+ *  @return Execution status
  */
-static char* copyStr(ArgParser *obj, const char *str)
+int ArgParser_setGroupDefaults(ArgParser *obj, const char *path, const void *defaults)
 {
-    const char *tmp = (str != NULL) ? str : "";
+    unsigned int i;
 
-    /* Calculate the rest of the internal buffer. */
-    int bufRest = APARSER_MAX_BUF - obj->bufIdx;
-   
-    int len = strlen(tmp) + 1 /* null termination */;
-   
-    /* Check the string size. */
-    if(bufRest < len)
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    int group = findGroup(obj, path, strlen(path), false);
+    if((group < 0) || (obj->groups[group].base == NULL))
     {
-        setErrorMsg(obj, "Cannot store the string '%s'.", tmp);
-        goto error;
+        ArgParserError_set(obj, "Unknown or unbound group: '%s'.", path);
+        return 1;
     }
 
-    /* Copy the string and returns the copied one. */
-    char *p = &(obj->buf[obj->bufIdx]);
-    strcpy(p, tmp);
-    obj->bufIdx += len;
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        if((pdef->owner == 0) || (isInGroup(obj, pdef, group) == false))
+            continue;
 
-    // fprintf(stderr, "copyStr: str= '%s' len= %d idx= %5d -> %5d\n", tmp, len, obj->bufIdx - len, obj->bufIdx);
-    return p;
+        /* Offset of the field in the struct of the group, through the nested structs.
+           (The offsets were checked against the struct sizes by ArgParser_bindGroup().) */
+        size_t offset = pdef->offset;
+        int g = pdef->owner - 1;
+        while((g != group) && (g >= 0))
+        {
+            offset += obj->groups[g].offset;
+            g = obj->groups[g].owner;
+        }
+        if(g != group) // In a struct of its own
+            continue;
 
-error: /* error handling */
+        const char *field = (const char *) defaults + offset;
+        Val val;
+        uint64_t word;
+        switch(pdef->varType)
+        {
+            case VarType_Int:    memcpy(&(val.i),   field, sizeof(int));          break;
+            case VarType_UInt:   memcpy(&(val.u),   field, sizeof(unsigned int)); break;
+            case VarType_Bool:
+            case VarType_True:
+                if(pdef->bitMask != 0)
+                {
+                    memcpy(&word, field, sizeof(uint64_t));
+                    val.b = ((word & pdef->bitMask) != 0);
+                }
+                else
+                    memcpy(&(val.b), field, sizeof(bool));
+                break;
+            case VarType_Int32:  memcpy(&(val.i32), field, sizeof(int32_t));      break;
+            case VarType_UInt32: memcpy(&(val.u32), field, sizeof(uint32_t));     break;
+            case VarType_Float:  memcpy(&(val.f),   field, sizeof(float));        break;
+            case VarType_Double: memcpy(&(val.d),   field, sizeof(double));       break;
+            case VarType_String:
+                val.s.data = (char *) field;
+                val.s.len  = pdef->defVal.s.len;
+                break;
+            default:
+                continue;
+        }
 
-    return NULL;
+        if(addDefault(obj, pdef, &val, false) != 0)
+            return 1;
+    }
+
+    return 0;
 }
 
 
 /**
- *  @brief Check if the parameter is a optional parameter.
- *  @param [in] sOpt   Short option
- *  @param [in] lOpt   Long option
- *  @retval true  The patameter is a optional patameter.
- *  @retval false The patameter is not a optional patameter.
+ *  @brief Print the values of a group subtree.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] fp   Output file pointer
+ *  @param [in] path Group path (NULL: all parameters)
+ *  @return Execution status
  */
-static bool isOptParam(const char *sOpt, const char *lOpt)
+int ArgParser_dumpGroup(ArgParser *obj, FILE *fp, const char *path)
 {
-    if((sOpt != NULL) && (strlen(sOpt) != 0))
-        return true;
+    unsigned int i;
+    int group = -1;
 
-    if((lOpt != NULL) && (strlen(lOpt) != 0))
-        return true;
+    if(checkNotShrunk(obj) == false)
+        return 1;
 
-    return false;
-}
+    if(path != NULL)
+    {
+        group = findGroup(obj, path, strlen(path), false);
+        if(group < 0)
+        {
+            ArgParserError_set(obj, "Unknown group: '%s'.", path);
+            return 1;
+        }
+    }
 
+    for(i = 0; i < obj->numOptPrms + obj->numPosPrms; i++)
+    {
+        PrmDef *pdef = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        if((pdef->varType == VarType_Action) || ((path != NULL) && (isInGroup(obj, pdef, group) == false)))
+            continue;
 
-/**
- *  @brief Check if the parameter is a positional parameter.
- *  @param [in] sOpt   Short option
- *  @param [in] lOpt   Long option
- *  @retval true  The patameter is a positional patameter.
- *  @retval false The patameter is not a positional patameter.
- */
-static bool isPosParam(const char *sOpt, const char *lOpt)
-{
-    return !isOptParam(sOpt, lOpt);
+        if(convertPending(obj, pdef) != 0)
+            return 1;
+
+        fprintf(fp, "%s = ", (pdef->group != 0) ? pdef->lOpt + 2 : pdef->name);
+        printValue(pdef, fp);
+        fprintf(fp, "\n");
+    }
+
+    return 0;
 }
 
 
 /**
- *  @brief Find optional parameters.
- *  @param [in] obj ArgParser object
- *  @param [in] arg Commend line argument.
- *  @return Parameter definition if found. NULL otherwise.
+ *  @brief Restrict a numeric parameter to a range.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] name Parameter name
+ *  @param [in] min  Minimum value (inclusive)
+ *  @param [in] max  Maximum value (inclusive)
+ *  @return Execution status
+ */
+int ArgParser_setRange(ArgParser *obj, const char *name, double min, double max)
+{
+    PrmDef *pdef = findParamByName(obj, name);
+    if((pdef != NULL) && ((pdef->varType == VarType_String) || (pdef->varType == VarType_Bool)
+                || (pdef->varType == VarType_True) || (pdef->varType == VarType_Action)))
+    {
+        ArgParserError_set(obj, "Type mismatch: the parameter '%s' is not numeric.", name);
+        return 1;
+    }
+
+    if(!(min <= max))
+    {
+        ArgParserError_set(obj, "Invalid range: [%g, %g] for '%s'.", min, max, name);
+        return 1;
+    }
+
+    Validator *check = validatorOf(obj, name, &pdef);
+    if(check == NULL)
+        return 1;
+
+    /* Round the bounds inwards, and clamp them to the type. */
+    switch(pdef->varType)
+    {
+        case VarType_Int:
+        case VarType_Int32:
+        {
+            double lo = (pdef->varType == VarType_Int) ? INT_MIN : INT32_MIN;
+            double hi = (pdef->varType == VarType_Int) ? INT_MAX : INT32_MAX;
+            min = (min < lo) ? lo : (min > hi) ? hi : min;
+            max = (max < lo) ? lo : (max > hi) ? hi : max;
+
+            check->min.i = (int64_t) min;
+            check->min.i += ((double) check->min.i < min) ? 1 : 0;
+            check->max.i = (int64_t) max;
+            check->max.i -= ((double) check->max.i > max) ? 1 : 0;
+            return 0;
+        }
+
+        case VarType_UInt:
+        case VarType_UInt32:
+        {
+            double hi = (pdef->varType == VarType_UInt) ? UINT_MAX : UINT32_MAX;
+            min = (min < 0) ? 0 : (min > hi) ? hi : min;
+            max = (max < 0) ? 0 : (max > hi) ? hi : max;
+
+            check->min.u = (uint64_t) min;
+            check->min.u += ((double) check->min.u < min) ? 1 : 0;
+            check->max.u = (uint64_t) max;
+            check->max.u -= ((double) check->max.u > max) ? 1 : 0;
+            return 0;
+        }
+
+        case VarType_Float:
+        case VarType_Double:
+            check->min.d = min;
+            check->max.d = max;
+            return 0;
+
+        default:
+            /* Unreachable */
+            return 1;
+    }
+}
+
+
+/**
+ *  @brief Restrict the length of a string parameter.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] name   Parameter name
+ *  @param [in] minLen Minimum length (inclusive)
+ *  @param [in] maxLen Maximum length (inclusive)
+ *  @return Execution status
+ */
+int ArgParser_setLength(ArgParser *obj, const char *name, unsigned int minLen, unsigned int maxLen)
+{
+    PrmDef *pdef = findParamByName(obj, name);
+    if((pdef != NULL) && (pdef->varType != VarType_String))
+    {
+        ArgParserError_set(obj, "Type mismatch: the parameter '%s' is not a string.", name);
+        return 1;
+    }
+
+    if(minLen > maxLen)
+    {
+        ArgParserError_set(obj, "Invalid length: [%u, %u] for '%s'.", minLen, maxLen, name);
+        return 1;
+    }
+
+    Validator *check = validatorOf(obj, name, &pdef);
+    if(check == NULL)
+        return 1;
+
+    check->minLen = minLen;
+    check->maxLen = maxLen;
+    return 0;
+}
+
+
+/**
+ *  @brief Restrict the characters of a string parameter.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] name    Parameter name
+ *  @param [in] charset Character class
+ *  @return Execution status
+ */
+int ArgParser_setCharset(ArgParser *obj, const char *name, const char *charset)
+{
+    uint64_t charBits[4];
+
+    PrmDef *pdef = findParamByName(obj, name);
+    if((pdef != NULL) && (pdef->varType != VarType_String))
+    {
+        ArgParserError_set(obj, "Type mismatch: the parameter '%s' is not a string.", name);
+        return 1;
+    }
+
+    if((charset == NULL) || (compileCharset(charset, charBits) != 0))
+    {
+        ArgParserError_set(obj, "Invalid character class: '%s' for '%s'.", (charset != NULL) ? charset : "", name);
+        return 1;
+    }
+
+    Validator *check = validatorOf(obj, name, &pdef);
+    if(check == NULL)
+        return 1;
+
+    const char *copy = copyStr(obj, charset);
+    if(copy == NULL)
+        return 1;
+
+    check->charset = copy;
+    memcpy(check->charBits, charBits, sizeof(charBits));
+    return 0;
+}
+
+
+/**
+ *  @brief Require a string parameter to be valid UTF-8.
+ *  @param [in] obj          ArgParser object
+ *  @param [in] name         Parameter name
+ *  @param [in] allowControl If set, the control characters are accepted.
+ *  @return Execution status
+ */
+int ArgParser_setUtf8(ArgParser *obj, const char *name, bool allowControl)
+{
+    PrmDef *pdef = findParamByName(obj, name);
+    if((pdef != NULL) && (pdef->varType != VarType_String))
+    {
+        ArgParserError_set(obj, "Type mismatch: the parameter '%s' is not a string.", name);
+        return 1;
+    }
+
+    Validator *check = validatorOf(obj, name, &pdef);
+    if(check == NULL)
+        return 1;
+
+    check->scanText     = ArgParserText_select();
+    check->allowControl = allowControl;
+    return 0;
+}
+
+
+/**
+ *  @brief Get an int-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getInt(ArgParser *obj, const char *name, int *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_Int);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(int *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get an unsigned-int-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getUInt(ArgParser *obj, const char *name, unsigned int *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_UInt);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(unsigned int *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get a string-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value (the destination buffer)
+ *  @return Execution status
+ */
+int ArgParser_getString(ArgParser *obj, const char *name, const char **value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_String);
+    if(pdef == NULL)
+        return 1;
+
+    *value = (const char *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get a bool-type or switch-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getBool(ArgParser *obj, const char *name, bool *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_Bool);
+    if(pdef == NULL)
+        return 1;
+
+    *value = loadFlag(pdef);
+    return 0;
+}
+
+
+/**
+ *  @brief Get an int32_t-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getInt32(ArgParser *obj, const char *name, int32_t *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_Int32);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(int32_t *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get a uint32_t-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getUInt32(ArgParser *obj, const char *name, uint32_t *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_UInt32);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(uint32_t *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get a float-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getFloat(ArgParser *obj, const char *name, float *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_Float);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(float *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Get a double-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getDouble(ArgParser *obj, const char *name, double *value)
+{
+    PrmDef *pdef = getParam(obj, name, VarType_Double);
+    if(pdef == NULL)
+        return 1;
+
+    *value = *(double *) pdef->dest;
+    return 0;
+}
+
+
+/**
+ *  @brief Enable/disable the parse-plan cache.
+ *         For each shape of command line (the sequence of option spellings),
+ *         the resolved parameters are cached. A later command line of the same shape
+ *         skips the argument classification and the option lookup, and goes straight
+ *         to the value conversion.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] enable If true, the plan cache is enabled.
+ *  @return Execution status
+ */
+int ArgParser_setPlanCache(ArgParser *obj, bool enable)
+{
+    obj->usePlanCache = enable;
+    if(enable == false)
+        clearPlans(obj);
+
+    return 0;
+}
+
+
+/**
+ *  @brief Route the options under a prefix to another schema.
+ *         An option which starts with the prefix ("--storage-dir" for "--storage-") is looked up
+ *         in the schema of the namespace. All namespaces are served in the same pass over argv.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] prefix Prefix, "--" and a word ending with '-'. ("--storage-")
+ *  @param [in] sub    Schema of the namespace (not owned)
+ *  @return Execution status
+ */
+int ArgParser_addNamespace(ArgParser *obj, const char *prefix, ArgParser *sub)
+{
+    unsigned int len = strlen(prefix);
+    unsigned int i;
+
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
+
+    /* The prefix is looked up by its first word, so it must be exactly one word. */
+    if((len < 4) || (strncmp(prefix, "--", 2) != 0) || (prefix[len - 1] != '-') ||
+       (memchr(prefix + 2, '-', len - 3) != NULL))
+    {
+        ArgParserError_set(obj, "Invalid namespace prefix: '%s'. (e.g. '--storage-')", prefix);
+        return 1;
+    }
+
+    if((sub == NULL) || (sub == obj))
+    {
+        ArgParserError_set(obj, "Invalid namespace schema: '%s'.", prefix);
+        return 1;
+    }
+
+    if(obj->numNamespaces >= APARSER_MAX_NAMESPACES)
+    {
+        ArgParserError_set(obj, "Maximum number of namespaces reached.");
+        return 1;
+    }
+
+    for(i = 0; i < obj->numNamespaces; i++)
+    {
+        if(strcmp(obj->namespaces[i].prefix, prefix) == 0)
+        {
+            ArgParserError_set(obj, "Namespace '%s' is already added.", prefix);
+            return 1;
+        }
+    }
+
+    Namespace *ns = &(obj->namespaces[obj->numNamespaces]);
+    ns->prefix = copyStr(obj, prefix);
+    if(ns->prefix == NULL)
+        return 1;
+
+    ns->len  = len;
+    ns->sub  = sub;
+
+    /* Chain into the prefix table. */
+    unsigned char head = (unsigned char) prefix[2];
+    ns->next = obj->nsHeads[head];
+    obj->numNamespaces++;
+    obj->nsHeads[head] = obj->numNamespaces;
+
+    return 0;
+}
+
+
+/**
+ *  @brief Collect the unknown arguments instead of failing.
+ *         Unknown options, extra positional arguments and all arguments after "--"
+ *         are kept for ArgParser_rest().
+ *  @param [in] obj    ArgParser object
+ *  @param [in] enable If true, the leftover arguments are collected.
+ *  @return Execution status
+ */
+int ArgParser_collectRest(ArgParser *obj, bool enable)
+{
+    obj->collectRest = enable;
+    return 0;
+}
+
+
+/**
+ *  @brief Get the leftover arguments of the last parse, in the order of appearance.
+ *         The array points into argv, and is valid until the next parse.
+ *  @param [in]  obj     ArgParser object
+ *  @param [out] restNum Number of leftover arguments
+ *  @param [out] rest    Leftover arguments
+ *  @return Execution status
+ */
+int ArgParser_rest(ArgParser *obj, int *restNum, char ***rest)
+{
+    *restNum = obj->restNum;
+    *rest    = obj->rest;
+    return 0;
+}
+
+
+/**
+ *  @brief Make room for the leftover arguments of a command line.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argc Number of command line arguments
+ *  @return Execution status
+ */
+int ArgParserRest_reserve(ArgParser *obj, int argc)
+{
+    if(obj->restLen >= (unsigned int) argc)
+        return 0;
+
+    char **rest = (char **) realloc(obj->rest, sizeof(char *) * argc);
+    if(rest != NULL)
+        obj->rest = rest;
+
+    int32_t *restIdx = (int32_t *) realloc(obj->restIdx, sizeof(int32_t) * argc);
+    if(restIdx != NULL)
+        obj->restIdx = restIdx;
+
+    if((rest == NULL) || (restIdx == NULL))
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        return 1;
+    }
+
+    obj->restLen = argc;
+    return 0;
+}
+
+
+/**
+ *  @brief Collect a leftover argument, with its index for the parse cache.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argv Command line argument array
+ *  @param [in] i    Index of the argument
+ */
+static inline void addRest(ArgParser *obj, char **argv, int i)
+{
+    obj->restIdx[obj->restNum] = i;
+    obj->rest[obj->restNum++]  = argv[i];
+}
+
+
+/**
+ *  @brief Parser command line arguments.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] argc     Number of command line arguments
+ *  @param [in] argv[]   Command line argument array
+ *  @return Execution status
+ */
+int ArgParser_parse(ArgParser *obj, int argc, char **argv)
+{
+    int status;
+    ArgType argType;
+    int posIdx = 0;
+    int i = 1;
+    uint64_t shape = 0;
+    PlanStep *steps = NULL;
+    unsigned int numSteps = 0;
+    unsigned int n;
+
+    if(checkNotShrunk(obj) == false)
+        goto error;
+
+    /* Build the lookup index. */
+    if(obj->isFrozen == false)
+    {
+        status = ArgParser_freeze(obj);
+        if(status != 0)
+            goto error;
+    }
+    obj->isStopped = false;
+
+    /* Prepare the buffer of the leftover arguments. */
+    obj->restNum = 0;
+    if((obj->collectRest == true) && (ArgParserRest_reserve(obj, argc) != 0))
+        goto error;
+
+    /* Replay the cached plan of the same shape, or record a new one. */
+    if((obj->usePlanCache == true) && (obj->numNamespaces == 0) && (obj->collectRest == false))
+    {
+        shape = shapeOf(argc, argv);
+        status = runPlan(obj, shape, argc, argv);
+        if((status == 0) && (obj->useTelemetry == true))
+            ArgParserTelemetry_record(obj);
+        if(status >= 0)
+            return status;
+
+        steps = preparePlanSteps(obj, argc);
+    }
+
+    /* Write default parameter values. */
+    APARSER_TRACE_BEGIN(obj, tDefaults);
+    status = writeDefaultParams(obj);
+    if(status != 0)
+        goto error;
+    APARSER_TRACE_END(obj, tDefaults, TracePhase_Defaults, -1, NULL);
+
+    for(n = 0; n < obj->numNamespaces; n++)
+    {
+        if(prepareNamespace(obj, obj->namespaces[n].sub) != 0)
+            goto error;
+    }
+
+    while(i < argc)
+    {
+        /* Determine argument type. */
+        APARSER_TRACE_BEGIN(obj, tClassify);
+        argType = determineArgType(argv[i]);
+        APARSER_TRACE_END(obj, tClassify, TracePhase_Classify, i, argv[i]);
+
+        // Leftover arguments after '--'
+        if((obj->collectRest == true) && (strcmp(argv[i], "--") == 0))
+        {
+            for(i++; i < argc; i++)
+                addRest(obj, argv, i);
+            break;
+        }
+
+        // Invalid argument
+        if(argType == ArgType_Error)
+        {
+            ArgParserError_set(obj, "Irregal argument type: Near the arg '%s'.", argv[i]);
+            goto error;
+        }
+
+        // Normal argument
+        if(argType == ArgType_NoOpt)
+        {
+            // Too many positional parameters.
+            if(posIdx == obj->numPosPrms)
+            {
+                if(obj->collectRest == true)
+                {
+                    addRest(obj, argv, i);
+                    i++;
+                    continue;
+                }
+
+                ArgParserError_set(obj, "Too many positonal arguments: Near the arg '%s'. Needs %d positional args. But has more args.", argv[i], obj->numPosPrms);
+                goto error;
+            }
+
+            // Write positional parameter to destination.
+            PrmDef *pdef = &(obj->posPrms[posIdx]);
+            APARSER_TRACE_BEGIN(obj, tConvert);
+            status = storeArg(obj, argv[i], pdef);
+            APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i, argv[i]);
+            if(status != ArgStatus_OK)
+            {
+                setArgError(obj, argv[i], pdef, status);
+                goto error;
+            }
+            posIdx++;
+
+            if(steps != NULL)
+            {
+                steps[numSteps].pdef      = pdef;
+                steps[numSteps].spelling  = NULL;
+                steps[numSteps].isNegated = false;
+                numSteps++;
+            }
+
+            i++;
+            continue;
+        }
+
+        /* Route the prefixed options to the schema of their namespace. */
+        APARSER_TRACE_BEGIN(obj, tLookup);
+        ArgParser *target = obj;
+        if(obj->numNamespaces != 0)
+        {
+            Namespace *ns = findNamespace(obj, argv[i]);
+            if(ns != NULL)
+                target = ns->sub;
+        }
+
+        /* Find Option infomation */
+        const char *value = NULL;
+        LookupKey *key = findOptionalParam(target, argv[i]);
+        if((key == NULL) && (argv[i][1] == '-'))
+            key = findOptionWithValue(target, argv[i], &value);
+        APARSER_TRACE_END(obj, tLookup, TracePhase_Lookup, i, argv[i]);
+
+        if(key == NULL)
+        {
+            if(obj->collectRest == true)
+            {
+                addRest(obj, argv, i);
+                i++;
+                continue;
+            }
+
+            ArgParserError_set(obj, "Unknown option: Near the arg. %s", argv[i]);
+            return 1;
+        }
+
+        PrmDef *pdef = key->pdef;
+
+        // The plans replay the spellings only, not "--option=value".
+        if(value != NULL)
+            steps = NULL;
+
+        if(steps != NULL)
+        {
+            steps[numSteps].pdef      = pdef;
+            steps[numSteps].spelling  = key->str;
+            steps[numSteps].isNegated = key->isNegated;
+            numSteps++;
+        }
+
+        /* Negated flag. ("--no-verbose") */
+        if(key->isNegated == true)
+        {
+            APARSER_TRACE_BEGIN(obj, tConvert);
+            status = (value == NULL) ? convertArg(target, "0", pdef) : ArgStatus_Invalid;
+            APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i, argv[i]);
+            if(status != ArgStatus_OK)
+            {
+                setArgError(obj, argv[i], pdef, status);
+                return 1;
+            }
+            i++;
+            continue;
+        }
+
+        /* Action-type option. */
+        if(pdef->varType == VarType_Action)
+        {
+            status = runAction(target, pdef, value);
+            if(status == ArgParserAction_Stop)
+            {
+                // The given parameters are kept, and the rest still gets its defaults.
+                obj->isStopped = true;
+                break;
+            }
+
+            if(status != ArgParserAction_Continue)
+            {
+                ArgParserError_set(obj, "Action failed: Near the arg %s.", argv[i]);
+                return 1;
+            }
+            i++;
+            continue;
+        }
+
+        /* Switch-type option. */
+        if(pdef->varType == VarType_True)
+        {
+            APARSER_TRACE_BEGIN(obj, tConvert);
+            status = convertArg(target, (value != NULL) ? value : "1", pdef);
+            APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i, argv[i]);
+            if(status != ArgStatus_OK)
+            {
+                setArgError(obj, argv[i], pdef, status);
+                return 1;    
+            }
+            i++;
+            continue;
+        }
+
+        if(value != NULL)
+        {
+            APARSER_TRACE_BEGIN(obj, tConvert);
+            status = storeArg(target, value, pdef);
+            APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i, argv[i]);
+            if(status != ArgStatus_OK)
+            {
+                setArgError(obj, value, pdef, status);
+                return 1;
+            }
+            i++;
+            continue;
+        }
+
+        if(i == (argc - 1))
+        {
+            ArgParserError_set(obj, "Lack of the last argument: Near the arg %s.", argv[i]);
+            return 1;
+        }
+        i++;
+
+        APARSER_TRACE_BEGIN(obj, tConvert);
+        status = storeArg(target, argv[i], pdef);
+        APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i, argv[i]);
+        if(status != ArgStatus_OK)
+        {
+            setArgError(obj, argv[i], pdef, status);
+            return 1;    
+        }
+        i++;
+    }
+
+    /* Too few arguments. */
+    if((posIdx < obj->numPosPrms) && (obj->reqFullPosParams == true) && (obj->isStopped == false))
+    {
+        ArgParserError_set(obj, "Too few positonal arguments: Needs %d args. But has only %d args.", obj->numPosPrms, posIdx);
+        return 1;
+    }
+
+    /* Evaluate the lazy defaults of the unset parameters. */
+    APARSER_TRACE_BEGIN(obj, tProviders);
+    status = runDefaultProviders(obj);
+    if(status != 0)
+        goto error;
+    APARSER_TRACE_END(obj, tProviders, TracePhase_Providers, -1, NULL);
+
+    for(n = 0; n < obj->numNamespaces; n++)
+    {
+        ArgParser *sub = obj->namespaces[n].sub;
+        if(runDefaultProviders(sub) != 0)
+        {
+            ArgParserError_set(obj, "%s", sub->errorMsg);
+            goto error;
+        }
+    }
+
+    // A stopped parse did not look at all the arguments.
+    if((steps != NULL) && (obj->isStopped == false))
+        storePlan(obj, shape, argc, steps, numSteps);
+
+    if(obj->useTelemetry == true)
+        ArgParserTelemetry_record(obj);
+
+    return 0;
+
+error: /* error handling */
+    return 1;
+}
+
+
+/**
+ *  @brief Parse the command line of the own process, read from /proc/self/cmdline.
+ *         For libraries and static constructors which have no access to argv.
+ *         The arguments are kept by the object until it is deleted or parses itself again.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_parseSelf(ArgParser *obj)
+{
+    int argc = 0;
+
+    if(readSelfCmdline(obj, &argc) != 0)
+        return 1;
+
+    return ArgParser_parse(obj, argc, obj->selfArgv);
+}
+
+
+/**
+ *  @brief Print internal variables.
+ *  @param [in] obj ArgParser object
+ *  @param [in] fp  Output file pointer
+ *  @return Execution status
+ */
+int ArgParser_dump(ArgParser *obj, FILE *fp)
+{
+    fprintf(fp, "*** ArgParser ***\n");
+    fprintf(fp, "progName = '%s' \n", obj->progName);
+    fprintf(fp, "progDesc = '%s' \n", obj->progDesc);
+    fprintf(fp, "hasError = '%d' \n", obj->hasError);
+    fprintf(fp, "errorMsg = '%s' \n", obj->errorMsg);
+
+    return 0;
+}
+
+
+/**
+ *  @brief Print help message.
+ *  @param [in] obj ArgParser object
+ *  @param [in] fp  Output file pointer
+ *  @return Execution status
+ */
+int ArgParser_printHelp(ArgParser *obj, FILE *fp)
+{
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    return printHelp(obj, fp, 0);
+}
+
+
+/**
+ *  @brief Print help message laid out for a terminal width.
+ *         The rendered message is cached for each width.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] fp    Output file pointer
+ *  @param [in] width Terminal width (0: $COLUMNS, the terminal size of fp, or 80)
+ *  @return Execution status
+ */
+int ArgParser_printHelpWidth(ArgParser *obj, FILE *fp, unsigned int width)
+{
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    return printHelp(obj, fp, width);
+}
+
+
+/**
+ *  @brief Print help message of the parameters matching a keyword.
+ *         The keyword is matched case-insensitively against the beginning of the words
+ *         in the names, the descriptions and the spellings. ("--help=<keyword>" does the same.)
+ *  @param [in] obj     ArgParser object
+ *  @param [in] fp      Output file pointer
+ *  @param [in] keyword Keyword
+ *  @return Execution status
+ */
+int ArgParser_searchHelp(ArgParser *obj, FILE *fp, const char *keyword)
+{
+    if(checkNotShrunk(obj) == false)
+        return 1;
+
+    return searchHelp(obj, fp, keyword);
+}
+
+
+/**
+ *  @brief Get the memory usage.
+ *  @param [in]  obj   ArgParser object
+ *  @param [out] usage Memory usage breakdown
+ *  @return Execution status
+ */
+int ArgParser_memoryUsage(ArgParser *obj, ArgParserMemUsage *usage)
+{
+    unsigned int i;
+
+    memset(usage, 0x00, sizeof(ArgParserMemUsage));
+    usage->object = sizeof(ArgParser);
+
+    if(obj->isShrunk == false)
+    {
+        usage->tables    = 2 * APARSER_MAX_ARG_PRMS * (sizeof(PrmDef) + sizeof(PrmState));
+        usage->arena     = APARSER_MAX_BUF;
+        usage->arenaUsed = obj->bufIdx;
+
+        /* Help text: program and parameter descriptions. */
+        usage->help = strlen(obj->progDesc) + 1;
+        for(i = 0; i < obj->numOptPrms; i++)
+            usage->help += strlen(obj->optPrms[i].name) + strlen(obj->optPrms[i].desc) + 2;
+        for(i = 0; i < obj->numPosPrms; i++)
+            usage->help += strlen(obj->posPrms[i].name) + strlen(obj->posPrms[i].desc) + 2;
+    }
+
+    LookupIndex *indexes[2] = { &(obj->index), &(obj->names) };
+    for(i = 0; i < 2; i++)
+    {
+        if(indexes[i]->type == LookupType_None)
+            continue;
+
+        usage->index += indexes[i]->numKeys * (sizeof(Prefix) + sizeof(LookupKey));
+        usage->index += indexes[i]->numSlots * sizeof(uint16_t);
+    }
+
+    /* A clone owns its parse states only; the rest of the schema is charged to the owner. */
+    if(obj->schema != NULL)
+    {
+        size_t states = 2 * APARSER_MAX_ARG_PRMS * sizeof(PrmState);
+        usage->shared    = usage->tables - states + usage->arena + usage->index;
+        usage->tables    = states;
+        usage->arena     = 0;
+        usage->arenaUsed = 0;
+        usage->index     = 0;
+        usage->help      = 0;
+    }
+
+    usage->plans = obj->planScratchLen * sizeof(PlanStep);
+    for(i = 0; i < APARSER_PLAN_CACHE_SIZE; i++)
+        usage->plans += obj->plans[i].numSteps * sizeof(PlanStep);
+
+    usage->defaults = obj->defaultsLen * sizeof(DefaultOverride);
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        if(obj->defaults[i].pdef->varType == VarType_String)
+            usage->defaults += strlen(obj->defaults[i].val.s.data) + 1;
+    }
+
+    for(i = 0; i < APARSER_HELP_CACHE_SIZE; i++)
+        usage->helpCache += obj->helpCache[i].len;
+
+    if(obj->search != NULL)
+        usage->helpCache += (obj->numSearch + 1) * sizeof(SearchEntry) + obj->searchTextLen;
+
+    usage->total = usage->object + usage->tables + usage->arena + usage->index + usage->plans + usage->defaults + usage->helpCache;
+    return 0;
+}
+
+
+/**
+ *  @brief Release the parameter definitions, the lookup index and the help text.
+ *         Call after the final parse. The destinations keep their values, and
+ *         ArgParser_getErrorMsg() stays available. The other functions fail afterward.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_shrink(ArgParser *obj)
+{
+    unsigned int i;
+
+    if(obj->isShrunk == true)
+        return 0;
+
+    if(checkNotShared(obj) == false)
+        return 1;
+
+    /* Convert the pending values of the lazy mode, since the definitions go away. */
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        if(convertPending(obj, &(obj->optPrms[i])) != 0)
+            return 1;
+    }
+
+    for(i = 0; i < obj->numPosPrms; i++)
+    {
+        if(convertPending(obj, &(obj->posPrms[i])) != 0)
+            return 1;
+    }
+
+    freeIndex(&(obj->index));
+    freeIndex(&(obj->names));
+    free(obj->flagWords);
+    obj->flagWords    = NULL;
+    obj->numFlagWords = 0;
+    clearPlans(obj);
+    clearDefaults(obj);
+    clearHelpCache(obj);
+
+    free(obj->planScratch);
+    obj->planScratch    = NULL;
+    obj->planScratchLen = 0;
+
+    free(obj->optPrms);
+    free(obj->posPrms);
+    free(obj->optStates);
+    free(obj->posStates);
+    free(obj->buf);
+    obj->optPrms   = NULL;
+    obj->posPrms   = NULL;
+    obj->optStates = NULL;
+    obj->posStates = NULL;
+    obj->buf       = NULL;
+
+    obj->numOptPrms = 0;
+    obj->numPosPrms = 0;
+    obj->bufIdx     = 0;
+
+    // The strings lived in the released buffer.
+    obj->progName = "";
+    obj->progDesc = "";
+    obj->version  = "";
+    obj->date     = "";
+    obj->author   = "";
+
+    obj->isFrozen = false;
+    obj->isShrunk = true;
+    return 0;
+}
+
+
+/**
+ *  @brief Get error message.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+const char* ArgParser_getErrorMsg(ArgParser *obj)
+{
+    return obj->errorMsg;
+}
+
+
+
+
+/**
+ *  @brief Add a new optional/positional parameter.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] varType Variable type
+ *  @param [in] dest    Destination
+ *  @param [in] defVal  Default value
+ *  @param [in] sOpt    Short option
+ *  @param [in] lOpt    Long option
+ *  @param [in] name    Parameter name
+ *  @param [in] desc    Parameter description
+ *  @return 
+ */
+static int addParam(ArgParser *obj,
+        VarType varType, void *dest, Val *defVal, const char *sOpt, const char *lOpt, const char *name, const char *desc)
+{
+    unsigned int bufIdx    = obj->bufIdx;
+    unsigned int numGroups = obj->numGroups;
+    PrmDef *pdef = NULL;
+
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return 1;
+
+    if(isOptParam(sOpt, lOpt) == true) // Optional parameter
+    {
+        if(obj->numOptPrms >= APARSER_MAX_ARG_PRMS)
+        {
+            ArgParserError_set(obj, "Maximum number of optional parameters reached.\n");
+            goto error;
+        }
+
+        pdef = &(obj->optPrms[obj->numOptPrms]);
+    }
+    else // Positional parameter
+    {
+        if(obj->numPosPrms >= APARSER_MAX_ARG_PRMS)
+        {
+            ArgParserError_set(obj, "Maximum number of positional parameters reached.\n");
+            goto error;
+        }
+
+        pdef = &(obj->posPrms[obj->numPosPrms]);
+    }
+  
+    pdef->varType = varType;
+    pdef->dest    = dest;
+    pdef->bitMask = 0;
+    pdef->module  = obj->curModule;
+    pdef->action  = NULL;
+    pdef->check   = NULL;
+    pdef->aliases = NULL;
+    pdef->group   = 0;
+    pdef->owner   = 0;
+    pdef->offset  = 0;
+    
+    switch(varType)
+    {
+        case VarType_String:
+            pdef->defVal.s.len  = (*defVal).s.len;
+            pdef->defVal.s.data = copyStr(obj, (*defVal).s.data);
+            if(pdef->defVal.s.data == NULL)
+            {
+                ArgParserError_set(obj, "Cannot store string-type default value. '%s'\n", (*defVal).s.data);
+                goto error;
+            }
+            break;
+        
+        case VarType_Int:
+            pdef->defVal.i = (*defVal).i;
+            break;
+
+        case VarType_UInt:  
+            pdef->defVal.u = (*defVal).u;
+            break;
+
+        case VarType_Bool: 
+            pdef->defVal.b = (*defVal).b;
+            break;
+
+        case VarType_Int32: 
+            pdef->defVal.i32 = (*defVal).i32;
+            break;
+
+        case VarType_UInt32:
+            pdef->defVal.u32 = (*defVal).u32;
+            break;
+
+        case VarType_Float:
+            pdef->defVal.f = (*defVal).f;
+            break;
+
+        case VarType_Double:
+            pdef->defVal.d = (*defVal).d;
+            break;
+
+        case VarType_True:
+        case VarType_Action:
+            pdef->defVal.b = false;
+            break;
+
+        default:
+            goto error;
+    }
+
+    // Short option
+    pdef->sOpt = copyStr(obj, sOpt);
+    if(pdef->sOpt == NULL)
+    {
+        ArgParserError_set(obj, "Cannot store short option. '%s'\n", sOpt);
+        goto error;
+    }
+
+    // Long option
+    pdef->lOpt = copyStr(obj, lOpt);
+    if(pdef->lOpt == NULL)
+        goto error;
+
+    // Parameter name
+    pdef->name = copyStr(obj, name);
+    if(pdef->name == NULL)
+        goto error;
+
+    // Parameter description 
+    pdef->desc = copyStr(obj, desc);
+    if(pdef->desc == NULL)
+        goto error;
+
+    // Word breaks for the help layout
+    if(splitWords(obj, pdef) != 0)
+        goto error;
+
+    // Negated spelling of the flags ("--no-verbose")
+    if((varType == VarType_Bool) || (varType == VarType_True))
+    {
+        if(addNegation(obj, pdef, pdef->lOpt) != 0)
+            goto error;
+    }
+
+    // Group of the dotted long option ("--db.pool.size" is in "db.pool")
+    const char *dot = strrchr(pdef->lOpt, '.');
+    if((strncmp(pdef->lOpt, "--", 2) == 0) && (dot != NULL) && (dot > pdef->lOpt + 2))
+    {
+        int group = findGroup(obj, pdef->lOpt + 2, dot - (pdef->lOpt + 2), true);
+        if(group < 0)
+            goto error;
+        pdef->group = group + 1;
+    }
+
+    // Field of the bound struct
+    if(bindField(obj, pdef) != 0)
+        goto error;
+
+    if(isOptParam(sOpt, lOpt) == true) // Optional parameter
+        obj->numOptPrms++;
+    else
+        obj->numPosPrms++; // Positional parameter
+
+    // The lookup index must be rebuilt, and the help rendered again.
+    obj->isFrozen = false;
+    clearHelpCache(obj);
+
+    return 0;
+
+error: /* error handling */
+
+    // Roll back the temporary buffer index, and the groups made for the parameter.
+    obj->bufIdx    = bufIdx;
+    obj->numGroups = numGroups;
+    return 1;
+}
+
+
+/**
+ *  @brief Add a bool-type or switch-type parameter bound to a bit of a word array.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] varType Variable type (VarType_Bool or VarType_True)
+ *  @param [in] words   Word array
+ *  @param [in] bit     Bit index in the array
+ *  @param [in] defVal  Default value
+ *  @param [in] sOpt    Short option
+ *  @param [in] lOpt    Long option
+ *  @param [in] name    Parameter name
+ *  @param [in] desc    Parameter description
+ *  @return Execution status
+ */
+static int addFlagBit(ArgParser *obj,
+        VarType varType, uint64_t *words, unsigned int bit, Val *defVal, char *sOpt, char *lOpt, const char *name, const char *desc)
+{
+    unsigned int i;
+
+    if(words == NULL)
+    {
+        ArgParserError_set(obj, "No word array is given: '%s'.", name);
+        return 1;
+    }
+
+    // A bit holds one flag.
+    uint64_t *word = &(words[bit / 64]);
+    uint64_t  mask = (uint64_t) 1 << (bit % 64);
+    for(i = 0; i < obj->numOptPrms + obj->numPosPrms; i++)
+    {
+        PrmDef *other = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        if((other->bitMask == mask) && (other->dest == word))
+        {
+            ArgParserError_set(obj, "The bit %u of the words is already bound to '%s': '%s'.", bit, other->name, name);
+            return 1;
+        }
+    }
+
+    if(addParam(obj, varType, word, defVal, sOpt, lOpt, name, desc) != 0)
+        return 1;
+
+    PrmDef *pdef = (isOptParam(sOpt, lOpt) == true) ? &(obj->optPrms[obj->numOptPrms - 1]) : &(obj->posPrms[obj->numPosPrms - 1]);
+    pdef->bitMask = mask;
+    return 0;
+}
+
+
+/**
+ *  @brief Add the negated spelling of a long option. ("--verbose" to "--no-verbose")
+ *         Short options, and spellings too long for APARSER_MAX_SPELLING, have none.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @param [in] lOpt Long option
+ *  @return Execution status
+ */
+static int addNegation(ArgParser *obj, PrmDef *pdef, const char *lOpt)
+{
+    char spelling[APARSER_MAX_SPELLING];
+
+    if((lOpt == NULL) || (strncmp(lOpt, "--", 2) != 0) || (lOpt[2] == '\0'))
+        return 0;
+
+    int len = snprintf(spelling, sizeof(spelling), "--no-%s", lOpt + 2);
+    if((len < 0) || ((size_t) len >= sizeof(spelling)))
+        return 0;
+
+    return appendAlias(obj, pdef, copyStr(obj, spelling), true);
+}
+
+
+/**
+ *  @brief Append an alias to a parameter.
+ *  @param [in] obj       ArgParser object
+ *  @param [in] pdef      Parameter definition
+ *  @param [in] str       Spelling copied into the buffer (NULL: the copy failed)
+ *  @param [in] isNegated If set, the spelling clears the flag.
+ *  @return Execution status
+ */
+static int appendAlias(ArgParser *obj, PrmDef *pdef, const char *str, bool isNegated)
+{
+    if(str == NULL)
+        return 1;
+
+    Alias *alias = (Alias *) allocArena(obj, sizeof(Alias), sizeof(void *));
+    if(alias == NULL)
+        return 1;
+
+    alias->str       = str;
+    alias->isNegated = isNegated;
+    alias->next      = NULL;
+
+    // Keep the registration order.
+    Alias **link = &(pdef->aliases);
+    while(*link != NULL)
+        link = &((*link)->next);
+    *link = alias;
+
+    return 0;
+}
+
+
+/**
+ *  @brief Find a group by its path, segment by segment.
+ *         The hash of the path is continued over each segment, and each segment is looked up
+ *         among the children of the previous one.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] path   Group path ("db.pool")
+ *  @param [in] len    Length of the path
+ *  @param [in] create If set, the missing groups are added.
+ *  @return Group index if found, negative otherwise.
+ */
+static int findGroup(ArgParser *obj, const char *path, size_t len, bool create)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a, as hashStr()
+    int parent = -1;
+    size_t i;
+    unsigned int g;
+
+    if((len == 0) || (len > UINT16_MAX))
+    {
+        ArgParserError_set(obj, "Invalid group path: '%.*s'.", (int) len, path);
+        return -1;
+    }
+
+    for(i = 0; i <= len; i++)
+    {
+        if((i < len) && (path[i] != '.'))
+        {
+            hash = (hash ^ (unsigned char) path[i]) * 0x100000001b3ULL;
+            continue;
+        }
+
+        /* End of a segment. Find the child of the previous group. */
+        for(g = (parent < 0) ? 0 : parent + 1; g < obj->numGroups; g++)
+        {
+            Group *group = &(obj->groups[g]);
+            if((group->hash == hash) && (group->parent == parent) && (group->pathLen == i) &&
+               (strncmp(group->path, path, i) == 0))
+                break;
+        }
+
+        if(g == obj->numGroups)
+        {
+            if(create == false)
+                return -1;
+
+            if(obj->numGroups == APARSER_MAX_GROUPS)
+            {
+                ArgParserError_set(obj, "Maximum number of option groups reached.");
+                return -1;
+            }
+
+            char *copy = (char *) allocArena(obj, i + 1, 1);
+            if(copy == NULL)
+                return -1;
+            memcpy(copy, path, i);
+            copy[i] = '\0';
+
+            Group *group = &(obj->groups[g]);
+            group->path    = copy;
+            group->pathLen = i;
+            group->parent  = parent;
+            group->owner   = -1;
+            group->hash    = hash;
+            group->base    = NULL;
+            group->size    = 0;
+            group->offset  = 0;
+            obj->numGroups++;
+        }
+
+        parent = g;
+        hash = (hash ^ '.') * 0x100000001b3ULL;
+    }
+
+    return parent;
+}
+
+
+/**
+ *  @brief Check if a parameter is in the subtree of a group.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] pdef  Parameter definition
+ *  @param [in] group Group index
+ *  @retval true  The parameter is in the subtree.
+ *  @retval false Otherwise.
+ */
+static bool isInGroup(ArgParser *obj, PrmDef *pdef, int group)
+{
+    int g = (int) pdef->group - 1;
+
+    // The parents precede their children.
+    while(g > group)
+        g = obj->groups[g].parent;
+
+    return (g == group);
+}
+
+
+/**
+ *  @brief Find the bound group which governs a group: the group itself or its nearest bound ancestor.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] g     Group index
+ *  @param [in] bound Group index taken as bound (-1: none)
+ *  @return Group index, or -1 if none is bound.
+ */
+static int governingGroup(ArgParser *obj, int g, int bound)
+{
+    while((g >= 0) && (g != bound) && (obj->groups[g].base == NULL))
+        g = obj->groups[g].parent;
+
+    return g;
+}
+
+
+/**
+ *  @brief Check if a field lies in a struct.
+ *  @param [in] base     Struct
+ *  @param [in] size     Struct size
+ *  @param [in] field    Field
+ *  @param [in] fieldLen Field size
+ *  @retval true  The field is in the struct.
+ *  @retval false Otherwise.
+ */
+static bool isInStruct(const char *base, size_t size, const char *field, size_t fieldLen)
+{
+    return (field >= base) && (fieldLen <= size) && ((size_t) (field - base) <= size - fieldLen);
+}
+
+
+/**
+ *  @brief Record the destination of a new parameter as a field of the struct of its group.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static int bindField(ArgParser *obj, PrmDef *pdef)
+{
+    if((pdef->group == 0) || (pdef->varType == VarType_Action))
+        return 0;
+
+    int g = governingGroup(obj, pdef->group - 1, -1);
+    if(g < 0)
+        return 0;
+
+    Group *group = &(obj->groups[g]);
+    if(isInStruct(group->base, group->size, (char *) pdef->dest, fieldSize(pdef)) == false)
+    {
+        ArgParserError_set(obj, "The destination of '%s' is outside the struct bound to '%s'.", pdef->lOpt, group->path);
+        return 1;
+    }
+
+    pdef->owner  = g + 1;
+    pdef->offset = (size_t) ((char *) pdef->dest - group->base);
+    return 0;
+}
+
+
+/**
+ *  @brief Place the bound structs and the destinations at their offsets in the structs of their owners.
+ *  @param [in] obj ArgParser object
+ */
+static void placeFields(ArgParser *obj)
+{
+    unsigned int i;
+
+    // The parents precede their children, so the owners are placed first.
+    for(i = 0; i < obj->numGroups; i++)
+    {
+        Group *group = &(obj->groups[i]);
+        if((group->base != NULL) && (group->owner >= 0))
+            group->base = obj->groups[group->owner].base + group->offset;
+    }
+
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        if(pdef->owner != 0)
+            pdef->dest = obj->groups[pdef->owner - 1].base + pdef->offset;
+    }
+}
+
+
+/**
+ *  @brief Get the size of the field at the destination.
+ *  @param [in] pdef Parameter definition
+ *  @return Field size (the word of a bit flag)
+ */
+static size_t fieldSize(PrmDef *pdef)
+{
+    return (pdef->bitMask != 0) ? sizeof(uint64_t) : ArgParserParam_size(pdef);
+}
+
+
+/**
+ *  @brief Print the value of a parameter.
+ *  @param [in] pdef Parameter definition
+ *  @param [in] fp   Output file pointer
+ */
+static void printValue(PrmDef *pdef, FILE *fp)
+{
+    switch(pdef->varType)
+    {
+        case VarType_Int:    fprintf(fp, "%d", *(int *) pdef->dest);                break;
+        case VarType_UInt:   fprintf(fp, "%u", *(unsigned int *) pdef->dest);       break;
+        case VarType_String: fprintf(fp, "\"%s\"", (char *) pdef->dest);            break;
+        case VarType_Bool:
+        case VarType_True:   fprintf(fp, "%d", loadFlag(pdef));                     break;
+        case VarType_Int32:  fprintf(fp, "%d", (int) *(int32_t *) pdef->dest);      break;
+        case VarType_UInt32: fprintf(fp, "%u", (unsigned int) *(uint32_t *) pdef->dest); break;
+        case VarType_Float:  fprintf(fp, "%g", *(float *) pdef->dest);              break;
+        case VarType_Double: fprintf(fp, "%g", *(double *) pdef->dest);             break;
+        default:                                                                    break;
+    }
+}
+
+
+/**
+ *  @brief Copy string to the internal buffer and returns the copied one.
+ *         If the string is NULL, An empty string ("") is copied.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] str   String to copy.
+ *  @return   A new copied string if success, NULL otherwise.
+ */
+static char* copyStr(ArgParser *obj, const char *str)
+{
+    const char *tmp = (str != NULL) ? str : "";
+
+    if(checkNotShrunk(obj) == false)
+        goto error;
+
+    /* Calculate the rest of the internal buffer. */
+    int bufRest = APARSER_MAX_BUF - obj->bufIdx;
+   
+    int len = strlen(tmp) + 1 /* null termination */;
+   
+    /* Check the string size. */
+    if(bufRest < len)
+    {
+        ArgParserError_set(obj, "Cannot store the string '%s'.", tmp);
+        goto error;
+    }
+
+    /* Copy the string and returns the copied one. */
+    char *p = &(obj->buf[obj->bufIdx]);
+    strcpy(p, tmp);
+    obj->bufIdx += len;
+
+    // fprintf(stderr, "copyStr: str= '%s' len= %d idx= %5d -> %5d\n", tmp, len, obj->bufIdx - len, obj->bufIdx);
+    return p;
+
+error: /* error handling */
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Allocate an aligned block in the internal buffer.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] size  Block size
+ *  @param [in] align Alignment (power of two)
+ *  @return Allocated block if success, NULL otherwise.
+ */
+static void* allocArena(ArgParser *obj, size_t size, size_t align)
+{
+    size_t idx = (obj->bufIdx + align - 1) & ~(align - 1);
+
+    if(idx + size > APARSER_MAX_BUF)
+    {
+        ArgParserError_set(obj, "Internal buffer is full. (APARSER_MAX_BUF)");
+        return NULL;
+    }
+
+    obj->bufIdx = idx + size;
+    return &(obj->buf[idx]);
+}
+
+
+/**
+ *  @brief Find the words of a description, so that the help layout needs no scan for any width.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static int splitWords(ArgParser *obj, PrmDef *pdef)
+{
+    const char *desc = pdef->desc;
+    unsigned int numWords = 0;
+    unsigned int i;
+
+    /* Count the words and the line breaks. */
+    for(i = 0; desc[i] != '\0'; i++)
+    {
+        if(desc[i] == '\n')
+            numWords++;
+        else if((desc[i] != ' ') && (desc[i] != '\t') && ((i == 0) || (desc[i - 1] == ' ') || (desc[i - 1] == '\t') || (desc[i - 1] == '\n')))
+            numWords++;
+    }
+
+    pdef->numWords = 0;
+    pdef->words    = (HelpWord *) allocArena(obj, sizeof(HelpWord) * numWords, sizeof(uint32_t));
+    if((numWords != 0) && (pdef->words == NULL))
+        return 1;
+
+    /* Record them. */
+    for(i = 0; desc[i] != '\0'; )
+    {
+        HelpWord *word = &(pdef->words[pdef->numWords]);
+
+        if((desc[i] == ' ') || (desc[i] == '\t'))
+        {
+            i++;
+            continue;
+        }
+
+        word->start = i;
+        if(desc[i] == '\n')
+        {
+            word->len = 0;
+            i++;
+        }
+        else
+        {
+            while((desc[i] != '\0') && (desc[i] != ' ') && (desc[i] != '\t') && (desc[i] != '\n'))
+                i++;
+            word->len = i - word->start;
+        }
+        pdef->numWords++;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Check if the parameter is a optional parameter.
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @retval true  The patameter is a optional patameter.
+ *  @retval false The patameter is not a optional patameter.
+ */
+static bool isOptParam(const char *sOpt, const char *lOpt)
+{
+    if((sOpt != NULL) && (strlen(sOpt) != 0))
+        return true;
+
+    if((lOpt != NULL) && (strlen(lOpt) != 0))
+        return true;
+
+    return false;
+}
+
+
+/**
+ *  @brief Check if the parameter is a positional parameter.
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @retval true  The patameter is a positional patameter.
+ *  @retval false The patameter is not a positional patameter.
+ */
+static bool isPosParam(const char *sOpt, const char *lOpt)
+{
+    return !isOptParam(sOpt, lOpt);
+}
+
+
+/**
+ *  @brief Find optional parameters.
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Commend line argument.
+ *  @return Key of the spelling (with the parameter definition) if found. NULL otherwise.
+ */
+static inline LookupKey* findOptionalParam(ArgParser *obj, const char *arg)
+{
+    LookupIndex *index = &(obj->index);
+    unsigned int i;
+
+    if(index->type == LookupType_Linear)
+    {
+        /* Compare the packed prefixes, and the rest only for long spellings. */
+        Prefix prefix = packPrefix(arg);
+        for(i = 0; i < index->numKeys; i++)
+        {
+            if(((index->prefixes[i].lo ^ prefix.lo) | (index->prefixes[i].hi ^ prefix.hi)) != 0)
+                continue;
+
+            // Shorter than 16 bytes: the prefix covers the whole spelling.
+            if((prefix.hi >> 56) == 0)
+                return &(index->keys[i]);
+
+            if(strcmp(arg + 16, index->keys[i].str + 16) == 0)
+                return &(index->keys[i]);
+        }
+
+        return NULL;
+    }
+
+    if(index->type == LookupType_Hash)
+        return findKey(index, arg);
+
+    return NULL;
+};
+
+
+/**
+ *  @brief Find a long option given with its value. ("--option=value")
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  arg   Command line argument
+ *  @param [out] value Value after '='
+ *  @return Key of the spelling if found, NULL otherwise.
+ */
+static LookupKey* findOptionWithValue(ArgParser *obj, const char *arg, const char **value)
+{
+    char spelling[APARSER_MAX_SPELLING];
+
+    const char *eq = strchr(arg, '=');
+    if((eq == NULL) || ((size_t) (eq - arg) >= sizeof(spelling)))
+        return NULL;
+
+    memcpy(spelling, arg, eq - arg);
+    spelling[eq - arg] = '\0';
+
+    LookupKey *key = findOptionalParam(obj, spelling);
+    if(key != NULL)
+        *value = eq + 1;
+
+    return key;
+}
+
+
+/**
+ *  @brief Save the schema before a module runs.
+ *  @param [in] obj ArgParser object
+ *  @return Schema mark if success, NULL otherwise.
+ */
+static SchemaMark* markSchema(ArgParser *obj)
+{
+    unsigned int numPrms = obj->numOptPrms + obj->numPosPrms;
+
+    SchemaMark *mark = (SchemaMark *) malloc(sizeof(SchemaMark) + sizeof(PrmDef) * numPrms + obj->bufIdx);
+    if(mark == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        return NULL;
+    }
+
+    mark->numOptPrms    = obj->numOptPrms;
+    mark->numPosPrms    = obj->numPosPrms;
+    mark->numGroups     = obj->numGroups;
+    mark->numNamespaces = obj->numNamespaces;
+    mark->bufIdx        = obj->bufIdx;
+    mark->prms          = (PrmDef *) (mark + 1);
+    mark->buf           = (char *) (mark->prms + numPrms);
+
+    memcpy(mark->prms, obj->optPrms, sizeof(PrmDef) * obj->numOptPrms);
+    memcpy(mark->prms + obj->numOptPrms, obj->posPrms, sizeof(PrmDef) * obj->numPosPrms);
+    memcpy(mark->buf, obj->buf, obj->bufIdx);
+    memcpy(mark->groups, obj->groups, sizeof(mark->groups));
+    memcpy(mark->namespaces, obj->namespaces, sizeof(mark->namespaces));
+    memcpy(mark->nsHeads, obj->nsHeads, sizeof(mark->nsHeads));
+    return mark;
+}
+
+
+/**
+ *  @brief Restore the schema saved before a module.
+ *         The parameters, aliases, validators, groups and namespaces of the module go away,
+ *         and so do the lookup index and the default values which refer to them.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] mark Schema mark
+ */
+static void rollbackSchema(ArgParser *obj, const SchemaMark *mark)
+{
+    unsigned int i, n = 0;
+
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        DefaultOverride *ovr = &(obj->defaults[i]);
+        bool isKept = ((ovr->pdef >= obj->optPrms) && (ovr->pdef < obj->optPrms + mark->numOptPrms)) ||
+                      ((ovr->pdef >= obj->posPrms) && (ovr->pdef < obj->posPrms + mark->numPosPrms));
+        if(isKept == true)
+            obj->defaults[n++] = *ovr;
+        else if(ovr->pdef->varType == VarType_String)
+            free(ovr->val.s.data);
+    }
+    obj->numDefaults = n;
+
+    obj->numOptPrms    = mark->numOptPrms;
+    obj->numPosPrms    = mark->numPosPrms;
+    obj->numGroups     = mark->numGroups;
+    obj->numNamespaces = mark->numNamespaces;
+    obj->bufIdx        = mark->bufIdx;
+    memcpy(obj->optPrms, mark->prms, sizeof(PrmDef) * mark->numOptPrms);
+    memcpy(obj->posPrms, mark->prms + mark->numOptPrms, sizeof(PrmDef) * mark->numPosPrms);
+    memcpy(obj->buf, mark->buf, mark->bufIdx);
+    memcpy(obj->groups, mark->groups, sizeof(obj->groups));
+    memcpy(obj->namespaces, mark->namespaces, sizeof(obj->namespaces));
+    memcpy(obj->nsHeads, mark->nsHeads, sizeof(obj->nsHeads));
+
+    // The index may hold the spellings of the module.
+    freeIndex(&(obj->index));
+    freeIndex(&(obj->names));
+    obj->isFrozen = false;
+    clearPlans(obj);
+    clearHelpCache(obj);
+}
+
+
+/**
+ *  @brief Save the default values of an object and of its namespaces before a config load.
+ *  @param [in]  obj  ArgParser object
+ *  @param [out] mark Saved default values
+ *  @return Execution status
+ */
+int ArgParserConfig_mark(ArgParser *obj, ConfigMark *mark)
+{
+    unsigned int k, i;
+
+    memset(mark, 0x00, sizeof(ConfigMark));
+    mark->objs[0] = obj;
+    for(k = 0; k < obj->numNamespaces; k++)
+        mark->objs[k + 1] = obj->namespaces[k].sub;
+    mark->numObjs = obj->numNamespaces + 1;
+
+    for(k = 0; k < mark->numObjs; k++)
+    {
+        ArgParser *target = mark->objs[k];
+        if(target->numDefaults == 0)
+            continue;
+
+        // Zeroed, so that a partial copy can be released.
+        DefaultOverride *copy = (DefaultOverride *) calloc(target->numDefaults, sizeof(DefaultOverride));
+        if(copy == NULL)
+            goto error;
+        mark->defaults[k]    = copy;
+        mark->numDefaults[k] = target->numDefaults;
+
+        for(i = 0; i < target->numDefaults; i++)
+        {
+            copy[i] = target->defaults[i];
+            if(copy[i].pdef->varType != VarType_String)
+                continue;
+
+            copy[i].val.s.data = strdup(target->defaults[i].val.s.data);
+            if(copy[i].val.s.data == NULL)
+                goto error;
+        }
+    }
+
+    return 0;
+
+error: /* error handling */
+
+    for(k = 0; k < mark->numObjs; k++)
+        freeOverrides(mark->defaults[k], mark->numDefaults[k]);
+    memset(mark, 0x00, sizeof(ConfigMark));
+    ArgParserError_set(obj, "Cannot allocate memory.");
+    return 1;
+}
+
+
+/**
+ *  @brief Finish a config load: keep the new default values, or restore the saved ones.
+ *  @param [in] mark     Saved default values (released)
+ *  @param [in] isFailed If set, the saved default values are restored.
+ */
+void ArgParserConfig_release(ConfigMark *mark, bool isFailed)
+{
+    unsigned int k;
+
+    for(k = 0; k < mark->numObjs; k++)
+    {
+        ArgParser *target = mark->objs[k];
+        if(isFailed == true)
+        {
+            clearDefaults(target);
+            target->defaults    = mark->defaults[k];
+            target->numDefaults = mark->numDefaults[k];
+            target->defaultsLen = mark->numDefaults[k];
+        }
+        else
+        {
+            freeOverrides(mark->defaults[k], mark->numDefaults[k]);
+        }
+    }
+
+    memset(mark, 0x00, sizeof(ConfigMark));
+}
+
+
+/**
+ *  @brief Release an array of default values, and their strings.
+ *  @param [in] defaults Default values (NULL: none)
+ *  @param [in] num      Number of the default values
+ */
+static void freeOverrides(DefaultOverride *defaults, unsigned int num)
+{
+    unsigned int i;
+
+    if(defaults == NULL)
+        return;
+
+    for(i = 0; i < num; i++)
+    {
+        if((defaults[i].pdef != NULL) && (defaults[i].pdef->varType == VarType_String))
+            free(defaults[i].val.s.data);
+    }
+    free(defaults);
+}
+
+
+/**
+ *  @brief Find a parameter by its name.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] name Parameter name
+ *  @return Parameter definition if found. NULL otherwise.
+ */
+static PrmDef* findParamByName(ArgParser *obj, const char *name)
+{
+    unsigned int i;
+
+    if((obj->isFrozen == true) && (obj->names.type == LookupType_Hash))
+    {
+        LookupKey *key = findKey(&(obj->names), name);
+        return (key != NULL) ? key->pdef : NULL;
+    }
+
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        if(strcmp(obj->optPrms[i].name, name) == 0)
+            return &(obj->optPrms[i]);
+    }
+
+    for(i = 0; i < obj->numPosPrms; i++)
+    {
+        if(strcmp(obj->posPrms[i].name, name) == 0)
+            return &(obj->posPrms[i]);
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Find the parameter of a name, which must be unique.
+ *         The settings bound by name would otherwise go to the first of the parameters
+ *         which share it. (In different modules, or as an option and a positional parameter.)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] name Parameter name
+ *  @return Parameter definition if found and unique. NULL otherwise.
+ */
+static PrmDef* findUniqueParam(ArgParser *obj, const char *name)
+{
+    PrmDef *found = NULL;
+    unsigned int num = 0;
+    unsigned int i;
+
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        if(strcmp(obj->optPrms[i].name, name) == 0)
+        {
+            found = (num == 0) ? &(obj->optPrms[i]) : found;
+            num++;
+        }
+    }
+
+    for(i = 0; i < obj->numPosPrms; i++)
+    {
+        if(strcmp(obj->posPrms[i].name, name) == 0)
+        {
+            found = (num == 0) ? &(obj->posPrms[i]) : found;
+            num++;
+        }
+    }
+
+    if(num == 0)
+    {
+        ArgParserError_set(obj, "Unknown parameter name: '%s'.", name);
+        return NULL;
+    }
+
+    if(num > 1)
+    {
+        ArgParserError_set(obj, "Ambiguous parameter name: '%s' is shared by %u parameters.", name, num);
+        return NULL;
+    }
+
+    return found;
+}
+
+
+/**
+ *  @brief Find a key in a hashed index.
+ *  @param [in] index Lookup index
+ *  @param [in] str   Key string
+ *  @return Parameter definition if found. NULL otherwise.
+ */
+static inline LookupKey* findKey(LookupIndex *index, const char *str)
+{
+    uint64_t hash = hashStr(str);
+    unsigned int mask = index->numSlots - 1;
+    unsigned int i;
+    for(i = hash & mask; index->slots[i] != 0; i = (i + 1) & mask)
+    {
+        LookupKey *key = &(index->keys[index->slots[i] - 1]);
+        if((key->hash == hash) && (strcmp(str, key->str) == 0))
+            return key;
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Build the option lookup index and the parameter name index.
+ *         Small schemas are scanned linearly, large ones are hashed.
+ *         Parameter names are always hashed.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int buildIndex(ArgParser *obj)
+{
+    LookupIndex *index = &(obj->index);
+    LookupIndex *names = &(obj->names);
+    unsigned int i, n;
+
+    freeIndex(index);
+    freeIndex(names);
+
+    // The cached plans and the telemetry refer to the old schema.
+    clearPlans(obj);
+    obj->telemetryId = 0;
+
+    /* Collect all spellings of the optional parameters. */
+    unsigned int maxKeys = 2 * obj->numOptPrms;
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        Alias *alias;
+        for(alias = obj->optPrms[i].aliases; alias != NULL; alias = alias->next)
+            maxKeys++;
+    }
+
+    if(allocKeys(obj, index, maxKeys) != 0)
+        goto error;
+
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        addKey(index, pdef->sOpt, pdef, false);
+        addKey(index, pdef->lOpt, pdef, false);
+    }
+
+    // The aliases follow, and the negations last, so that the explicit spellings win.
+    for(n = 0; n < 2; n++)
+    {
+        for(i = 0; i < obj->numOptPrms; i++)
+        {
+            PrmDef *pdef = &(obj->optPrms[i]);
+            Alias *alias;
+            for(alias = pdef->aliases; alias != NULL; alias = alias->next)
+            {
+                if(alias->isNegated == (n == 1))
+                    addKey(index, alias->str, pdef, alias->isNegated);
+            }
+        }
+    }
+
+    if(index->numKeys <= obj->lookupThreshold)
+    {
+        unsigned int j;
+        for(i = 0; i < index->numKeys; i++)
+        {
+            for(j = 0; j < i; j++)
+            {
+                if((index->prefixes[i].lo == index->prefixes[j].lo) && (index->prefixes[i].hi == index->prefixes[j].hi) &&
+                   (strcmp(index->keys[i].str, index->keys[j].str) == 0) &&
+                   (checkConflict(obj, &(index->keys[i]), &(index->keys[j])) != 0))
+                    goto error;
+            }
+        }
+
+        index->type = LookupType_Linear;
+    }
+    else if(hashKeys(obj, index) != 0)
+    {
+        goto error;
+    }
+
+    /* Collect all parameter names. */
+    if(allocKeys(obj, names, obj->numOptPrms + obj->numPosPrms) != 0)
+        goto error;
+
+    for(i = 0; i < obj->numOptPrms; i++)
+        addKey(names, obj->optPrms[i].name, &(obj->optPrms[i]), false);
+    for(i = 0; i < obj->numPosPrms; i++)
+        addKey(names, obj->posPrms[i].name, &(obj->posPrms[i]), false);
+
+    if(hashKeys(obj, names) != 0)
+        goto error;
+
+    if(buildFlagWords(obj) != 0)
+        goto error;
+
+    return 0;
+
+error: /* error handling */
+
+    freeIndex(index);
+    freeIndex(names);
+    return 1;
+}
+
+
+/**
+ *  @brief Collect the words of the bit-packed flags, so that their defaults are written a word at a time.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int buildFlagWords(ArgParser *obj)
+{
+    unsigned int i, j;
+
+    free(obj->flagWords);
+    obj->flagWords    = NULL;
+    obj->numFlagWords = 0;
+
+    for(i = 0; i < obj->numOptPrms + obj->numPosPrms; i++)
+    {
+        PrmDef *pdef = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        if(pdef->bitMask == 0)
+            continue;
+
+        if(obj->flagWords == NULL)
+        {
+            obj->flagWords = (FlagWord *) malloc(sizeof(FlagWord) * (obj->numOptPrms + obj->numPosPrms));
+            if(obj->flagWords == NULL)
+            {
+                ArgParserError_set(obj, "Cannot allocate memory.");
+                return 1;
+            }
+        }
+
+        for(j = 0; (j < obj->numFlagWords) && (obj->flagWords[j].word != (uint64_t *) pdef->dest); j++)
+            ;
+
+        FlagWord *fw = &(obj->flagWords[j]);
+        if(j == obj->numFlagWords)
+        {
+            fw->word = (uint64_t *) pdef->dest;
+            fw->mask = 0;
+            fw->bits = 0;
+            obj->numFlagWords++;
+        }
+
+        fw->mask |= pdef->bitMask;
+        if(pdef->defVal.b == true)
+            fw->bits |= pdef->bitMask;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Allocate the key arrays of an index.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] index   Lookup index
+ *  @param [in] maxKeys Maximum number of keys
+ *  @return Execution status
+ */
+static int allocKeys(ArgParser *obj, LookupIndex *index, unsigned int maxKeys)
+{
+    index->prefixes = (Prefix *) malloc(sizeof(Prefix) * (maxKeys + 1));
+    index->keys     = (LookupKey *) malloc(sizeof(LookupKey) * (maxKeys + 1));
+    if((index->prefixes == NULL) || (index->keys == NULL))
+    {
+        ArgParserError_set(obj, "Cannot allocate memory for the lookup index.");
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Add a key to an index. Empty strings are ignored.
+ *  @param [in] index Lookup index
+ *  @param [in] str   Key string
+ *  @param [in] pdef  Parameter definition
+ *  @param [in] isNegated If set, the spelling clears the flag.
+ */
+static void addKey(LookupIndex *index, const char *str, PrmDef *pdef, bool isNegated)
+{
+    if(str[0] == '\0')
+        return;
+
+    LookupKey *key = &(index->keys[index->numKeys]);
+    key->str  = str;
+    key->hash = hashStr(str);
+    key->pdef = pdef;
+    key->isNegated = isNegated;
+    index->prefixes[index->numKeys] = packPrefix(str);
+    index->numKeys++;
+}
+
+
+/**
+ *  @brief Build the hash table of an index. The load factor is kept under 0.5.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] index Lookup index
+ *  @return Execution status
+ */
+static int hashKeys(ArgParser *obj, LookupIndex *index)
+{
+    unsigned int i;
+
+    index->numSlots = 1;
+    while(index->numSlots < 2 * index->numKeys)
+        index->numSlots <<= 1;
+
+    index->slots = (uint16_t *) calloc(index->numSlots, sizeof(uint16_t));
+    if(index->slots == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory for the lookup index.");
+        return 1;
+    }
+
+    unsigned int mask = index->numSlots - 1;
+    for(i = 0; i < index->numKeys; i++)
+    {
+        LookupKey *key = &(index->keys[i]);
+        unsigned int slot = key->hash & mask;
+        bool isDuplicated = false;
+
+        while(index->slots[slot] != 0)
+        {
+            LookupKey *other = &(index->keys[index->slots[slot] - 1]);
+            if((other->hash == key->hash) && (strcmp(other->str, key->str) == 0))
+            {
+                if(checkConflict(obj, key, other) != 0)
+                    return 1;
+
+                // The first registered parameter wins, as the linear scan does.
+                isDuplicated = true;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        if(isDuplicated == false)
+            index->slots[slot] = i + 1;
+    }
+
+    index->type = LookupType_Hash;
+    return 0;
+}
+
+
+/**
+ *  @brief Check a key which is registered twice.
+ *         Within the application or a module, the first registered parameter wins.
+ *         Across modules, it is a conflict.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] key   Key registered later
+ *  @param [in] other Key registered first
+ *  @return Execution status (1: conflict)
+ */
+static int checkConflict(ArgParser *obj, LookupKey *key, LookupKey *other)
+{
+    const char *module = key->pdef->module;
+    const char *first  = other->pdef->module;
+
+    // The automatic negations give way silently.
+    if((module == first) || (key->isNegated == true))
+        return 0;
+
+    ArgParserError_set(obj, "Conflict: '%s' is defined by %s%s%s and %s%s%s.", key->str,
+            (first  != NULL) ? "module '" : "", (first  != NULL) ? first  : "the application", (first  != NULL) ? "'" : "",
+            (module != NULL) ? "module '" : "", (module != NULL) ? module : "the application", (module != NULL) ? "'" : "");
+    return 1;
+}
+
+
+/**
+ *  @brief Release the option lookup index.
+ *  @param [in] index Lookup index
+ */
+static void freeIndex(LookupIndex *index)
+{
+    free(index->prefixes);
+    free(index->keys);
+    free(index->slots);
+    memset(index, 0x00, sizeof(LookupIndex));
+}
+
+
+/**
+ *  @brief Pack the first 16 bytes of a string into two words, zero padded.
+ *         Long options often share their first 8 bytes ("--option-..."),
+ *         so both words are compared.
+ *  @param [in] str String
+ *  @return Packed prefix
+ */
+static inline Prefix packPrefix(const char *str)
+{
+    Prefix prefix = { 0, 0 };
+    unsigned int i;
+    for(i = 0; (i < 8) && (str[i] != '\0'); i++)
+        prefix.lo |= (uint64_t)(unsigned char) str[i] << (8 * i);
+
+    if(i < 8)
+        return prefix;
+
+    for(str += 8, i = 0; (i < 8) && (str[i] != '\0'); i++)
+        prefix.hi |= (uint64_t)(unsigned char) str[i] << (8 * i);
+
+    return prefix;
+}
+
+
+/**
+ *  @brief Calculate the hash value of a string (FNV-1a).
+ *  @param [in] str String
+ *  @return Hash value
+ */
+static inline uint64_t hashStr(const char *str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(; *str != '\0'; str++)
+    {
+        hash ^= (unsigned char) *str;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+/**
+ *  @brief Calculate the hash value of a string (FNV-1a). (For the other modules)
+ *  @param [in] str String
+ *  @return Hash value
+ */
+uint64_t ArgParserHash_str(const char *str)
+{
+    return hashStr(str);
+}
+
+
+
+/**
+ *  @brief Write defult parameters.
+ *         The parameters which have a default value provider get their default value too,
+ *         which runDefaultProviders() may replace. The words of the bit-packed flags come
+ *         from the freeze step, which precedes every parse.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int writeDefaultParams(ArgParser *obj)
+{
+    int status = 0;
+    
+    /* Write default values for the bit-packed flags, a word at a time */
+    unsigned int i;
+    for(i = 0; i < obj->numFlagWords; i++)
+    {
+        FlagWord *fw = &(obj->flagWords[i]);
+        *(fw->word) = (*(fw->word) & ~fw->mask) | fw->bits;
+    }
+
+    memset(obj->optStates, 0x00, sizeof(PrmState) * obj->numOptPrms);
+    memset(obj->posStates, 0x00, sizeof(PrmState) * obj->numPosPrms);
+
+    /* Write default values for the optional parameters */
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        PrmDef *pdef = &(obj->optPrms[i]);
+        if(pdef->bitMask != 0)
+            continue;
+
+        status = writeDefaultValue(pdef, &(pdef->defVal));
+        if(status != 0)
+        {
+            ArgParserError_set(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
+            goto error;
+        }
+    }
+
+    /* Write default values for the positional parameters */
+    for(i = 0; i < obj->numPosPrms; i++)
+    {
+        PrmDef *pdef = &(obj->posPrms[i]);
+        if(pdef->bitMask != 0)
+            continue;
+
+        status = writeDefaultValue(pdef, &(pdef->defVal));
+        if(status != 0)
+        {
+            ArgParserError_set(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
+            goto error;
+        }
+    }
+
+    /* Overwrite with the default values of this object. */
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        PrmDef *pdef = obj->defaults[i].pdef;
+        status = writeDefaultValue(pdef, &(obj->defaults[i].val));
+        if(status != 0)
+        {
+            ArgParserError_set(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
+            goto error;
+        }
+    }
+
+    return 0;
+
+error: /* error handling */
+
+    return 1;
+}
+
+
+/**
+ *  @brief Run the default value providers of the unset parameters.
+ *         If a provider fails, the registered default value is written instead.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int runDefaultProviders(ArgParser *obj)
+{
+    PrmDef *tables[2] = { obj->optPrms, obj->posPrms };
+    PrmState *states[2] = { obj->optStates, obj->posStates };
+    unsigned int nums[2] = { obj->numOptPrms, obj->numPosPrms };
+    unsigned int i, t;
+
+    for(t = 0; t < 2; t++)
+    {
+        for(i = 0; i < nums[t]; i++)
+        {
+            PrmDef *pdef = &(tables[t][i]);
+            if((states[t][i].isSet == false) && (provideDefault(obj, pdef) != 0))
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Run the default value provider of an unset parameter, unless a config file gave its value.
+ *         If the provider fails, the registered default value is written instead.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static int provideDefault(ArgParser *obj, PrmDef *pdef)
+{
+    if((pdef->defFn == NULL) || (ArgParserParam_hasConfig(obj, pdef) == true))
+        return 0;
+
+    if(ArgParserParam_provide(pdef) == 0)
+        return 0;
+
+    if(writeDefaultValue(pdef, ArgParserParam_default(obj, pdef)) != 0)
+    {
+        ArgParserError_set(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Run the default value provider of a parameter.
+ *         The provider of a bit-packed flag writes a bool, which is stored into the bit.
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status of the provider
+ */
+int ArgParserParam_provide(PrmDef *pdef)
+{
+    if(pdef->bitMask == 0)
+        return pdef->defFn(pdef->dest, ArgParserParam_size(pdef), pdef->defCtx);
+
+    bool value = loadFlag(pdef);
+    int status = pdef->defFn(&value, sizeof(bool), pdef->defCtx);
+    if(status == 0)
+        storeFlag(pdef, value);
+    return status;
+}
+
+
+/**
+ *  @brief Get the default value of a parameter on this object.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Default value
+ */
+const Val* ArgParserParam_default(ArgParser *obj, PrmDef *pdef)
+{
+    unsigned int i;
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        if(obj->defaults[i].pdef == pdef)
+            return &(obj->defaults[i].val);
+    }
+
+    return &(pdef->defVal);
+}
+
+
+/**
+ *  @brief Check if a parameter has a value from a config file on this object.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return True if it has, false otherwise.
+ */
+bool ArgParserParam_hasConfig(ArgParser *obj, PrmDef *pdef)
+{
+    unsigned int i;
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        if(obj->defaults[i].pdef == pdef)
+            return obj->defaults[i].isConfig;
+    }
+
+    return false;
+}
+
+
+/**
+ *  @brief Continue a hash over a value of a parameter.
+ *  @param [in] hash Hash value
+ *  @param [in] pdef Parameter definition
+ *  @param [in] val  Value
+ *  @return Hash value
+ */
+uint64_t ArgParserParam_hashValue(uint64_t hash, PrmDef *pdef, const Val *val)
+{
+    const void *data;
+    size_t size;
+    size_t i;
+
+    switch(pdef->varType)
+    {
+        case VarType_Int:    data = &(val->i);   size = sizeof(int);          break;
+        case VarType_UInt:   data = &(val->u);   size = sizeof(unsigned int); break;
+        case VarType_Bool:
+        case VarType_True:   data = &(val->b);   size = sizeof(bool);         break;
+        case VarType_Int32:  data = &(val->i32); size = sizeof(int32_t);      break;
+        case VarType_UInt32: data = &(val->u32); size = sizeof(uint32_t);     break;
+        case VarType_Float:  data = &(val->f);   size = sizeof(float);        break;
+        case VarType_Double: data = &(val->d);   size = sizeof(double);       break;
+        case VarType_String:
+            data = (val->s.data != NULL) ? val->s.data : "";
+            size = strlen((const char *) data);
+            break;
+        default:
+            return hash;
+    }
+
+    for(i = 0; i < size; i++)
+        hash = (hash ^ ((const uint8_t *) data)[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+
+/**
+ *  @brief Override a default value on this object. (Copy on write)
+ *  @param [in] obj      ArgParser object
+ *  @param [in] pdef     Parameter definition
+ *  @param [in] val      Default value (strings are copied)
+ *  @param [in] isConfig If set, the value came from a config file.
+ *  @return Execution status
+ */
+static int addDefault(ArgParser *obj, PrmDef *pdef, const Val *val, bool isConfig)
+{
+    DefaultOverride *ovr = NULL;
+    unsigned int i;
+
+    for(i = 0; i < obj->numDefaults; i++)
+    {
+        if(obj->defaults[i].pdef == pdef)
+            ovr = &(obj->defaults[i]);
+    }
+
+    /* Make a new entry. */
+    if(ovr == NULL)
+    {
+        if(obj->numDefaults == obj->defaultsLen)
+        {
+            unsigned int len = (obj->defaultsLen != 0) ? (obj->defaultsLen * 2) : 4;
+            DefaultOverride *defaults = (DefaultOverride *) realloc(obj->defaults, sizeof(DefaultOverride) * len);
+            if(defaults == NULL)
+            {
+                ArgParserError_set(obj, "Cannot allocate memory.");
+                return 1;
+            }
+
+            obj->defaults    = defaults;
+            obj->defaultsLen = len;
+        }
+
+        ovr = &(obj->defaults[obj->numDefaults]);
+        ovr->pdef = pdef;
+        memset(&(ovr->val), 0x00, sizeof(Val));
+        obj->numDefaults++;
+    }
+    ovr->isConfig = isConfig;
+
+    if(pdef->varType != VarType_String)
+    {
+        ovr->val = *val;
+        return 0;
+    }
+
+    char *data = (char *) malloc(strlen(val->s.data) + 1);
+    if(data == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        return 1;
+    }
+    strcpy(data, val->s.data);
+
+    free(ovr->val.s.data);
+    ovr->val.s.data = data;
+    ovr->val.s.len  = val->s.len;
+    return 0;
+}
+
+
+/**
+ *  @brief Release the default values overridden on this object.
+ *  @param [in] obj ArgParser object
+ */
+static void clearDefaults(ArgParser *obj)
+{
+    freeOverrides(obj->defaults, obj->numDefaults);
+    obj->defaults    = NULL;
+    obj->numDefaults = 0;
+    obj->defaultsLen = 0;
+}
+
+
+/**
+ *  @brief Get the size of the destination.
+ *  @param [in] pdef Parameter definition
+ *  @return Destination size (the maximum length for strings)
+ */
+size_t ArgParserParam_size(PrmDef *pdef)
+{
+    switch(pdef->varType)
+    {
+        case VarType_Int:    return sizeof(int);
+        case VarType_UInt:   return sizeof(unsigned int);
+        case VarType_String: return pdef->defVal.s.len;
+        case VarType_Bool:   return sizeof(bool);
+        case VarType_Int32:  return sizeof(int32_t);
+        case VarType_UInt32: return sizeof(uint32_t);
+        case VarType_Float:  return sizeof(float);
+        case VarType_Double: return sizeof(double);
+        case VarType_True:   return sizeof(bool);
+        case VarType_Action: return 0;
+        default:             return 0;
+    }
+}
+
+
+/**
+ *  @brief Write a default value to the destination.
+ *  @param [in] pdef   Parameter definition
+ *  @param [in] defVal Default value
+ *  @return Execution status
+ */
+static inline int writeDefaultValue(PrmDef *pdef, const Val *defVal)
+{
+    switch(pdef->varType)
+    {
+        case VarType_Int:
+            *(int *) pdef->dest = defVal->i;
+            return 0;
+
+        case VarType_UInt:
+            *(unsigned int *) pdef->dest = defVal->u;
+            return 0;
+
+        case VarType_String:
+        {
+            copyBounded((char *) pdef->dest, defVal->s.data, defVal->s.len);
+            return 0;
+        }
+
+        case VarType_Bool:
+            storeFlag(pdef, defVal->b);
+            return 0;
+        
+        case VarType_Int32:
+            *(int32_t *) pdef->dest = defVal->i32;
+            return 0;
+        
+        case VarType_UInt32:
+            *(uint32_t *) pdef->dest = defVal->u32;
+            return 0;
+
+        case VarType_Float:
+            *(float *) pdef->dest = defVal->f;
+
+            return 0;
+        
+        case VarType_Double:
+            *(double *) pdef->dest = defVal->d;
+            return 0;
+        
+        case VarType_True:
+            storeFlag(pdef, defVal->b);
+            return 0;
+
+        case VarType_Action:
+            // Only the built-in actions record that they were given.
+            if(pdef->dest != NULL)
+                *(bool *) pdef->dest = false;
+            return 0;
+
+        default:
+            /* Unreachable */
+            return 1;
+    }
+}
+
+
+/**
+ *  @brief Store the value of a bool-type or switch-type parameter.
+ *  @param [in] pdef  Parameter definition
+ *  @param [in] value Value
+ */
+static inline void storeFlag(PrmDef *pdef, bool value)
+{
+    if(pdef->bitMask == 0)
+        *(bool *) pdef->dest = value;
+    else if(value == true)
+        *(uint64_t *) pdef->dest |= pdef->bitMask;
+    else
+        *(uint64_t *) pdef->dest &= ~pdef->bitMask;
+}
+
+
+/**
+ *  @brief Load the value of a bool-type or switch-type parameter.
+ *  @param [in] pdef Parameter definition
+ *  @return Value
+ */
+static inline bool loadFlag(PrmDef *pdef)
+{
+    if(pdef->bitMask == 0)
+        return *(bool *) pdef->dest;
+
+    return ((*(uint64_t *) pdef->dest & pdef->bitMask) != 0);
+}
+
+
+/**
+ *  @brief Store the value of a bool-type or switch-type parameter. (For the other modules)
+ *  @param [in] pdef  Parameter definition
+ *  @param [in] value Value
+ */
+void ArgParserParam_storeFlag(PrmDef *pdef, bool value)
+{
+    storeFlag(pdef, value);
+}
+
+
+/**
+ *  @brief Load the value of a bool-type or switch-type parameter. (For the other modules)
+ *  @param [in] pdef Parameter definition
+ *  @return Value
+ */
+bool ArgParserParam_loadFlag(PrmDef *pdef)
+{
+    return loadFlag(pdef);
+}
+
+
+/**
+ *  @brief Write a default value to the destination. (For the other modules)
+ *  @param [in] pdef   Parameter definition
+ *  @param [in] defVal Default value
+ *  @return Execution status
+ */
+int ArgParserParam_writeDefault(PrmDef *pdef, const Val *defVal)
+{
+    return writeDefaultValue(pdef, defVal);
+}
+
+
+/**
+ *  @brief Convert single command line argument into the specified type
+ *         and store to the destination.
+ *  @param [in] arg  Command line argument
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static inline int writeArg(const char *arg, PrmDef *pdef)
+{
+    char *errPtr = NULL; // Error pointer
+    const Validator *check = pdef->check;
+
+    switch(pdef->varType)
+    {
+        case VarType_Int:
+        {
+            int64_t v;
+            int status = parseSigned(arg, INT_MIN, INT_MAX, check, &v);
+            if(status != ArgStatus_OK)
+                return status;
+
+            *(int *) pdef->dest = (int) v;
+            return ArgStatus_OK;
+        }
+
+        case VarType_UInt:
+        {
+            uint64_t v;
+            int status = parseUnsigned(arg, UINT_MAX, check, &v);
+            if(status != ArgStatus_OK)
+                return status;
+
+            *(unsigned int *) pdef->dest = (unsigned int) v;
+            return ArgStatus_OK;
+        }
+
+        case VarType_String:
+        {
+            if(check != NULL)
+            {
+                int status = checkString(arg, check);
+                if(status != ArgStatus_OK)
+                    return status;
+            }
+
+            copyBounded((char *) pdef->dest, arg, pdef->defVal.s.len);
+            return ArgStatus_OK;
+        }
+
+        case VarType_Bool:
+        {
+            bool v = (bool) strtoul(arg, &errPtr, 0 /* auto-radix */);
+            if(*errPtr != '\0')
+                return ArgStatus_Invalid;
+
+            storeFlag(pdef, v);
+            return ArgStatus_OK;
+        }
+        
+        case VarType_Int32:
+        {
+            int64_t v;
+            int status = parseSigned(arg, INT32_MIN, INT32_MAX, check, &v);
+            if(status != ArgStatus_OK)
+                return status;
+
+            *(int32_t *) pdef->dest = (int32_t) v;
+            return ArgStatus_OK;
+        }
+        
+        case VarType_UInt32:
+        {
+            uint64_t v;
+            int status = parseUnsigned(arg, UINT32_MAX, check, &v);
+            if(status != ArgStatus_OK)
+                return status;
+
+            *(uint32_t *) pdef->dest = (uint32_t) v;
+            return ArgStatus_OK;
+        }
+
+        case VarType_Float:
+        {
+            float v = strtof(arg, &errPtr);
+            if(*errPtr != '\0')
+                return ArgStatus_Invalid;
+
+            if((check != NULL) && !((v >= check->min.d) && (v <= check->max.d))) // NaN fails too.
+                return ArgStatus_Range;
+
+            *(float *) pdef->dest = v;
+            return ArgStatus_OK;
+        }
+        
+        case VarType_Double:
+        {
+            double v = strtod(arg, &errPtr);
+            if(*errPtr != '\0')
+                return ArgStatus_Invalid;
+
+            if((check != NULL) && !((v >= check->min.d) && (v <= check->max.d)))
+                return ArgStatus_Range;
+
+            *(double *) pdef->dest = v;
+            return ArgStatus_OK;
+        }
+
+        case VarType_True:
+        {
+            bool v = (bool) strtoul(arg, &errPtr, 0 /* auto-radix */);
+            if(*errPtr != '\0')
+                return ArgStatus_Invalid;
+
+            storeFlag(pdef, v);
+            return ArgStatus_OK;
+        }
+
+        case VarType_Action:
+            /* An action has no value. */
+            return ArgStatus_Invalid;
+
+        default:
+            /* Unreachable */
+            return ArgStatus_OK;
+    }
+}
+
+
+/**
+ *  @brief Parse a signed integer, and check it against the type and the validator at full width.
+ *  @param [in]  arg   Command line argument
+ *  @param [in]  lo    Minimum value of the type
+ *  @param [in]  hi    Maximum value of the type
+ *  @param [in]  check Validator, or NULL
+ *  @param [out] v     Value
+ *  @return Conversion status (ArgStatus)
+ */
+static inline int parseSigned(const char *arg, int64_t lo, int64_t hi, const Validator *check, int64_t *v)
+{
+    char *errPtr = NULL;
+
+    errno = 0;
+    long long n = strtoll(arg, &errPtr, 0 /* auto-radix */);
+    if((errPtr == arg) || (*errPtr != '\0') || (errno == ERANGE) || (n < lo) || (n > hi))
+        return ArgStatus_Invalid;
+
+    if((check != NULL) && ((n < check->min.i) || (n > check->max.i)))
+        return ArgStatus_Range;
+
+    *v = n;
+    return ArgStatus_OK;
+}
+
+
+/**
+ *  @brief Parse an unsigned integer, and check it against the type and the validator at full width.
+ *         A negative value is not wrapped around, but rejected.
+ *  @param [in]  arg   Command line argument
+ *  @param [in]  hi    Maximum value of the type
+ *  @param [in]  check Validator, or NULL
+ *  @param [out] v     Value
+ *  @return Conversion status (ArgStatus)
+ */
+static inline int parseUnsigned(const char *arg, uint64_t hi, const Validator *check, uint64_t *v)
+{
+    const char *p = arg;
+    char *errPtr = NULL;
+
+    while(isspace((unsigned char) *p) != 0)
+        p++;
+    if(*p == '-')
+        return ArgStatus_Invalid;
+
+    errno = 0;
+    unsigned long long n = strtoull(p, &errPtr, 0 /* auto-radix */);
+    if((errPtr == p) || (*errPtr != '\0') || (errno == ERANGE) || (n > hi))
+        return ArgStatus_Invalid;
+
+    if((check != NULL) && ((n < check->min.u) || (n > check->max.u)))
+        return ArgStatus_Range;
+
+    *v = n;
+    return ArgStatus_OK;
+}
+
+
+/**
+ *  @brief Check a string against the length, the character class and the encoding of the validator.
+ *  @param [in] arg   String
+ *  @param [in] check Validator
+ *  @return Conversion status (ArgStatus)
+ */
+static inline int checkString(const char *arg, const Validator *check)
+{
+    /* Measure and classify (or validate the encoding) in the same pass. */
+    const unsigned char *p = (const unsigned char *) arg;
+    size_t len = 0;
+    if(check->scanText != NULL)
+    {
+        int status;
+        len = check->scanText(arg, check->allowControl, &status);
+        if(status != ArgStatus_OK)
+            return status;
+    }
+
+    if(check->charset != NULL)
+    {
+        for(; *p != '\0'; p++)
+        {
+            if(((check->charBits[*p >> 6] >> (*p & 63)) & 1) == 0)
+                return ArgStatus_Charset;
+        }
+        len = (size_t) (p - (const unsigned char *) arg);
+    }
+    else if(check->scanText == NULL)
+    {
+        len = strlen(arg);
+    }
+
+    if((len < check->minLen) || (len > check->maxLen))
+        return ArgStatus_Length;
+
+    return ArgStatus_OK;
+}
+
+
+/**
+ *  @brief Convert a default value (of ArgParser_setDefault() or a config file) into 'val'.
+ *         The value goes through the same validator as a command line argument.
+ *  @param [in]  obj   ArgParser object (which gets the error message)
+ *  @param [in]  value Value, in the command line format
+ *  @param [in]  pdef  Parameter definition
+ *  @param [out] val   Converted value (a string refers to 'value')
+ *  @return Execution status
+ */
+static int convertDefault(ArgParser *obj, const char *value, PrmDef *pdef, Val *val)
+{
+    int status;
+
+    if(pdef->varType == VarType_String)
+    {
+        status = (pdef->check != NULL) ? checkString(value, pdef->check) : ArgStatus_OK;
+        val->s.data = (char *) value;
+        val->s.len  = pdef->defVal.s.len;
+    }
+    else
+    {
+        /* Convert the value with a copy of the definition, which writes into 'val'. */
+        PrmDef tmp = *pdef;
+        tmp.dest    = val;
+        tmp.bitMask = 0;
+        status = writeArg(value, &tmp);
+    }
+
+    if(status != ArgStatus_OK)
+    {
+        setArgError(obj, value, pdef, status);
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ *  @brief Convert a command line argument, and mark the parameter as given if it succeeds.
+ *  @param [in] obj  ArgParser object (which holds the parse state)
+ *  @param [in] arg  Command line argument
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static inline int convertArg(ArgParser *obj, const char *arg, PrmDef *pdef)
+{
+    int status = writeArg(arg, pdef);
+    if(status == ArgStatus_OK)
+        stateOf(obj, pdef)->isSet = true;
+
+    return status;
+}
+
+
+/**
+ *  @brief Get the parse state of a parameter on this object.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition (of the schema of the object)
+ *  @return Parse state
+ */
+static inline PrmState* stateOf(ArgParser *obj, PrmDef *pdef)
+{
+    if(isPosParam(pdef->sOpt, pdef->lOpt) == true)
+        return &(obj->posStates[pdef - obj->posPrms]);
+
+    return &(obj->optStates[pdef - obj->optPrms]);
+}
+
+
+/**
+ *  @brief Store a value argument: convert it now, or record it in the lazy mode.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] arg  Command line argument
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static inline int storeArg(ArgParser *obj, const char *arg, PrmDef *pdef)
+{
+    if(obj->isLazy == false)
+        return convertArg(obj, arg, pdef);
+
+    PrmState *state = stateOf(obj, pdef);
+    state->raw   = arg;
+    state->isSet = true;
+    return 0;
+}
+
+
+/**
+ *  @brief Store the error message of a failed conversion.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] arg    Command line argument
+ *  @param [in] pdef   Parameter definition
+ *  @param [in] status Conversion result (ArgStatus)
+ *  @return Execution status
+ */
+static int setArgError(ArgParser *obj, const char *arg, PrmDef *pdef, int status)
+{
+    const Validator *check = pdef->check;
+
+    switch(status)
+    {
+        case ArgStatus_Range:
+            if((pdef->varType == VarType_Int) || (pdef->varType == VarType_Int32))
+                return ArgParserError_set(obj, "Out of range: arg %s, %s must be in [%lld, %lld].",
+                        arg, pdef->name, (long long) check->min.i, (long long) check->max.i);
+
+            if((pdef->varType == VarType_UInt) || (pdef->varType == VarType_UInt32))
+                return ArgParserError_set(obj, "Out of range: arg %s, %s must be in [%llu, %llu].",
+                        arg, pdef->name, (unsigned long long) check->min.u, (unsigned long long) check->max.u);
+
+            return ArgParserError_set(obj, "Out of range: arg %s, %s must be in [%g, %g].", arg, pdef->name, check->min.d, check->max.d);
+
+        case ArgStatus_Length:
+            return ArgParserError_set(obj, "Invalid length: arg %s, %s must have %u to %u characters.",
+                    arg, pdef->name, check->minLen, check->maxLen);
+
+        case ArgStatus_Charset:
+            return ArgParserError_set(obj, "Invalid character: arg %s, %s accepts [%s] only.", arg, pdef->name, check->charset);
+
+        case ArgStatus_Utf8:
+            // The argument is not echoed: it may break the terminal or the log.
+            return ArgParserError_set(obj, "Invalid UTF-8: the value of %s is not valid UTF-8 text.", pdef->name);
+
+        case ArgStatus_Control:
+            return ArgParserError_set(obj, "Invalid character: the value of %s has a control character.", pdef->name);
+
+        default:
+            return ArgParserError_set(obj, "Invalid value: arg %s, %s", arg, pdef->name);
+    }
+}
+
+
+/**
+ *  @brief Get the validator of a parameter, or add a new one which accepts any value.
+ *  @param [in]  obj  ArgParser object
+ *  @param [in]  name Parameter name
+ *  @param [out] pdef Parameter definition
+ *  @return Validator if success, NULL otherwise.
+ */
+static Validator* validatorOf(ArgParser *obj, const char *name, PrmDef **pdef)
+{
+    if((checkNotShrunk(obj) == false) || (checkNotShared(obj) == false))
+        return NULL;
+
+    *pdef = findUniqueParam(obj, name);
+    if(*pdef == NULL)
+        return NULL;
+
+    if((*pdef)->check != NULL)
+        return (*pdef)->check;
+
+    Validator *check = (Validator *) allocArena(obj, sizeof(Validator), sizeof(uint64_t));
+    if(check == NULL)
+        return NULL;
+
+    memset(check, 0x00, sizeof(Validator));
+    check->min.i  = INT64_MIN;
+    check->max.i  = INT64_MAX;
+    if(((*pdef)->varType == VarType_UInt) || ((*pdef)->varType == VarType_UInt32))
+    {
+        check->min.u = 0;
+        check->max.u = UINT64_MAX;
+    }
+    else if(((*pdef)->varType == VarType_Float) || ((*pdef)->varType == VarType_Double))
+    {
+        check->min.d = -HUGE_VAL;
+        check->max.d = HUGE_VAL;
+    }
+    check->minLen = 0;
+    check->maxLen = UINT32_MAX;
+
+    (*pdef)->check = check;
+    return check;
+}
+
+
+/**
+ *  @brief Compile a character class into a bitmap of the byte values.
+ *  @param [in]  charset  Character class ("a-z0-9_", "^/")
+ *  @param [out] charBits Bitmap (256 bits)
+ *  @return Execution status
+ */
+static int compileCharset(const char *charset, uint64_t *charBits)
+{
+    const unsigned char *p = (const unsigned char *) charset;
+    bool negate = false;
+    unsigned int c, i;
+
+    memset(charBits, 0x00, sizeof(uint64_t) * 4);
+
+    if(*p == '^')
+    {
+        negate = true;
+        p++;
+    }
+
+    if(*p == '\0')
+        return 1;
+
+    for(; *p != '\0'; p++)
+    {
+        unsigned int lo = p[0];
+        unsigned int hi = p[0];
+
+        // A '-' at the end is the character itself.
+        if((p[1] == '-') && (p[2] != '\0'))
+        {
+            hi = p[2];
+            p += 2;
+        }
+
+        if(lo > hi)
+            return 1;
+
+        for(c = lo; c <= hi; c++)
+            charBits[c >> 6] |= 1ULL << (c & 63);
+    }
+
+    if(negate == true)
+    {
+        for(i = 0; i < 4; i++)
+            charBits[i] = ~charBits[i];
+    }
+
+    charBits[0] &= ~1ULL; // The terminator is never a member.
+    return 0;
+}
+
+
+/**
+ *  @brief Calculate the shape hash of a command line.
+ *         The number of arguments and the spellings of the option-like arguments (up to any '=')
+ *         are hashed, and the other arguments count only by their positions. The values which
+ *         start with '-' count as spellings.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Shape hash
+ */
+static inline uint64_t shapeOf(int argc, char **argv)
+{
+    uint64_t shape = 0xcbf29ce484222325ULL ^ (uint64_t) argc;
+    int i;
+    for(i = 1; i < argc; i++)
+    {
+        const unsigned char *arg = (const unsigned char *) argv[i];
+
+        // The spellings count up to any '=', the other tokens only as slots.
+        if(arg[0] == '-')
+        {
+            for(; (*arg != '\0') && (*arg != '='); arg++)
+                shape = (shape ^ *arg) * 0x100000001b3ULL;
+            shape = (shape ^ *arg) * 0x100000001b3ULL;
+        }
+
+        shape = (shape ^ 0xff) * 0x100000001b3ULL; // No byte of a spelling ends it.
+    }
+
+    return shape;
+}
+
+
+/**
+ *  @brief Run the cached plan which matches the command line.
+ *         The shape covers the option spellings and the positions of the other tokens,
+ *         so the plan of the same shape and length is the plan of the command line.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] shape  Shape hash
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @retval -1 No plan matched.
+ *  @retval 0  Success.
+ *  @retval 1  Error.
+ */
+static int runPlan(ArgParser *obj, uint64_t shape, int argc, char **argv)
+{
+    Plan *plan = NULL;
+    unsigned int s, p;
+    int i;
+
+    /* Find the plan. */
+    for(p = 0; (p < APARSER_PLAN_CACHE_SIZE) && (plan == NULL); p++)
+    {
+        Plan *cand = &(obj->plans[p]);
+        if((cand->steps != NULL) && (cand->shape == shape) && (cand->argc == argc))
+            plan = cand;
+    }
+
+    if(plan == NULL)
+        return -1;
+
+    /* Convert the values. */
+    APARSER_TRACE_BEGIN(obj, tDefaults);
+    if(writeDefaultParams(obj) != 0)
+        return 1;
+    APARSER_TRACE_END(obj, tDefaults, TracePhase_Defaults, -1, NULL);
+
+    for(s = 0, i = 1; s < plan->numSteps; s++)
+    {
+        PlanStep *step = &(plan->steps[s]);
+        int status;
+
+        // The plan skips the classify and lookup phases.
+        APARSER_TRACE_BEGIN(obj, tConvert);
+        if(step->spelling == NULL)
+            status = storeArg(obj, argv[i++], step->pdef);
+        else if(step->isNegated == true)
+            status = convertArg(obj, "0", step->pdef), i++;
+        else if(step->pdef->varType == VarType_Action)
+        {
+            status = runAction(obj, step->pdef, NULL);
+            if(status == ArgParserAction_Stop)
+            {
+                obj->isStopped = true;
+                break;
+            }
+
+            if(status != ArgParserAction_Continue)
+            {
+                ArgParserError_set(obj, "Action failed: Near the arg %s.", argv[i]);
+                return 1;
+            }
+            i++;
+        }
+        else if(step->pdef->varType == VarType_True)
+            status = convertArg(obj, "1", step->pdef), i++;
+        else
+            status = storeArg(obj, argv[i + 1], step->pdef), i += 2;
+        APARSER_TRACE_END(obj, tConvert, TracePhase_Convert, i - 1, argv[i - 1]);
+
+        if(status != ArgStatus_OK)
+        {
+            setArgError(obj, argv[i - 1], step->pdef, status);
+            return 1;
+        }
+    }
+
+    APARSER_TRACE_BEGIN(obj, tProviders);
+    int status = runDefaultProviders(obj);
+    APARSER_TRACE_END(obj, tProviders, TracePhase_Providers, -1, NULL);
+    return (status != 0) ? 1 : 0;
+}
+
+
+/**
+ *  @brief Prepare the buffer to record the steps of a new plan.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argc Number of command line arguments
+ *  @return Step buffer, or NULL if it cannot be allocated. (The plan is not recorded.)
+ */
+static PlanStep* preparePlanSteps(ArgParser *obj, int argc)
+{
+    if(obj->planScratchLen < (unsigned int) argc)
+    {
+        PlanStep *steps = (PlanStep *) realloc(obj->planScratch, sizeof(PlanStep) * argc);
+        if(steps == NULL)
+            return NULL;
+
+        obj->planScratch    = steps;
+        obj->planScratchLen = argc;
+    }
+
+    return obj->planScratch;
+}
+
+
+/**
+ *  @brief Store a recorded plan into the cache, replacing the oldest one.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] shape    Shape hash
+ *  @param [in] argc     Number of command line arguments
+ *  @param [in] steps    Recorded steps
+ *  @param [in] numSteps Number of steps
+ */
+static void storePlan(ArgParser *obj, uint64_t shape, int argc, PlanStep *steps, unsigned int numSteps)
+{
+    Plan *plan = &(obj->plans[obj->nextPlan]);
+    PlanStep *copy = (PlanStep *) malloc(sizeof(PlanStep) * (numSteps + 1));
+    if(copy == NULL)
+        return;
+
+    memcpy(copy, steps, sizeof(PlanStep) * numSteps);
+    free(plan->steps);
+    plan->shape    = shape;
+    plan->argc     = argc;
+    plan->numSteps = numSteps;
+    plan->steps    = copy;
+
+    obj->nextPlan = (obj->nextPlan + 1) % APARSER_PLAN_CACHE_SIZE;
+}
+
+
+/**
+ *  @brief Clear the parse-plan cache.
+ *  @param [in] obj ArgParser object
+ */
+static void clearPlans(ArgParser *obj)
+{
+    unsigned int p;
+    for(p = 0; p < APARSER_PLAN_CACHE_SIZE; p++)
+    {
+        free(obj->plans[p].steps);
+        memset(&(obj->plans[p]), 0x00, sizeof(Plan));
+    }
+
+    obj->nextPlan = 0;
+}
+
+
+/**
+ *  @brief Find the namespace of an option through the prefix table.
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Command line argument
+ *  @return Namespace if found, NULL otherwise.
+ */
+static inline Namespace* findNamespace(ArgParser *obj, const char *arg)
+{
+    if((arg[0] != '-') || (arg[1] != '-'))
+        return NULL;
+
+    unsigned int idx = obj->nsHeads[(unsigned char) arg[2]];
+    while(idx != 0)
+    {
+        Namespace *ns = &(obj->namespaces[idx - 1]);
+        if(strncmp(arg, ns->prefix, ns->len) == 0)
+            return ns;
+
+        idx = ns->next;
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Prepare the schema of a namespace for the parse.
+ *  @param [in] obj ArgParser object
+ *  @param [in] sub Schema of the namespace
+ *  @return Execution status
+ */
+static int prepareNamespace(ArgParser *obj, ArgParser *sub)
+{
+    if(checkNotShrunk(sub) == false)
+        goto error;
+
+    if((sub->isFrozen == false) && (ArgParser_freeze(sub) != 0))
+        goto error;
+
+    if(writeDefaultParams(sub) != 0)
+        goto error;
+
+    return 0;
+
+error: /* error handling */
+
+    ArgParserError_set(obj, "%s", sub->errorMsg);
+    return 1;
+}
+
+
+/**
+ *  @brief Read /proc/self/cmdline into the object, and split it on the NULs in place.
+ *         The file is read at once in most cases; the buffer grows only for long command lines.
+ *  @param [in]  obj  ArgParser object
+ *  @param [out] argc Number of arguments
+ *  @return Execution status
  */
-static PrmDef* findOptionalParam(ArgParser *obj, const char *arg)
+static int readSelfCmdline(ArgParser *obj, int *argc)
 {
-    unsigned int i = 0;
-    for(i = 0; i < obj->numOptPrms; i++)
+    size_t size = 0;
+    size_t cap  = APARSER_MAX_BUF;
+    char *args  = NULL;
+    char **argv = NULL;
+    size_t i;
+    int n;
+
+    int fd = open("/proc/self/cmdline", O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
     {
-        PrmDef *pdef = &(obj->optPrms[i]);
-        if((strcmp(arg, pdef->sOpt) == 0) || (strcmp(arg, pdef->lOpt) == 0))
-            return pdef;
+        ArgParserError_set(obj, "Cannot open /proc/self/cmdline.");
+        return 1;
     }
 
-    return NULL;
+    /* Read the whole file. */
+    while(1)
+    {
+        if((args == NULL) || (size == cap))
+        {
+            cap = (args == NULL) ? cap : (cap * 2);
+            char *tmp = (char *) realloc(args, cap + 1);
+            if(tmp == NULL)
+            {
+                ArgParserError_set(obj, "Cannot allocate memory.");
+                goto error;
+            }
+            args = tmp;
+        }
+
+        ssize_t len = read(fd, args + size, cap - size);
+        if(len < 0)
+        {
+            ArgParserError_set(obj, "Cannot read /proc/self/cmdline.");
+            goto error;
+        }
+        if(len == 0)
+            break;
+
+        size += len;
+    }
+    close(fd);
+    fd = -1;
+
+    // Terminate the last argument, even if truncated.
+    if((size == 0) || (args[size - 1] != '\0'))
+        args[size++] = '\0';
+
+    /* Split on the NULs. The arguments stay where they are. */
+    n = 0;
+    for(i = 0; i < size; i++)
+        n += (args[i] == '\0');
+
+    argv = (char **) malloc(sizeof(char *) * (n + 1));
+    if(argv == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        goto error;
+    }
+
+    n = 0;
+    for(i = 0; i < size; i += strlen(args + i) + 1)
+        argv[n++] = args + i;
+    argv[n] = NULL;
+
+    free(obj->selfArgs);
+    free(obj->selfArgv);
+    obj->selfArgs = args;
+    obj->selfArgv = argv;
+    *argc = n;
+    return 0;
+
+error: /* error handling */
+
+    if(fd >= 0)
+        close(fd);
+    free(args);
+    free(argv);
+    return 1;
+}
+
+
+/**
+ *  @brief Find a parameter for the getters, and convert its pending value.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] name    Parameter name
+ *  @param [in] varType Expected variable type (VarType_Bool also accepts VarType_True, and the help and version actions)
+ *  @return Parameter definition if success. NULL otherwise.
+ */
+static PrmDef* getParam(ArgParser *obj, const char *name, VarType varType)
+{
+    if(checkNotShrunk(obj) == false)
+        return NULL;
+
+    PrmDef *pdef = findParamByName(obj, name);
+    if(pdef == NULL)
+    {
+        ArgParserError_set(obj, "Unknown parameter name: '%s'.", name);
+        return NULL;
+    }
+
+    bool isSwitch = (pdef->varType == VarType_True) || ((pdef->varType == VarType_Action) && (pdef->dest != NULL));
+    if((pdef->varType != varType) && !((varType == VarType_Bool) && (isSwitch == true)))
+    {
+        ArgParserError_set(obj, "Type mismatch: the parameter '%s' has another type.", name);
+        return NULL;
+    }
+
+    if(convertPending(obj, pdef) != 0)
+        return NULL;
+
+    return pdef;
+}
+
+
+/**
+ *  @brief Convert the recorded value of the lazy mode, if any.
+ *         A value which fails is dropped, and the parameter gets its default value,
+ *         so only the first access reports the error.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status
+ */
+static int convertPending(ArgParser *obj, PrmDef *pdef)
+{
+    PrmState *state = stateOf(obj, pdef);
+    if(state->raw == NULL)
+        return 0;
+
+    const char *raw = state->raw;
+    state->raw = NULL;
+
+    int status = writeArg(raw, pdef);
+    if(status != ArgStatus_OK)
+    {
+        // The destination still holds the default value.
+        state->isSet = false;
+        if(provideDefault(obj, pdef) == 0)
+            setArgError(obj, raw, pdef, status);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Determine argument type
+ *  @param [in] arg Command line argument.
+ *  @return Argument type
+ */
+static inline ArgType determineArgType(const char *arg)
+{
+    /* Only the first three characters are inspected, whatever the length is. */
+    if((arg[0] == '-') && (arg[1] == '-'))
+    {
+        if((arg[2] != '\0') && (arg[2] != '-'))
+            return ArgType_Opt; // An argument which starts with '--'.
+
+        return ArgType_Error; // '--' or an argument which starts with '---' (invalid).
+    }
+    else if(arg[0] == '-')
+    {
+        if(arg[1] != '\0')
+            return ArgType_Opt; // A token which starts with '-'.
+
+        return ArgType_Error; // '-' (invalid).
+    }
+    else
+    {
+        return ArgType_NoOpt; // Normal Argument.
+    }
 };
 
 
+/**
+ *  @brief Copy a string into a fixed-size buffer, truncating it if needed.
+ *         Unlike strncpy(), the rest of the buffer is not padded,
+ *         so the cost depends on the string, not on the buffer size.
+ *  @param [out] dest Destination buffer
+ *  @param [in]  src  Source string
+ *  @param [in]  size Buffer size including the null termination
+ */
+static inline void copyBounded(char *dest, const char *src, unsigned int size)
+{
+    if(size == 0)
+        return;
+
+    size_t len = strnlen(src, size - 1);
+    memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
 
 /**
- *  @brief Write defult parameters.
+ *  @brief Run the action of an action-type option.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @param [in] arg  Value given as "--option=value", or NULL
+ *  @return Action result (ArgParserAction)
+ */
+static int runAction(ArgParser *obj, PrmDef *pdef, const char *arg)
+{
+    stateOf(obj, pdef)->isSet = true;
+    if(pdef->dest != NULL)
+        *(bool *) pdef->dest = true;
+
+    return pdef->action(obj, arg, pdef->actionCtx);
+}
+
+
+/**
+ *  @brief Action of the help option.
+ *         Prints the help message, or searches it for "--help=<keyword>".
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Keyword, or NULL
+ *  @param [in] ctx Unused
+ *  @return Action result (ArgParserAction)
+ */
+static int helpAction(ArgParser *obj, const char *arg, void *ctx)
+{
+    (void) ctx;
+
+    int status = (arg != NULL) ? searchHelp(obj, stdout, arg) : printHelp(obj, stdout, 0);
+    if(status != 0)
+        return ArgParserAction_Error;
+
+    if(obj->exitOnHelp == true)
+        exit(0);
+
+    return ArgParserAction_Stop;
+}
+
+
+/**
+ *  @brief Action of the version option.
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Unused
+ *  @param [in] ctx Unused
+ *  @return Action result (ArgParserAction)
+ */
+static int versionAction(ArgParser *obj, const char *arg, void *ctx)
+{
+    (void) arg;
+    (void) ctx;
+
+    printVersion(obj, stdout);
+    if(obj->exitOnHelp == true)
+        exit(0);
+
+    return ArgParserAction_Stop;
+}
+
+
+/**
+ *  @brief Store error message. (Shared by all the modules)
  *  @param [in] obj ArgParser object
+ *  @param [in] fmt Format string
+ *  @param [in] ...      
  *  @return Execution status
  */
-static int writeDefaultParams(ArgParser *obj)
+int ArgParserError_set(ArgParser *obj, const char *fmt, ...)
 {
-    int status = 0;
-    
-    /* Write default values for the optional parameters */
+    va_list va;
+
+    va_start(va, fmt);
+    vsnprintf(obj->errorMsg, APARSER_MAX_ERROR_MSG, fmt, va);
+    va_end(va);
+    obj->hasError = true;
+
+    return 0;
+}
+
+
+/**
+ *  @brief Check that the definitions have not been released by ArgParser_shrink().
+ *  @param [in] obj ArgParser object
+ *  @retval true  The definitions are available.
+ *  @retval false The parser has been shrunk. (The error message is set.)
+ */
+static bool checkNotShrunk(ArgParser *obj)
+{
+    if(obj->isShrunk == false)
+        return true;
+
+    ArgParserError_set(obj, "The parameter definitions have been released by ArgParser_shrink().");
+    return false;
+}
+
+
+/**
+ *  @brief Check that the schema is not shared with clones.
+ *  @param [in] obj ArgParser object
+ *  @retval true  The schema can be changed.
+ *  @retval false The schema is shared. (The error message is set.)
+ */
+static bool checkNotShared(ArgParser *obj)
+{
+    if((obj->schema == NULL) && (obj->refCount == 1))
+        return true;
+
+    ArgParserError_set(obj, "The schema is shared by ArgParser_clone() and cannot be changed.");
+    return false;
+}
+
+
+/**
+ *  @brief Print help message, from the cache of the width.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] fp    Output file pointer
+ *  @param [in] width Terminal width (0: detect)
+ *  @return Execution status
+ */
+static int printHelp(ArgParser *obj, FILE *fp, unsigned int width)
+{
+    HelpCache *cache = NULL;
     unsigned int i;
-    for(i = 0; i < obj->numOptPrms; i++)
+
+    if(width == 0)
+        width = detectWidth(fp);
+
+    for(i = 0; i < APARSER_HELP_CACHE_SIZE; i++)
     {
-        PrmDef *pdef = &(obj->optPrms[i]);
-        status = writeDefaultValue(pdef);
-        if(status != 0)
+        if((obj->helpCache[i].text != NULL) && (obj->helpCache[i].width == width))
+            cache = &(obj->helpCache[i]);
+    }
+
+    /* Render for a new width, replacing the oldest one. */
+    if(cache == NULL)
+    {
+        char *text = NULL;
+        size_t len = 0;
+
+        FILE *mem = open_memstream(&text, &len);
+        if(mem == NULL)
+        {
+            ArgParserError_set(obj, "Cannot allocate memory.");
+            return 1;
+        }
+
+        renderHelp(obj, mem, width);
+        if(fclose(mem) != 0)
+        {
+            free(text);
+            ArgParserError_set(obj, "Cannot allocate memory.");
+            return 1;
+        }
+
+        cache = &(obj->helpCache[obj->nextHelp]);
+        free(cache->text);
+        cache->width = width;
+        cache->text  = text;
+        cache->len   = len;
+        obj->nextHelp = (obj->nextHelp + 1) % APARSER_HELP_CACHE_SIZE;
+    }
+
+    fwrite(cache->text, 1, cache->len, fp);
+    return 0;
+}
+
+
+/**
+ *  @brief Render help message: usage, and the parameters in aligned columns.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] fp    Output file pointer
+ *  @param [in] width Terminal width
+ */
+static void renderHelp(ArgParser *obj, FILE *fp, unsigned int width)
+{
+    unsigned int cellWidth = 0;
+    unsigned int i;
+
+    fprintf(fp, "\n");
+    fprintf(fp, "Usage   : %s [-h/--help] [-v/--version] (optional_parameters ...) ", obj->progName);
+    for(i = 0; i < obj->numPosPrms; i++)
+        fprintf(fp, "[%s] ", obj->posPrms[i].name);
+    fprintf(fp, "\n");
+    fprintf(fp, "\n");
+
+    /* Width of the left column: the longest cell, up to a third of the terminal. */
+    for(i = 0; i < obj->numOptPrms + obj->numPosPrms; i++)
+    {
+        PrmDef *pdef = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        unsigned int len = printParamCell(pdef, NULL);
+        cellWidth = (len > cellWidth) ? len : cellWidth;
+    }
+    if(cellWidth > width / 3)
+        cellWidth = width / 3;
+
+    // Print optional parameter descriptions.
+    if(obj->numOptPrms != 0)
+    {
+        fprintf(fp, "Optional Parameter%s:\n", (obj->numOptPrms != 1) ? "s" : "");
+        for(i = 0; i < obj->numOptPrms; i++)
+            printParamDescription(&(obj->optPrms[i]), fp, cellWidth, width);
+        fprintf(fp, "\n");
+    }
+
+    // Print positional parameter descriptions.
+    if(obj->numPosPrms != 0)
+    {
+        fprintf(fp, "Positional Parameter%s:\n", (obj->numPosPrms != 1) ? "s" : "");
+        for(i = 0; i < obj->numPosPrms; i++)
+            printParamDescription(&(obj->posPrms[i]), fp, cellWidth, width);
+        fprintf(fp, "\n");
+    }
+}
+
+
+/**
+ *  @brief Print the left cell of a parameter: its spellings and <name> (or name) and type.
+ *  @param [in] pdef Parameter definition
+ *  @param [in] fp   Output file pointer (NULL: only measure)
+ *  @return Cell length
+ */
+static unsigned int printParamCell(PrmDef *pdef, FILE *fp)
+{
+    const char *typeNames[VarType_Num] =
+    {
+        "[int]"    , // VarType_Int    
+        "[uint]"   , // VarType_UInt   
+        "[string]" , // VarType_String 
+        "[0/1]"    , // VarType_Bool   
+        "[int32]"  , // VarType_Int32  
+        "[uint32]" , // VarType_UInt32 
+        "[float]"  , // VarType_Float  
+        "[double]" , // VarType_Double 
+        "",          // VarType_True   
+        ""           // VarType_Action
+    };
+    const char *type = typeNames[pdef->varType];
+    const char *delim = ((pdef->sOpt[0] != '\0') && (pdef->lOpt[0] != '\0')) ? " / " : "";
+
+    if((pdef->sOpt[0] == '\0') && (pdef->lOpt[0] == '\0')) // Positional parameter
+    {
+        if(fp != NULL)
+            fprintf(fp, "%s %s", pdef->name, type);
+        return strlen(pdef->name) + 1 + strlen(type);
+    }
+
+    if(type[0] == '\0') // Switch
+    {
+        if(fp != NULL)
+            fprintf(fp, "%s%s%s", pdef->sOpt, delim, pdef->lOpt);
+        return strlen(pdef->sOpt) + strlen(delim) + strlen(pdef->lOpt);
+    }
+
+    if(fp != NULL)
+        fprintf(fp, "%s%s%s <%s> %s", pdef->sOpt, delim, pdef->lOpt, pdef->name, type);
+    return strlen(pdef->sOpt) + strlen(delim) + strlen(pdef->lOpt) + 2 + strlen(pdef->name) + 2 + strlen(type);
+}
+
+
+/**
+ *  @brief Print parameter description: the cell, and the description wrapped at the word breaks.
+ *  @param [in] pdef      Parameter definition
+ *  @param [in] fp        Output file pointer
+ *  @param [in] cellWidth Width of the left column
+ *  @param [in] width     Terminal width
+ */
+static int printParamDescription(PrmDef *pdef, FILE *fp, unsigned int cellWidth, unsigned int width)
+{
+    const unsigned int descCol = 2 + cellWidth + 2;
+    unsigned int avail = (width > descCol + APARSER_HELP_MIN_DESC) ? (width - descCol) : APARSER_HELP_MIN_DESC;
+    unsigned int col;
+    unsigned int w;
+
+    // Cell. A long one pushes the description to the next line.
+    fprintf(fp, "  ");
+    unsigned int len = printParamCell(pdef, fp);
+    if(pdef->numWords == 0)
+    {
+        fprintf(fp, "\n");
+        return 0;
+    }
+
+    if(len > cellWidth)
+        fprintf(fp, "\n%*s", descCol, "");
+    else
+        fprintf(fp, "%*s", cellWidth - len + 2, "");
+
+    /* Lay out the precomputed words. */
+    col = 0;
+    for(w = 0; w < pdef->numWords; w++)
+    {
+        HelpWord *word = &(pdef->words[w]);
+
+        // Line break in the description
+        if(word->len == 0)
         {
-            setErrorMsg(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
-            goto error;
+            fprintf(fp, "\n%*s", descCol, "");
+            col = 0;
+            continue;
         }
-    }
 
-    /* Write default values for the positional parameters */
-    for(i = 0; i < obj->numPosPrms; i++)
-    {
-        PrmDef *pdef = &(obj->posPrms[i]);
-        status = writeDefaultValue(pdef);
-        if(status != 0)
+        if((col != 0) && (col + 1 + word->len > avail))
         {
-            setErrorMsg(obj, "Cannot write default value. near the parameter '%s',", pdef->name);
-            goto error;
+            fprintf(fp, "\n%*s", descCol, "");
+            col = 0;
         }
-    }
 
-    return 0;
+        if(col != 0)
+        {
+            fputc(' ', fp);
+            col++;
+        }
 
-error: /* error handling */
+        fwrite(pdef->desc + word->start, 1, word->len, fp);
+        col += word->len;
+    }
+    fprintf(fp, "\n");
 
-    return 1;
+    return 0;
 }
 
 
 /**
- *  @brief Convert a value into the specified type and store to the destination.
- *  @param [in] pdef Parameter definition
- *  @return Execution status
+ *  @brief Detect the terminal width: $COLUMNS, the terminal of the output, or 80.
+ *  @param [in] fp Output file pointer
+ *  @return Terminal width
  */
-static int writeDefaultValue(PrmDef *pdef)
+static unsigned int detectWidth(FILE *fp)
 {
-    switch(pdef->varType)
-    {
-        case VarType_Int:
-            *(int *) pdef->dest = pdef->defVal.i;
-            return 0;
+    struct winsize ws;
 
-        case VarType_UInt:
-            *(unsigned int *) pdef->dest = pdef->defVal.u;
-            return 0;
-
-        case VarType_String:
-        {
-            char *p = NULL;
-            p = (char *) pdef->dest; 
-            strncpy(p, pdef->defVal.s.data, pdef->defVal.s.len);
-            p[pdef->defVal.s.len - 1] = '\0';
-            return 0;
-        }
+    const char *columns = getenv("COLUMNS");
+    if((columns != NULL) && (atoi(columns) > 0))
+        return atoi(columns);
 
-        case VarType_Bool:
-            *(bool *) pdef->dest = pdef->defVal.b;
-            return 0;
-        
-        case VarType_Int32:
-            *(int32_t *) pdef->dest = pdef->defVal.i32;
-            return 0;
-        
-        case VarType_UInt32:
-            *(uint32_t *) pdef->dest = pdef->defVal.u32;
-            return 0;
+    if((ioctl(fileno(fp), TIOCGWINSZ, &ws) == 0) && (ws.ws_col != 0))
+        return ws.ws_col;
 
-        case VarType_Float:
-            *(float *) pdef->dest = pdef->defVal.f;
+    return APARSER_HELP_WIDTH;
+}
 
-            return 0;
-        
-        case VarType_Double:
-            *(double *) pdef->dest = pdef->defVal.d;
-            return 0;
-        
-        case VarType_True:
-            *(bool*) pdef->dest = pdef->defVal.b;
-            return 0;
 
-        default:
-            /* Unreachable */
-            return 1;
+/**
+ *  @brief Release the rendered help messages.
+ *  @param [in] obj ArgParser object
+ */
+static void clearHelpCache(ArgParser *obj)
+{
+    unsigned int i;
+    for(i = 0; i < APARSER_HELP_CACHE_SIZE; i++)
+    {
+        free(obj->helpCache[i].text);
+        memset(&(obj->helpCache[i]), 0x00, sizeof(HelpCache));
     }
+
+    obj->nextHelp = 0;
+
+    free(obj->searchText);
+    free(obj->search);
+    obj->searchText = NULL;
+    obj->search     = NULL;
+    obj->numSearch  = 0;
 }
 
 
 /**
- *  @brief Convert single command line argument into the specified type
- *         and store to the destination.
- *  @param [in] arg  Command line argument
- *  @param [in] pdef Parameter definition
+ *  @brief Print help message of the parameters matching a keyword.
+ *         The search index is built on the first search, so that a query costs
+ *         a binary search and the size of its result.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] fp      Output file pointer
+ *  @param [in] keyword Keyword
  *  @return Execution status
  */
-static int writeArg(const char *arg, PrmDef *pdef)
+static int searchHelp(ArgParser *obj, FILE *fp, const char *keyword)
 {
-    char *errPtr = NULL; // Error pointer
-    switch(pdef->varType)
-    {
-        case VarType_Int:
-            *(int *) pdef->dest = strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
-
-            return 0;
+    unsigned int lo, hi, end, i;
+    unsigned int numMatches = 0;
+    unsigned int cellWidth  = 0;
+    unsigned int *matches   = NULL;
 
-        case VarType_UInt:
+    if((obj->search == NULL) && (buildSearchIndex(obj) != 0))
+        return 1;
 
-            *(unsigned int *) pdef->dest = strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
+    /* Lowercase the keyword, as the index. */
+    size_t len = strlen(keyword);
+    char *key = (char *) malloc(len + 1);
+    if(key == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        goto error;
+    }
 
-            return 0;
+    for(i = 0; i <= len; i++)
+        key[i] = tolower((unsigned char) keyword[i]);
 
-        case VarType_String:
-        {
-            char *p = (char *) pdef->dest; 
-            int len = pdef->defVal.s.len;
-            strncpy(p, arg, len);
-            p[len - 1] = '\0';
-            return 0;
-        }
+    /* Find the first word not less than the keyword. */
+    lo = 0;
+    hi = obj->numSearch;
+    while(lo < hi)
+    {
+        unsigned int mid = (lo + hi) / 2;
+        if(strcmp(obj->search[mid].word, key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-        case VarType_Bool:
-            *(bool *) pdef->dest = (bool) strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
+    /* The words which start with the keyword follow. */
+    for(end = lo; (end < obj->numSearch) && (strncmp(obj->search[end].word, key, len) == 0); end++)
+        ;
 
-            return 0;
-        
-        case VarType_Int32:
+    if(end == lo)
+    {
+        fprintf(fp, "No parameters match '%s'.\n", keyword);
+        goto end;
+    }
 
-            *(int32_t *) pdef->dest = strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
+    /* Collect their parameters in the registration order, as the full help does. */
+    matches = (unsigned int *) malloc(sizeof(unsigned int) * (end - lo));
+    if(matches == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        goto error;
+    }
 
-            return 0;
-        
-        case VarType_UInt32:
-            *(uint32_t *) pdef->dest = strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
+    for(i = lo; i < end; i++)
+        matches[i - lo] = obj->search[i].param;
+    qsort(matches, end - lo, sizeof(unsigned int), compareParams);
 
-            return 0;
+    for(i = 0; i < end - lo; i++)
+    {
+        if((numMatches == 0) || (matches[numMatches - 1] != matches[i]))
+            matches[numMatches++] = matches[i];
+    }
 
-        case VarType_Float:
-            *(float *) pdef->dest = strtof(arg, &errPtr);
-            if(*errPtr != '\0')
-                return 1;
+    for(i = 0; i < numMatches; i++)
+    {
+        PrmDef *pdef = (matches[i] < obj->numOptPrms) ? &(obj->optPrms[matches[i]]) : &(obj->posPrms[matches[i] - obj->numOptPrms]);
+        unsigned int cell = printParamCell(pdef, NULL);
+        cellWidth = (cell > cellWidth) ? cell : cellWidth;
+    }
 
-            return 0;
-        
-        case VarType_Double:
-            *(double *) pdef->dest = strtod(arg, &errPtr);
-            if(*errPtr != '\0')
-                return 1;
+    unsigned int width = detectWidth(fp);
+    if(cellWidth > width / 3)
+        cellWidth = width / 3;
 
-            return 0;
+    fprintf(fp, "\n");
+    fprintf(fp, "Parameter%s matching '%s':\n", (numMatches != 1) ? "s" : "", keyword);
+    for(i = 0; i < numMatches; i++)
+    {
+        PrmDef *pdef = (matches[i] < obj->numOptPrms) ? &(obj->optPrms[matches[i]]) : &(obj->posPrms[matches[i] - obj->numOptPrms]);
+        printParamDescription(pdef, fp, cellWidth, width);
+    }
+    fprintf(fp, "\n");
 
-        case VarType_True:
-            *(bool *) pdef->dest = (bool) strtoul(arg, &errPtr, 0 /* auto-radix */);
-            if(*errPtr != '\0')
-                return 1;
+end:
+    free(key);
+    free(matches);
+    return 0;
 
-            return 0;
+error: /* error handling */
 
-        default:
-            /* Unreachable */
-            return 0;
-    }
+    free(key);
+    free(matches);
+    return 1;
 }
 
 
 /**
- *  @brief Determine argument type
- *  @param [in] arg Command line argument.
- *  @return Argument type
+ *  @brief Build the help search index: the lowercased words of the names, the descriptions
+ *         and the spellings, sorted, each with its parameter.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
  */
-static ArgType determineArgType(const char *arg)
+static int buildSearchIndex(ArgParser *obj)
 {
-    if((strlen(arg) >= 3) && (arg[0] == '-') && (arg[1] == '-'))
-    {
-        if(arg[2] != '-')
-            return ArgType_Opt; // An argument which starts with '--'.
+    unsigned int numPrms = obj->numOptPrms + obj->numPosPrms;
+    unsigned int numWords = 0;
+    size_t textLen = 0;
+    unsigned int i, n;
 
-        return ArgType_Error; //  An argument which starts with '---' (invalid).
-    }
-    else if((strlen(arg) >= 2) && (arg[0] == '-'))
+    /* Size the index: count the words and their bytes. */
+    for(i = 0; i < numPrms; i++)
     {
-        if(arg[1] != '-')
-            return ArgType_Opt; // A token which starts with '--'.
+        PrmDef *pdef = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        numWords += countWords(pdef->name, &textLen) + countWords(pdef->desc, &textLen)
+                  + countWords(pdef->sOpt, &textLen) + countWords(pdef->lOpt, &textLen);
+    }
 
-        return ArgType_Error; // '--' (invalid).
+    // One more of each, so that an empty index is not NULL.
+    obj->searchTextLen = textLen + 1;
+    obj->searchText    = (char *) malloc(textLen + 1);
+    obj->search        = (SearchEntry *) malloc(sizeof(SearchEntry) * (numWords + 1));
+    if((obj->searchText == NULL) || (obj->search == NULL))
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        goto error;
     }
-    else
+
+    /* Collect the words. */
+    char *text = obj->searchText;
+    n = 0;
+    for(i = 0; i < numPrms; i++)
     {
-        if(arg[0] != '-')
-            return ArgType_NoOpt; // Normal Argument.
+        PrmDef *pdef = (i < obj->numOptPrms) ? &(obj->optPrms[i]) : &(obj->posPrms[i - obj->numOptPrms]);
+        const char *strs[4] = { pdef->name, pdef->desc, pdef->sOpt, pdef->lOpt };
+        unsigned int s;
 
-        return ArgType_Error; // '-' (invalid).
+        for(s = 0; s < 4; s++)
+        {
+            unsigned int added = addWords(strs[s], i, text, &(obj->search[n]));
+            if(added != 0)
+            {
+                const char *last = obj->search[n + added - 1].word;
+                text = (char *) last + strlen(last) + 1;
+            }
+            n += added;
+        }
     }
-};
+    obj->numSearch = n;
 
+    qsort(obj->search, obj->numSearch, sizeof(SearchEntry), compareEntries);
+    return 0;
 
-/**
- *  @brief Check if a help opetion is specified.
- *  @param [in] arg Command line argument
- *  @retval true  The argument is a help option.
- *  @retval false The argument is not a help option. 
- */
-static bool isHelpOption(const char *arg)
-{
-    return (strcmp(arg, "-h") == 0) || (strcmp(arg, "--help") == 0);
-};
-
+error: /* error handling */
 
-/**
- *  @brief Check if a version opetion is specified.
- *  @param [in] arg Command line argument
- *  @retval true  The argument is a version option.
- *  @retval false The argument is not a version option.
- */
-static bool isVerOption(const char *arg)
-{
-    return (strcmp(arg, "-v") == 0) || (strcmp(arg, "--version") == 0);
-};
+    free(obj->searchText);
+    free(obj->search);
+    obj->searchText = NULL;
+    obj->search     = NULL;
+    return 1;
+}
 
 
 /**
- *  @brief Store error message.
- *  @param [in] obj ArgParser object
- *  @param [in] fmt Format string
- *  @param [in] ...      
+ *  @brief Count the alphanumeric words of a string.
+ *  @param [in]     str     String
+ *  @param [in,out] textLen Bytes of the words, each with a NUL (added)
+ *  @return Number of words
  */
-static int setErrorMsg(ArgParser *obj, char *fmt, ...)
+static unsigned int countWords(const char *str, size_t *textLen)
 {
-    va_list va;
+    unsigned int n = 0;
+    unsigned int i = 0;
 
-    va_start(va, fmt);
-    vsnprintf(obj->errorMsg, APARSER_MAX_ERROR_MSG, fmt, va);
-    va_end(va);
+    while(str[i] != '\0')
+    {
+        if(isalnum((unsigned char) str[i]) == 0)
+        {
+            i++;
+            continue;
+        }
 
-    return 0;
+        n++;
+        while(isalnum((unsigned char) str[i]) != 0)
+        {
+            i++;
+            (*textLen)++;
+        }
+        (*textLen)++;
+    }
+
+    return n;
 }
 
 
 /**
- *  @brief Print help message.
- *  @param [in] obj ArgParser object
- *  @param [in] fp  Output file pointer
- *  @return Execution status
+ *  @brief Split a string into lowercased alphanumeric words, and add them to the index.
+ *  @param [in]  str     String
+ *  @param [in]  param   Parameter index
+ *  @param [out] text    Buffer of the words
+ *  @param [out] entries Index entries
+ *  @return Number of words added
  */
-static int printHelp(ArgParser *obj, FILE *fp)
+static unsigned int addWords(const char *str, unsigned int param, char *text, SearchEntry *entries)
 {
-    fprintf(fp, "\n");
-    fprintf(fp, "Usage   : %s [-h/--help] [-v/--version] (optional_parameters ...) ", obj->progName);
+    unsigned int n = 0;
+    unsigned int i = 0;
 
-    if(obj->numPosPrms != 0)
+    while(str[i] != '\0')
     {
-        int i;
-        for(i = 0; i < obj->numPosPrms; i++)
-        {  
-            PrmDef *pdef = &(obj->posPrms[i]);
-            fprintf(fp, "[%s] ", pdef->name);
+        if(isalnum((unsigned char) str[i]) == 0)
+        {
+            i++;
+            continue;
         }
-    }
-    fprintf(fp, "\n");
-    fprintf(fp, "\n");
 
-    // Print optional parameter descriptions.
-    if(obj->numOptPrms != 0)
-    {
-        fprintf(fp, "Optional Parameter%s:\n", (obj->numOptPrms != 1) ? "s" : "");
-        fprintf(fp, "\n");
+        entries[n].word  = text;
+        entries[n].param = param;
+        n++;
 
-        int i;
-        for(i = 0; i < obj->numOptPrms; i++)
-        {
-            PrmDef *pdef = &(obj->optPrms[i]);
-            printParamDescription(pdef, fp);
-        }
+        while(isalnum((unsigned char) str[i]) != 0)
+            *(text++) = tolower((unsigned char) str[i++]);
+        *(text++) = '\0';
     }
-    
-    // Print positional parameter descriptions.
-    if(obj->numPosPrms != 0)
-    {
-        fprintf(fp, "Positional Parameter%s:\n", (obj->numPosPrms != 1) ? "s" : "");
-        fprintf(fp, "\n");
 
-        int i;
-        for(i = 0; i < obj->numPosPrms; i++)
-        {
-            PrmDef *pdef = &(obj->posPrms[i]);
-            printParamDescription(pdef, fp);
-        }
-    }
-    
-    return 0;
+    return n;
 }
 
 
 /**
- *  @brief Print parameter description.
- *  @param [in] pdef Parameter definition
- *  @param [in] fp   Output file pointer
+ *  @brief Compare the search index entries, by word and parameter.
+ *  @param [in] a Entry
+ *  @param [in] b Entry
+ *  @return Comparison result
  */
-static int printParamDescription(PrmDef *pdef, FILE *fp)
+static int compareEntries(const void *a, const void *b)
 {
-    const char *typeNames[VarType_Num] =
-    {
-        "[int]"    , // VarType_Int    
-        "[uint]"   , // VarType_UInt   
-        "[string]" , // VarType_String 
-        "[0/1]"    , // VarType_Bool   
-        "[int32]"  , // VarType_Int32  
-        "[uint32]" , // VarType_UInt32 
-        "[float]"  , // VarType_Float  
-        "[double]" , // VarType_Double 
-        ""           // VarType_True   
-    };
-
-    // Indent
-    fprintf(fp, "    ");
+    const SearchEntry *ea = (const SearchEntry *) a;
+    const SearchEntry *eb = (const SearchEntry *) b;
 
-    // Short option
-    if(strlen(pdef->sOpt) != 0)
-    {
-        fprintf(fp, "%s ", pdef->sOpt);
+    int cmp = strcmp(ea->word, eb->word);
+    if(cmp != 0)
+        return cmp;
 
-        if(strlen(typeNames[pdef->varType]) != 0)
-            fprintf(fp, "%s ", typeNames[pdef->varType]);
-    }
-    
-    // Delimiter
-    if((strlen(pdef->sOpt) != 0) && (strlen(pdef->lOpt) != 0)) 
-        fprintf(fp, "/ ");
-    
-    // Long option
-    if(strlen(pdef->lOpt) != 0)
-    {
-        fprintf(fp, "%s ", pdef->lOpt);
+    return (ea->param > eb->param) - (ea->param < eb->param);
+}
 
-        if(strlen(typeNames[pdef->varType]) != 0)
-            fprintf(fp, "%s ", typeNames[pdef->varType]);
-    }
-  
-    if((strlen(pdef->sOpt) == 0) && (strlen(pdef->lOpt) == 0)) 
-        fprintf(fp, "%s ", typeNames[pdef->varType]);
- 
-    // Print parameter name.
-    fprintf(fp, ": %s\n", pdef->name);
-   
-    // Print description.
-    int i;
-    fprintf(fp, "    | description:\n");
-    fprintf(fp, "    |    ");
-    for(i = 0; pdef->desc[i] != '\0'; i++)
-    {
-        fprintf(fp, "%c", pdef->desc[i]);
 
-        if(pdef->desc[i] == '\n')
-            fprintf(fp, "    |    ");
-    }
-    fprintf(fp, "\n");
-    fprintf(fp, "\n");
+/**
+ *  @brief Compare the parameter indices.
+ *  @param [in] a Parameter index
+ *  @param [in] b Parameter index
+ *  @return Comparison result
+ */
+static int compareParams(const void *a, const void *b)
+{
+    unsigned int pa = *(const unsigned int *) a;
+    unsigned int pb = *(const unsigned int *) b;
 
-    return 0;
+    return (pa > pb) - (pa < pb);
 }
 
 
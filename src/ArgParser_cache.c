@@ -0,0 +1,632 @@
+/**
+ *  @file      ArgParser_cache.c
+ *  @brief     Argument Parser, on-disk parse cache.
+ *             Short-lived tools parse the same command line against the same configs again and
+ *             again. The value image of a parse is stored in $XDG_RUNTIME_DIR/argparser/, under
+ *             the hash of everything it depends on; the next run with the same inputs maps the
+ *             file and copies the values, without loading the configs or parsing.
+ *             The file holds the full key, so a hash collision is a miss.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+/* Macros */
+/**
+ *  @brief Magic number of the cache files. ("APC" + layout version)
+ */
+#define APARSER_CACHE_MAGIC     (0x00435041U | ((uint32_t) APARSER_CACHE_VERSION << 24))
+
+/**
+ *  @brief Subdirectory of $XDG_RUNTIME_DIR.
+ */
+#define APARSER_CACHE_DIR       "argparser"
+
+
+/* Structs */
+/**
+ *  @brief Header of a cache file. (The key and the image follow.)
+ */
+typedef struct CacheHeader_
+{
+    uint32_t magic;     ///< APARSER_CACHE_MAGIC
+    uint32_t keyLen;    ///< Key length
+    uint64_t imageLen;  ///< Image length
+} CacheHeader;
+
+
+/**
+ *  @brief Key under construction
+ */
+typedef struct CacheKey_
+{
+    uint8_t *data;  ///< Key bytes
+    size_t   len;   ///< Key length
+    size_t   cap;   ///< Capacity
+    bool     isBad; ///< If set, an allocation failed.
+} CacheKey;
+
+
+/* Signatures */
+static int buildKey(ArgParser *obj, int argc, char **argv, CacheKey *key);
+static void keyPut(CacheKey *key, const void *data, size_t len);
+static void keyPutStat(CacheKey *key, const char *path);
+static int readCache(ArgParser *obj, const char *path, int argc, char **argv, const CacheKey *key);
+static void writeCache(ArgParser *obj, const char *dir, const char *path, const CacheKey *key);
+static uint64_t schemaFingerprint(ArgParser *obj);
+static size_t saveImage(ArgParser *obj, uint8_t *image, size_t size);
+static int loadImage(ArgParser *obj, int argc, char **argv, const uint8_t *image, size_t size);
+
+
+/* Functions */
+/**
+ *  @brief Enable the on-disk parse cache under $XDG_RUNTIME_DIR.
+ *         A cached parse is keyed by the command line, the values of the given environment
+ *         variables, the identity and modification time of the given files (and of the entries
+ *         of the given directories), and the schema with its default values.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] envNames Environment variables the loader reads (NULL-terminated, or NULL)
+ *  @param [in] paths    Config files and directories the loader reads (NULL-terminated, or NULL)
+ *  @return Execution status
+ */
+int ArgParser_enableParseCache(ArgParser *obj, const char *const *envNames, const char *const *paths)
+{
+    unsigned int numEnv = 0, numPaths = 0;
+    size_t size = 1;
+    unsigned int i;
+
+    for(i = 0; (envNames != NULL) && (envNames[i] != NULL); i++, numEnv++)
+        size += strlen(envNames[i]) + 1;
+    for(i = 0; (paths != NULL) && (paths[i] != NULL); i++, numPaths++)
+        size += strlen(paths[i]) + 1;
+
+    char *deps = (char *) malloc(size);
+    if(deps == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        return 1;
+    }
+
+    char *p = deps;
+    for(i = 0; i < numEnv; i++)
+        p = stpcpy(p, envNames[i]) + 1;
+    for(i = 0; i < numPaths; i++)
+        p = stpcpy(p, paths[i]) + 1;
+    *p = '\0';
+
+    free(obj->cacheDeps);
+    obj->cacheDeps     = deps;
+    obj->numCacheEnv   = numEnv;
+    obj->numCachePaths = numPaths;
+    return 0;
+}
+
+
+/**
+ *  @brief Load the configs and parse the command line, or restore the values of the same parse.
+ *         On a miss, the loader runs, the command line is parsed, and the values are stored.
+ *         On a hit, neither runs: the values are restored from the cache file.
+ *         (Without the cache, or its directory, this is a plain load and parse.)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argc Number of command line arguments
+ *  @param [in] argv Command line argument array
+ *  @param [in] load Config loader (NULL: none)
+ *  @param [in] ctx  Context of the loader
+ *  @return Execution status
+ */
+int ArgParser_parseCached(ArgParser *obj, int argc, char **argv, ArgParser_LoadFn load, void *ctx)
+{
+    char dir[PATH_MAX];
+    char path[PATH_MAX];
+    CacheKey key;
+
+    memset(&key, 0x00, sizeof(CacheKey));
+
+    // The lazy values and the namespaces live outside the image.
+    const char *runtimeDir = getenv("XDG_RUNTIME_DIR");
+    bool useCache = (obj->cacheDeps != NULL) && (runtimeDir != NULL) && (runtimeDir[0] != '\0') &&
+                    (obj->isShrunk == false) && (obj->isLazy == false) && (obj->numNamespaces == 0);
+
+    if(useCache == true)
+    {
+        if((snprintf(dir, sizeof(dir), "%s/%s", runtimeDir, APARSER_CACHE_DIR) >= (int) sizeof(dir)) ||
+           (buildKey(obj, argc, argv, &key) != 0))
+        {
+            useCache = false;
+        }
+        else
+        {
+            /* Name the file after the key hash. (FNV-1a) */
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            size_t i;
+            for(i = 0; i < key.len; i++)
+                hash = (hash ^ key.data[i]) * 0x100000001b3ULL;
+
+            if(snprintf(path, sizeof(path), "%s/%016llx.cache", dir, (unsigned long long) hash) >= (int) sizeof(path))
+                useCache = false;
+        }
+    }
+
+    if((useCache == true) && (readCache(obj, path, argc, argv, &key) == 0))
+    {
+        free(key.data);
+        return 0;
+    }
+
+    /* Miss: load and parse, then store the values. */
+    if((load != NULL) && (load(obj, ctx) != 0))
+        goto error;
+
+    if(ArgParser_parse(obj, argc, argv) != 0)
+        goto error;
+
+    if(useCache == true)
+        writeCache(obj, dir, path, &key);
+
+    free(key.data);
+    return 0;
+
+error: /* error handling */
+
+    free(key.data);
+    return 1;
+}
+
+
+/**
+ *  @brief Build the key of a parse.
+ *  @param [in]  obj  ArgParser object
+ *  @param [in]  argc Number of command line arguments
+ *  @param [in]  argv Command line argument array
+ *  @param [out] key  Key
+ *  @return Execution status
+ */
+static int buildKey(ArgParser *obj, int argc, char **argv, CacheKey *key)
+{
+    unsigned int i;
+    int j;
+
+    uint64_t fingerprint = schemaFingerprint(obj);
+    keyPut(key, &fingerprint, sizeof(uint64_t));
+
+    /* Command line */
+    int32_t n = argc;
+    keyPut(key, &n, sizeof(int32_t));
+    for(j = 0; j < argc; j++)
+        keyPut(key, argv[j], strlen(argv[j]) + 1);
+
+    /* Environment ('\1' for an unset variable) */
+    const char *dep = obj->cacheDeps;
+    for(i = 0; i < obj->numCacheEnv; i++)
+    {
+        const char *value = getenv(dep);
+        keyPut(key, dep, strlen(dep) + 1);
+        if(value != NULL)
+            keyPut(key, value, strlen(value) + 1);
+        else
+            keyPut(key, "\1", 2);
+        dep += strlen(dep) + 1;
+    }
+
+    /* Files, and the entries of the directories */
+    for(i = 0; i < obj->numCachePaths; i++)
+    {
+        keyPutStat(key, dep);
+
+        DIR *dp = opendir(dep);
+        if(dp != NULL)
+        {
+            char entPath[PATH_MAX];
+            struct dirent *ent;
+            while((ent = readdir(dp)) != NULL)
+            {
+                if(ent->d_name[0] == '.')
+                    continue;
+                if(snprintf(entPath, sizeof(entPath), "%s/%s", dep, ent->d_name) < (int) sizeof(entPath))
+                    keyPutStat(key, entPath);
+            }
+            closedir(dp);
+        }
+        dep += strlen(dep) + 1;
+    }
+
+    return (key->isBad == true) ? 1 : 0;
+}
+
+
+/**
+ *  @brief Append bytes to a key.
+ *  @param [in] key  Key
+ *  @param [in] data Bytes
+ *  @param [in] len  Length
+ */
+static void keyPut(CacheKey *key, const void *data, size_t len)
+{
+    if(key->isBad == true)
+        return;
+
+    if(key->len + len > key->cap)
+    {
+        size_t cap = (key->cap != 0) ? key->cap : 256;
+        while(cap < key->len + len)
+            cap *= 2;
+
+        uint8_t *newData = (uint8_t *) realloc(key->data, cap);
+        if(newData == NULL)
+        {
+            key->isBad = true;
+            return;
+        }
+        key->data = newData;
+        key->cap  = cap;
+    }
+
+    memcpy(key->data + key->len, data, len);
+    key->len += len;
+}
+
+
+/**
+ *  @brief Append a path and the identity of its file to a key. (Zeros if missing)
+ *         Directory entries are read in no fixed order; a reordering is only a miss.
+ *  @param [in] key  Key
+ *  @param [in] path File path
+ */
+static void keyPutStat(CacheKey *key, const char *path)
+{
+    struct stat st;
+    uint64_t ident[5] = { 0, 0, 0, 0, 0 };
+
+    if(stat(path, &st) == 0)
+    {
+        ident[0] = (uint64_t) st.st_dev;
+        ident[1] = (uint64_t) st.st_ino;
+        ident[2] = (uint64_t) st.st_size;
+        ident[3] = (uint64_t) st.st_mtim.tv_sec;
+        ident[4] = (uint64_t) st.st_mtim.tv_nsec;
+    }
+
+    keyPut(key, path, strlen(path) + 1);
+    keyPut(key, ident, sizeof(ident));
+}
+
+
+/**
+ *  @brief Restore the values from a cache file.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path Cache file
+ *  @param [in] argc Number of command line arguments
+ *  @param [in] argv Command line argument array
+ *  @param [in] key  Key of the parse
+ *  @retval 0 Hit
+ *  @retval 1 Miss
+ */
+static int readCache(ArgParser *obj, const char *path, int argc, char **argv, const CacheKey *key)
+{
+    struct stat st;
+    int status = 1;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return 1;
+
+    if((fstat(fd, &st) != 0) || (st.st_uid != geteuid()) || ((size_t) st.st_size < sizeof(CacheHeader)))
+    {
+        close(fd);
+        return 1;
+    }
+
+    size_t size = (size_t) st.st_size;
+    const uint8_t *map = (const uint8_t *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return 1;
+
+    CacheHeader header;
+    memcpy(&header, map, sizeof(CacheHeader));
+    if((header.magic == APARSER_CACHE_MAGIC) && (header.keyLen == key->len) &&
+       (sizeof(CacheHeader) + header.keyLen + header.imageLen == size) &&
+       (memcmp(map + sizeof(CacheHeader), key->data, key->len) == 0))
+    {
+        status = loadImage(obj, argc, argv, map + sizeof(CacheHeader) + key->len, header.imageLen);
+    }
+
+    munmap((void *) map, size);
+    return status;
+}
+
+
+/**
+ *  @brief Store the values of the last parse in a cache file.
+ *         The file is written under a temporary name, and renamed over the old one.
+ *         The cache is best effort: failures leave no file, and are not reported.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] dir  Cache directory
+ *  @param [in] path Cache file
+ *  @param [in] key  Key of the parse
+ */
+static void writeCache(ArgParser *obj, const char *dir, const char *path, const CacheKey *key)
+{
+    char tmpPath[PATH_MAX];
+    CacheHeader header;
+
+    size_t imageLen = saveImage(obj, NULL, 0);
+    if(imageLen == 0)
+        return;
+
+    size_t size = sizeof(CacheHeader) + key->len + imageLen;
+    uint8_t *data = (uint8_t *) malloc(size);
+    if(data == NULL)
+        return;
+
+    header.magic    = APARSER_CACHE_MAGIC;
+    header.keyLen   = (uint32_t) key->len;
+    header.imageLen = imageLen;
+    memcpy(data, &header, sizeof(CacheHeader));
+    memcpy(data + sizeof(CacheHeader), key->data, key->len);
+    saveImage(obj, data + sizeof(CacheHeader) + key->len, imageLen);
+
+    if((mkdir(dir, 0700) != 0) && (errno != EEXIST))
+        goto end;
+
+    if(snprintf(tmpPath, sizeof(tmpPath), "%s.%ld.tmp", path, (long) getpid()) >= (int) sizeof(tmpPath))
+        goto end;
+
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if(fd < 0)
+        goto end;
+
+    size_t done = 0;
+    while(done < size)
+    {
+        ssize_t n = write(fd, data + done, size - done);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+        done += (size_t) n;
+    }
+
+    if((close(fd) != 0) || (done != size) || (rename(tmpPath, path) != 0))
+        unlink(tmpPath);
+
+end:
+
+    free(data);
+}
+
+
+/**
+ *  @brief Calculate the fingerprint of the schema and the default values of this object.
+ *         It covers everything which changes the result of a parse: the parse settings, and for
+ *         each parameter its table, name, type, spellings, aliases, validator and default value.
+ *         A value image is valid only for the same fingerprint.
+ *  @param [in] obj ArgParser object
+ *  @return Fingerprint
+ */
+static uint64_t schemaFingerprint(ArgParser *obj)
+{
+    PrmDef *tables[2] = { obj->optPrms, obj->posPrms };
+    unsigned int nums[2] = { obj->numOptPrms, obj->numPosPrms };
+    unsigned int i, t;
+
+    uint64_t hash = ArgParserHash_str(obj->progName) ^ ((uint64_t) APARSER_CACHE_VERSION << 32);
+    hash = (hash ^ ArgParserHash_str(obj->version)) * 0x100000001b3ULL;
+    hash = (hash ^ ((uint64_t) obj->reqFullPosParams | (uint64_t) obj->collectRest << 1 | (uint64_t) obj->isLazy << 2
+                    | (uint64_t) obj->numNamespaces << 8)) * 0x100000001b3ULL;
+    for(t = 0; t < 2; t++)
+    {
+        for(i = 0; i < nums[t]; i++)
+        {
+            PrmDef *pdef = &(tables[t][i]);
+            hash = (hash ^ ((uint64_t) t << 48 | i)) * 0x100000001b3ULL;   // Optional or positional
+            hash = (hash ^ ArgParserHash_str(pdef->name)) * 0x100000001b3ULL;
+            hash = (hash ^ ((uint64_t) pdef->varType << 32 | ArgParserParam_size(pdef))) * 0x100000001b3ULL;
+            hash = (hash ^ ArgParserHash_str(pdef->sOpt)) * 0x100000001b3ULL;
+            hash = (hash ^ ArgParserHash_str(pdef->lOpt)) * 0x100000001b3ULL;
+
+            Alias *alias;
+            for(alias = pdef->aliases; alias != NULL; alias = alias->next)
+                hash = (hash ^ ArgParserHash_str(alias->str) ^ (uint64_t) alias->isNegated) * 0x100000001b3ULL;
+
+            const Validator *check = pdef->check;
+            if(check != NULL)
+            {
+                hash = (hash ^ check->min.u) * 0x100000001b3ULL;
+                hash = (hash ^ check->max.u) * 0x100000001b3ULL;
+                hash = (hash ^ ((uint64_t) check->minLen << 32 | check->maxLen)) * 0x100000001b3ULL;
+                hash = (hash ^ ArgParserHash_str((check->charset != NULL) ? check->charset : "")) * 0x100000001b3ULL;
+                hash = (hash ^ ((uint64_t) (check->scanText != NULL) | (uint64_t) check->allowControl << 1)) * 0x100000001b3ULL;
+            }
+
+            hash = ArgParserParam_hashValue(hash, pdef, ArgParserParam_default(obj, pdef));
+        }
+    }
+
+    return hash;
+}
+
+
+/**
+ *  @brief Write the value image of the last parse.
+ *         The image holds the set flags and the values of the parameters in the definition
+ *         order, and the leftover arguments as indices of argv, recorded by the parse.
+ *  @param [in]  obj   ArgParser object
+ *  @param [out] image Image (NULL: measure only)
+ *  @param [in]  size  Image buffer size
+ *  @return Image size, or 0 if the parse cannot be cached.
+ */
+static size_t saveImage(ArgParser *obj, uint8_t *image, size_t size)
+{
+    PrmDef *tables[2] = { obj->optPrms, obj->posPrms };
+    PrmState *states[2] = { obj->optStates, obj->posStates };
+    unsigned int nums[2] = { obj->numOptPrms, obj->numPosPrms };
+    unsigned int i, t;
+    int k;
+    size_t len = 0;
+
+    #define PUT(src, n) do { if((image != NULL) && (len + (n) <= size)) memcpy(image + len, (src), (n)); len += (n); } while(0)
+
+    for(t = 0; t < 2; t++)
+    {
+        for(i = 0; i < nums[t]; i++)
+        {
+            PrmDef *pdef = &(tables[t][i]);
+            PrmState *state = &(states[t][i]);
+
+            // The actions (help, version, ...) have side effects, so their parses are not cached.
+            if(pdef->varType == VarType_Action)
+            {
+                if(state->isSet == true)
+                    return 0;
+                continue;
+            }
+
+            // Values of the providers are computed again on a hit.
+            uint8_t flags = (state->isSet == true) ? APARSER_CACHE_SET : 0;
+            if((pdef->defFn != NULL) && (state->isSet == false) && (ArgParserParam_hasConfig(obj, pdef) == false))
+                flags |= APARSER_CACHE_PROVIDED;
+            PUT(&flags, 1);
+
+            if(pdef->varType == VarType_String)
+            {
+                uint32_t strLen = (uint32_t) strnlen((char *) pdef->dest, ArgParserParam_size(pdef));
+                PUT(&strLen, sizeof(uint32_t));
+                PUT(pdef->dest, strLen);
+            }
+            else if(pdef->bitMask != 0)
+            {
+                bool value = ArgParserParam_loadFlag(pdef);
+                PUT(&value, sizeof(bool));
+            }
+            else
+            {
+                PUT(pdef->dest, ArgParserParam_size(pdef));
+            }
+        }
+    }
+
+    int32_t restNum = (obj->collectRest == true) ? obj->restNum : 0;
+    PUT(&restNum, sizeof(int32_t));
+    for(k = 0; k < restNum; k++)
+        PUT(&(obj->restIdx[k]), sizeof(int32_t));
+
+    #undef PUT
+
+    return len;
+}
+
+
+/**
+ *  @brief Restore the values of a parse from a value image.
+ *         The default value providers run again for the parameters they set.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] argc  Number of command line arguments
+ *  @param [in] argv  Command line argument array
+ *  @param [in] image Image
+ *  @param [in] size  Image size
+ *  @return Execution status
+ */
+static int loadImage(ArgParser *obj, int argc, char **argv, const uint8_t *image, size_t size)
+{
+    PrmDef *tables[2] = { obj->optPrms, obj->posPrms };
+    PrmState *states[2] = { obj->optStates, obj->posStates };
+    unsigned int nums[2] = { obj->numOptPrms, obj->numPosPrms };
+    unsigned int i, t;
+    int k;
+    size_t len = 0;
+
+    #define GET(dst, n) do { if(len + (n) > size) goto error; memcpy((dst), image + len, (n)); len += (n); } while(0)
+
+    for(t = 0; t < 2; t++)
+    {
+        for(i = 0; i < nums[t]; i++)
+        {
+            PrmDef *pdef = &(tables[t][i]);
+            PrmState *state = &(states[t][i]);
+            state->raw = NULL;
+            if(pdef->varType == VarType_Action)
+            {
+                state->isSet = false;
+                if(pdef->dest != NULL)
+                    *(bool *) pdef->dest = false;
+                continue;
+            }
+
+            uint8_t flags;
+            GET(&flags, 1);
+            state->isSet = ((flags & APARSER_CACHE_SET) != 0);
+
+            if(pdef->varType == VarType_String)
+            {
+                uint32_t strLen;
+                GET(&strLen, sizeof(uint32_t));
+                if(strLen >= ArgParserParam_size(pdef))
+                    goto error;
+                GET(pdef->dest, strLen);
+                ((char *) pdef->dest)[strLen] = '\0';
+            }
+            else if(pdef->bitMask != 0)
+            {
+                bool value;
+                GET(&value, sizeof(bool));
+                ArgParserParam_storeFlag(pdef, value);
+            }
+            else
+            {
+                GET(pdef->dest, ArgParserParam_size(pdef));
+            }
+
+            if(((flags & APARSER_CACHE_PROVIDED) != 0) && (pdef->defFn != NULL) && (ArgParserParam_provide(pdef) != 0))
+            {
+                if(ArgParserParam_writeDefault(pdef, ArgParserParam_default(obj, pdef)) != 0)
+                    goto error;
+            }
+        }
+    }
+
+    int32_t restNum;
+    GET(&restNum, sizeof(int32_t));
+    if((restNum < 0) || (restNum > argc) || ((restNum != 0) && (obj->collectRest == false)))
+        goto error;
+
+    if((restNum != 0) && (ArgParserRest_reserve(obj, argc) != 0))
+        return 1;
+
+    for(k = 0; k < restNum; k++)
+    {
+        int32_t idx;
+        GET(&idx, sizeof(int32_t));
+        if((idx < 0) || (idx >= argc))
+            goto error;
+        obj->restIdx[k] = idx;
+        obj->rest[k]    = argv[idx];
+    }
+    obj->restNum   = restNum;
+    obj->isStopped = false;
+
+    #undef GET
+
+    return 0;
+
+error: /* error handling */
+
+    ArgParserError_set(obj, "Broken value image.");
+    return 1;
+}
@@ -0,0 +1,591 @@
+/**
+ *  @file      ArgParser_conf.c
+ *  @brief     Argument Parser, layered conf.d directories.
+ *             The "*.conf" fragments of the directories are read and tokenized by a pool of
+ *             threads, then merged into the default values in the lexical order of their names.
+ *             The tokenized fragments stay cached on the object, keyed by the file identity,
+ *             so a reload parses only the new or changed fragments.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+/* Macros */
+/**
+ *  @brief Maximum number of threads reading the fragments.
+ */
+#ifndef APARSER_CONF_THREADS
+#define APARSER_CONF_THREADS    8
+#endif
+
+/**
+ *  @brief Suffix of the fragment files.
+ */
+#define APARSER_CONF_SUFFIX     ".conf"
+
+
+/* Structs */
+/**
+ *  @brief Setting of a fragment ("name = value")
+ */
+typedef struct ConfEntry_
+{
+    const char   *name;  ///< Option name (without "--")
+    const char   *value; ///< Value
+    unsigned int  line;  ///< Line number
+} ConfEntry;
+
+
+/**
+ *  @brief Tokenized fragment
+ */
+typedef struct ConfFragment_
+{
+    char            *name;       ///< File name (the merge key)
+    char            *path;       ///< File path
+    dev_t            dev;        ///< Device of the file
+    ino_t            ino;        ///< Inode of the file
+    struct timespec  mtime;      ///< Modification time of the file
+    off_t            size;       ///< File size
+    char            *text;       ///< Contents, split in place
+    unsigned int     numEntries; ///< Number of settings
+    ConfEntry       *entries;    ///< Settings, in the file order
+    unsigned int     errLine;    ///< Line of the syntax error (0: none)
+    const char      *errMsg;     ///< Error (NULL: none)
+#if defined(APARSER_TRACE)
+    uint64_t         readBegin;  ///< Begin time of the read
+    uint64_t         readEnd;    ///< End time of the read
+    uint32_t         readTid;    ///< Thread which read the fragment
+#endif
+} ConfFragment;
+
+
+/**
+ *  @brief Shared state of the reader threads
+ */
+typedef struct ConfJobs_
+{
+    ConfFragment    **frags;  ///< Fragments to read
+    unsigned int      num;    ///< Number of fragments
+    _Atomic unsigned int next; ///< Next fragment to take
+} ConfJobs;
+
+
+/* Signatures */
+static int scanDir(ArgParser *obj, const char *dir, ConfFragment **frags, unsigned int *num, unsigned int *len);
+static int compareFragments(const void *a, const void *b);
+static ConfFragment* takeCached(ArgParser *obj, const ConfFragment *frag);
+static void readFragments(ConfFragment **frags, unsigned int num);
+static void* confWorker(void *arg);
+static void readFragment(ConfFragment *frag);
+static void tokenizeFragment(ConfFragment *frag);
+static void freeFragment(ConfFragment *frag);
+static int mergeFragments(ArgParser *obj);
+
+
+/* Functions */
+/**
+ *  @brief Load the option values of layered conf.d directories.
+ *         Each "*.conf" file holds lines of "name = value" (or a bare "name" for a switch),
+ *         with '#' and ';' comments. A file in a later directory masks the file of the same name
+ *         in an earlier one. The files are merged in the lexical order of their names, so the
+ *         later files override the earlier ones. The values are the default values of this object.
+ *         A negated name ("no-verbose") sets the opposite value of the flag. A name which is not
+ *         an option fails the load, unless ArgParser_setIgnoreUnknownConfig(). A failed load
+ *         leaves the default values as they were.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] dirs    Directories, lowest priority first (missing ones are skipped)
+ *  @param [in] numDirs Number of directories
+ *  @return Execution status
+ */
+int ArgParser_loadConfDirs(ArgParser *obj, const char *const *dirs, unsigned int numDirs)
+{
+    ConfFragment *frags = NULL;
+    ConfFragment *jobs[APARSER_CONF_THREADS];
+    ConfFragment **pending = NULL;
+    unsigned int num = 0, len = 0, numPending = 0;
+    unsigned int i;
+
+    /* List the fragments, the later layers masking the earlier ones. */
+    APARSER_TRACE_BEGIN(obj, tScan);
+    for(i = 0; i < numDirs; i++)
+    {
+        if(scanDir(obj, dirs[i], &frags, &num, &len) != 0)
+            goto error;
+    }
+    if(num != 0)
+        qsort(frags, num, sizeof(ConfFragment), compareFragments);
+    APARSER_TRACE_END(obj, tScan, TracePhase_ConfScan, -1, NULL);
+
+    /* Reuse the unchanged fragments, and read the others in parallel. */
+    pending = (num <= APARSER_CONF_THREADS) ? jobs : (ConfFragment **) malloc(sizeof(ConfFragment *) * num);
+    if(pending == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        goto error;
+    }
+
+    for(i = 0; i < num; i++)
+    {
+        ConfFragment *cached = takeCached(obj, &(frags[i]));
+        if(cached != NULL)
+        {
+            // Keep the new name and path (the file may have been renamed).
+            frags[i].text       = cached->text;
+            frags[i].numEntries = cached->numEntries;
+            frags[i].entries    = cached->entries;
+            frags[i].errLine    = cached->errLine;
+            frags[i].errMsg     = cached->errMsg;
+            cached->text    = NULL;
+            cached->entries = NULL;
+            continue;
+        }
+
+        pending[numPending++] = &(frags[i]);
+    }
+    readFragments(pending, numPending);
+
+#if defined(APARSER_TRACE)
+    // The readers timed themselves; their events are recorded here, by the caller.
+    for(i = 0; i < numPending; i++)
+        ArgParserTrace_record(obj, TracePhase_ConfRead, pending[i]->readTid, pending[i]->readBegin, pending[i]->readEnd, -1, pending[i]->path);
+#endif
+
+    if(pending != jobs)
+        free(pending);
+    pending = NULL;
+
+    /* Replace the cache. */
+    ArgParserConfig_freeFragments(obj);
+    obj->fragments    = frags;
+    obj->numFragments = num;
+
+    /* Merge in the lexical order, all or nothing. */
+    ConfigMark mark;
+    if(ArgParserConfig_mark(obj, &mark) != 0)
+        return 1;
+
+    int status = mergeFragments(obj);
+    ArgParserConfig_release(&mark, (status != 0));
+    return status;
+
+error: /* error handling */
+
+    for(i = 0; i < num; i++)
+        freeFragment(&(frags[i]));
+    free(frags);
+    return 1;
+}
+
+
+/**
+ *  @brief Apply the settings of the cached fragments, in the merge order.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int mergeFragments(ArgParser *obj)
+{
+    char spelling[APARSER_MAX_SPELLING];
+    unsigned int i, j;
+
+    for(i = 0; i < obj->numFragments; i++)
+    {
+        ConfFragment *frag = &(obj->fragments[i]);
+        if(frag->errMsg != NULL)
+        {
+            if(frag->errLine != 0)
+                ArgParserError_set(obj, "%s in %s:%u.", frag->errMsg, frag->path, frag->errLine);
+            else
+                ArgParserError_set(obj, "%s '%s'.", frag->errMsg, frag->path);
+            return 1;
+        }
+
+        APARSER_TRACE_BEGIN(obj, tMerge);
+        for(j = 0; j < frag->numEntries; j++)
+        {
+            ConfEntry *entry = &(frag->entries[j]);
+            int status = -1;
+            if(strlen(entry->name) + 3 <= sizeof(spelling))
+            {
+                // A negated name ("no-verbose") is looked up like "--no-verbose".
+                sprintf(spelling, "--%s", entry->name);
+                status = ArgParserConfig_apply(obj, spelling, entry->value);
+            }
+
+            if((status == -1) && (obj->ignoreUnknownConfig == false))
+            {
+                ArgParserError_set(obj, "Unknown option '%s' in %s:%u.", entry->name, frag->path, entry->line);
+                return 1;
+            }
+            if(status == 1)
+            {
+                char msg[APARSER_MAX_ERROR_MSG];
+                strcpy(msg, obj->errorMsg);
+                ArgParserError_set(obj, "%s (%s:%u)", msg, frag->path, entry->line);
+                return 1;
+            }
+        }
+        APARSER_TRACE_END(obj, tMerge, TracePhase_ConfMerge, -1, frag->path);
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Release the cached conf.d fragments.
+ *  @param [in] obj ArgParser object
+ */
+void ArgParserConfig_freeFragments(ArgParser *obj)
+{
+    unsigned int i;
+    for(i = 0; i < obj->numFragments; i++)
+        freeFragment(&(obj->fragments[i]));
+
+    free(obj->fragments);
+    obj->fragments    = NULL;
+    obj->numFragments = 0;
+}
+
+
+/**
+ *  @brief List the fragments of a directory.
+ *         A fragment of the same name as a listed one replaces it.
+ *  @param [in]     obj   ArgParser object
+ *  @param [in]     dir   Directory
+ *  @param [in,out] frags Fragments
+ *  @param [in,out] num   Number of fragments
+ *  @param [in,out] len   Capacity of the fragments
+ *  @return Execution status
+ */
+static int scanDir(ArgParser *obj, const char *dir, ConfFragment **frags, unsigned int *num, unsigned int *len)
+{
+    struct dirent *ent;
+    struct stat st;
+    size_t suffixLen = strlen(APARSER_CONF_SUFFIX);
+    unsigned int i;
+
+    DIR *dp = opendir(dir);
+    if(dp == NULL)
+    {
+        if(errno == ENOENT)
+            return 0;
+
+        ArgParserError_set(obj, "Cannot open the directory '%s'.", dir);
+        return 1;
+    }
+
+    while((ent = readdir(dp)) != NULL)
+    {
+        size_t nameLen = strlen(ent->d_name);
+        if((ent->d_name[0] == '.') || (nameLen <= suffixLen) ||
+           (strcmp(ent->d_name + nameLen - suffixLen, APARSER_CONF_SUFFIX) != 0))
+            continue;
+
+        char *path = (char *) malloc(strlen(dir) + nameLen + 2);
+        if(path == NULL)
+            goto nomem;
+        sprintf(path, "%s/%s", dir, ent->d_name);
+
+        if((stat(path, &st) != 0) || (S_ISREG(st.st_mode) == 0))
+        {
+            free(path);
+            continue;
+        }
+
+        /* Find the masked fragment, or make a new one. */
+        ConfFragment *frag = NULL;
+        for(i = 0; i < *num; i++)
+        {
+            if(strcmp((*frags)[i].name, ent->d_name) == 0)
+            {
+                frag = &((*frags)[i]);
+                freeFragment(frag);
+                break;
+            }
+        }
+
+        if(frag == NULL)
+        {
+            if(*num == *len)
+            {
+                unsigned int newLen = (*len != 0) ? (*len * 2) : 16;
+                ConfFragment *newFrags = (ConfFragment *) realloc(*frags, sizeof(ConfFragment) * newLen);
+                if(newFrags == NULL)
+                {
+                    free(path);
+                    goto nomem;
+                }
+
+                *frags = newFrags;
+                *len   = newLen;
+            }
+            frag = &((*frags)[(*num)++]);
+        }
+
+        memset(frag, 0x00, sizeof(ConfFragment));
+        frag->path  = path;
+        frag->name  = path + strlen(dir) + 1;
+        frag->dev   = st.st_dev;
+        frag->ino   = st.st_ino;
+        frag->mtime = st.st_mtim;
+        frag->size  = st.st_size;
+    }
+
+    closedir(dp);
+    return 0;
+
+nomem: /* error handling */
+
+    closedir(dp);
+    ArgParserError_set(obj, "Cannot allocate memory.");
+    return 1;
+}
+
+
+/**
+ *  @brief Compare the fragments by name.
+ *  @param [in] a Fragment
+ *  @param [in] b Fragment
+ *  @return Comparison result
+ */
+static int compareFragments(const void *a, const void *b)
+{
+    return strcmp(((const ConfFragment *) a)->name, ((const ConfFragment *) b)->name);
+}
+
+
+/**
+ *  @brief Take the tokens of an unchanged fragment from the cache.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] frag Listed fragment
+ *  @return Cached fragment if found, NULL otherwise.
+ */
+static ConfFragment* takeCached(ArgParser *obj, const ConfFragment *frag)
+{
+    unsigned int i;
+    for(i = 0; i < obj->numFragments; i++)
+    {
+        ConfFragment *cached = &(obj->fragments[i]);
+        if((cached->entries != NULL) && (cached->dev == frag->dev) && (cached->ino == frag->ino) &&
+           (cached->size == frag->size) && (cached->mtime.tv_sec == frag->mtime.tv_sec) &&
+           (cached->mtime.tv_nsec == frag->mtime.tv_nsec))
+            return cached;
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Read and tokenize the fragments with a pool of threads.
+ *         The calling thread takes part, and reads all of them if no thread can be started.
+ *  @param [in] frags Fragments
+ *  @param [in] num   Number of fragments
+ */
+static void readFragments(ConfFragment **frags, unsigned int num)
+{
+    pthread_t threads[APARSER_CONF_THREADS - 1];
+    unsigned int numThreads = 0;
+    ConfJobs jobs;
+
+    jobs.frags = frags;
+    jobs.num   = num;
+    atomic_init(&(jobs.next), 0);
+
+    while((numThreads + 1 < num) && (numThreads < APARSER_CONF_THREADS - 1))
+    {
+        if(pthread_create(&(threads[numThreads]), NULL, confWorker, &jobs) != 0)
+            break;
+        numThreads++;
+    }
+
+    confWorker(&jobs);
+
+    while(numThreads != 0)
+        pthread_join(threads[--numThreads], NULL);
+}
+
+
+/**
+ *  @brief Take the fragments one by one, and read them.
+ *  @param [in] arg Shared state (ConfJobs)
+ *  @return NULL
+ */
+static void* confWorker(void *arg)
+{
+    ConfJobs *jobs = (ConfJobs *) arg;
+
+    while(true)
+    {
+        unsigned int i = atomic_fetch_add(&(jobs->next), 1);
+        if(i >= jobs->num)
+            break;
+#if defined(APARSER_TRACE)
+        ConfFragment *frag = jobs->frags[i];
+        frag->readBegin = ArgParserTrace_now();
+        readFragment(frag);
+        frag->readEnd   = ArgParserTrace_now();
+        frag->readTid   = ArgParserTrace_tid();
+#else
+        readFragment(jobs->frags[i]);
+#endif
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Read a fragment, and tokenize it. (Errors are kept in the fragment.)
+ *  @param [in] frag Fragment
+ */
+static void readFragment(ConfFragment *frag)
+{
+    size_t size = (size_t) frag->size;
+    size_t got = 0;
+
+    int fd = open(frag->path, O_RDONLY);
+    if(fd < 0)
+    {
+        frag->errMsg = "Cannot open";
+        return;
+    }
+
+    frag->text = (char *) malloc(size + 1);
+    if(frag->text == NULL)
+    {
+        close(fd);
+        frag->errMsg = "Cannot allocate memory for";
+        return;
+    }
+
+    while(got < size)
+    {
+        ssize_t n = read(fd, frag->text + got, size - got);
+        if(n <= 0)
+        {
+            if((n < 0) && (errno == EINTR))
+                continue;
+            break;
+        }
+        got += (size_t) n;
+    }
+    close(fd);
+    frag->text[got] = '\0';
+
+    tokenizeFragment(frag);
+}
+
+
+/**
+ *  @brief Split the lines of a fragment in place into settings.
+ *  @param [in] frag Fragment
+ */
+static void tokenizeFragment(ConfFragment *frag)
+{
+    unsigned int maxEntries = 1;
+    unsigned int line = 0;
+    char *p;
+
+    for(p = frag->text; (p = strchr(p, '\n')) != NULL; p++)
+        maxEntries++;
+
+    frag->entries = (ConfEntry *) malloc(sizeof(ConfEntry) * maxEntries);
+    if(frag->entries == NULL)
+    {
+        frag->errMsg = "Cannot allocate memory for";
+        return;
+    }
+
+    char *next = frag->text;
+    while(next != NULL)
+    {
+        char *cur = next;
+        line++;
+
+        next = strchr(cur, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+
+        /* Trim the line, and skip the blank and comment lines. */
+        while((*cur == ' ') || (*cur == '\t'))
+            cur++;
+        char *end = cur + strlen(cur);
+        while((end > cur) && ((end[-1] == ' ') || (end[-1] == '\t') || (end[-1] == '\r')))
+            end--;
+        *end = '\0';
+
+        if((*cur == '\0') || (*cur == '#') || (*cur == ';'))
+            continue;
+
+        /* Name, and value after '=' */
+        const char *value = "1";
+        char *eq = strchr(cur, '=');
+        if(eq != NULL)
+        {
+            char *val = eq + 1;
+            while((*val == ' ') || (*val == '\t'))
+                val++;
+
+            size_t valLen = strlen(val);
+            if((valLen >= 2) && (val[0] == '"') && (val[valLen - 1] == '"'))
+            {
+                val[valLen - 1] = '\0';
+                val++;
+            }
+            value = val;
+
+            *eq = '\0';
+            end = eq;
+            while((end > cur) && ((end[-1] == ' ') || (end[-1] == '\t')))
+                end--;
+            *end = '\0';
+        }
+
+        if((cur[0] == '-') && (cur[1] == '-'))
+            cur += 2;
+
+        if((*cur == '\0') || (strpbrk(cur, " \t") != NULL))
+        {
+            frag->errMsg  = "Invalid option name";
+            frag->errLine = line;
+            return;
+        }
+
+        ConfEntry *entry = &(frag->entries[frag->numEntries++]);
+        entry->name  = cur;
+        entry->value = value;
+        entry->line  = line;
+    }
+}
+
+
+/**
+ *  @brief Release a fragment.
+ *  @param [in] frag Fragment
+ */
+static void freeFragment(ConfFragment *frag)
+{
+    free(frag->path);
+    free(frag->text);
+    free(frag->entries);
+    frag->path    = NULL;
+    frag->name    = NULL;
+    frag->text    = NULL;
+    frag->entries = NULL;
+}
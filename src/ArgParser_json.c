@@ -0,0 +1,680 @@
+/**
+ *  @file      ArgParser_json.c
+ *  @brief     Argument Parser, JSON config input.
+ *             The file is mapped, and indexed in two stages like simdjson: the first stage
+ *             classifies 64 bytes at a time with SIMD compares into bit masks, and flattens
+ *             the structural characters outside the strings into an array of positions.
+ *             The second stage walks the positions, and applies each value through the
+ *             option lookup and the conversion of the command line. Strings are unescaped
+ *             in the (private) mapping, so nothing is allocated per key.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+/* Macros */
+/**
+ *  @brief Maximum nesting depth of the objects.
+ */
+#define APARSER_JSON_MAX_DEPTH   32
+
+/**
+ *  @brief Maximum length of a number or a literal.
+ */
+#define APARSER_JSON_MAX_SCALAR  64
+
+
+/* Structs */
+/**
+ *  @brief Bit masks of a 64-byte block
+ */
+typedef struct JsonMasks_
+{
+    uint64_t quote;     ///< '"'
+    uint64_t backslash; ///< '\\'
+    uint64_t op;        ///< '{', '}', '[', ']', ':', ','
+    uint64_t space;     ///< ' ', '\t', '\n', '\r'
+} JsonMasks;
+
+
+/**
+ *  @brief Mapped and indexed document
+ */
+typedef struct JsonDoc_
+{
+    ArgParser  *obj;    ///< ArgParser object
+    const char *path;   ///< File path (for the messages)
+    char       *buf;    ///< Mapped file
+    size_t      size;   ///< File size
+    uint32_t   *pos;    ///< Positions of the structural characters, and of the scalar starts
+    size_t      num;    ///< Number of positions
+    size_t      len;    ///< Allocated number of positions
+} JsonDoc;
+
+
+/* Signatures */
+static inline void jsonClassify(const uint8_t *block, JsonMasks *masks);
+static inline uint64_t jsonEscapedQuotes(uint64_t backslash, uint64_t *prevOdd);
+static inline uint64_t jsonPrefixXor(uint64_t bits);
+static int jsonIndex(JsonDoc *doc);
+static int jsonWalk(JsonDoc *doc);
+static int jsonString(JsonDoc *doc, size_t i, char **str, size_t *len);
+static size_t jsonSkip(JsonDoc *doc, size_t i);
+
+
+/* Functions */
+/**
+ *  @brief Load the option values of a JSON config file.
+ *         Each member of the top-level object sets the long option of its name, and nested
+ *         objects set the options of the dotted path. ({"db": {"port": 5432}} sets --db.port.)
+ *         The values are the default values of this object, so the command line overrides them.
+ *         Numbers, strings and true/false are converted like the arguments, and null and arrays
+ *         are skipped. A negated key ({"no-verbose": true}) sets the opposite value of the flag.
+ *         A member which is not an option fails the load, unless ArgParser_setIgnoreUnknownConfig().
+ *         The load is all or nothing: a failed load leaves the default values as they were.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path File path
+ *  @return Execution status
+ */
+int ArgParser_loadJson(ArgParser *obj, const char *path)
+{
+    JsonDoc doc;
+    struct stat st;
+
+    APARSER_TRACE_BEGIN(obj, tJson);
+    memset(&doc, 0x00, sizeof(JsonDoc));
+    doc.obj  = obj;
+    doc.path = path;
+    doc.buf  = MAP_FAILED;
+
+    int fd = open(path, O_RDONLY);
+    if((fd < 0) || (fstat(fd, &st) != 0))
+    {
+        ArgParserError_set(obj, "Cannot open '%s'.", path);
+        goto error;
+    }
+
+    if((st.st_size == 0) || ((uint64_t) st.st_size >= UINT32_MAX))
+    {
+        ArgParserError_set(obj, "Invalid size of the config file '%s'.", path);
+        goto error;
+    }
+    doc.size = (size_t) st.st_size;
+
+    // Private and writable: the strings are unescaped in place.
+    doc.buf = (char *) mmap(NULL, doc.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(doc.buf == MAP_FAILED)
+    {
+        ArgParserError_set(obj, "Cannot map '%s'.", path);
+        goto error;
+    }
+    close(fd);
+    fd = -1;
+
+    if(jsonIndex(&doc) != 0)
+        goto error;
+
+    // The values are applied as they are found, and undone if the walk fails.
+    ConfigMark mark;
+    if(ArgParserConfig_mark(obj, &mark) != 0)
+        goto error;
+
+    int status = jsonWalk(&doc);
+    ArgParserConfig_release(&mark, (status != 0));
+    if(status != 0)
+        goto error;
+
+    free(doc.pos);
+    munmap(doc.buf, doc.size);
+    APARSER_TRACE_END(obj, tJson, TracePhase_Json, -1, path);
+    return 0;
+
+error: /* error handling */
+
+    free(doc.pos);
+    if(doc.buf != MAP_FAILED)
+        munmap(doc.buf, doc.size);
+    if(fd >= 0)
+        close(fd);
+    APARSER_TRACE_END(obj, tJson, TracePhase_Json, -1, path);
+    return 1;
+}
+
+
+/**
+ *  @brief Classify the 64 bytes of a block into bit masks.
+ *  @param [in]  block Block (64 bytes)
+ *  @param [out] masks Bit masks
+ */
+static inline void jsonClassify(const uint8_t *block, JsonMasks *masks)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i brace = _mm_set1_epi8('{');   // '[' | 0x20
+    const __m128i close = _mm_set1_epi8('}');   // ']' | 0x20
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    unsigned int k;
+
+    memset(masks, 0x00, sizeof(JsonMasks));
+    for(k = 0; k < 4; k++)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) (block + 16 * k));
+        __m128i l = _mm_or_si128(v, lower);
+
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(l, brace), _mm_cmpeq_epi8(l, close)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+
+        unsigned int shift = 16 * k;
+        masks->quote     |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << shift;
+        masks->backslash |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash)) << shift;
+        masks->op        |= (uint64_t) (uint16_t) _mm_movemask_epi8(op) << shift;
+        masks->space     |= (uint64_t) (uint16_t) _mm_movemask_epi8(ws) << shift;
+    }
+#else
+    unsigned int k;
+
+    memset(masks, 0x00, sizeof(JsonMasks));
+    for(k = 0; k < 64; k++)
+    {
+        uint64_t bit = (uint64_t) 1 << k;
+        switch(block[k])
+        {
+            case '"':  masks->quote |= bit;     break;
+            case '\\': masks->backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                masks->op |= bit;
+                break;
+            case ' ': case '\t': case '\n': case '\r':
+                masks->space |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+#endif
+}
+
+
+/**
+ *  @brief Find the characters escaped by an odd sequence of backslashes.
+ *  @param [in]     backslash Backslash mask of the block
+ *  @param [in,out] prevOdd   1 if the previous block ended with an odd sequence
+ *  @return Mask of the escaped characters
+ */
+static inline uint64_t jsonEscapedQuotes(uint64_t backslash, uint64_t *prevOdd)
+{
+    const uint64_t evenBits = 0x5555555555555555ULL;
+    const uint64_t oddBits  = ~evenBits;
+
+    uint64_t startEdges = backslash & ~(backslash << 1);
+    uint64_t evenStartMask = evenBits ^ *prevOdd;
+    uint64_t evenStarts = startEdges & evenStartMask;
+    uint64_t oddStarts  = startEdges & ~evenStartMask;
+
+    uint64_t evenCarries = backslash + evenStarts;
+    uint64_t oddCarries;
+    bool endsOdd = __builtin_add_overflow(backslash, oddStarts, &oddCarries);
+    oddCarries |= *prevOdd;
+    *prevOdd = endsOdd ? 1 : 0;
+
+    uint64_t evenCarryEnds = evenCarries & ~backslash;
+    uint64_t oddCarryEnds  = oddCarries & ~backslash;
+    return (evenCarryEnds & oddBits) | (oddCarryEnds & evenBits);
+}
+
+
+/**
+ *  @brief Compute the prefix XOR of the bits. (Bit i is the XOR of the bits 0 to i.)
+ *  @param [in] bits Bits
+ *  @return Prefix XOR
+ */
+static inline uint64_t jsonPrefixXor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+
+/**
+ *  @brief Build the structural index. (Stage 1)
+ *         The positions are the operators outside the strings, the opening quotes, and
+ *         the starts of the numbers and the literals. (The closing quotes are found back
+ *         from the next position.)
+ *  @param [in] doc Document
+ *  @return Execution status
+ */
+static int jsonIndex(JsonDoc *doc)
+{
+    uint8_t tail[64];
+    uint64_t prevOdd = 0;
+    uint64_t prevInString = 0;
+    uint64_t prevPseudo = 1;    // The start of the file counts as a separator.
+    JsonMasks m;
+    size_t off;
+
+    doc->len = doc->size / 8 + 64;
+    doc->pos = (uint32_t *) malloc(sizeof(uint32_t) * doc->len);
+    if(doc->pos == NULL)
+        goto nomem;
+
+    for(off = 0; off < doc->size; off += 64)
+    {
+        const uint8_t *block = (const uint8_t *) doc->buf + off;
+        if(doc->size - off < 64)
+        {
+            // Pad the last block with spaces.
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, doc->size - off);
+            block = tail;
+        }
+
+        jsonClassify(block, &m);
+
+        uint64_t quotes = m.quote & ~jsonEscapedQuotes(m.backslash, &prevOdd);
+        uint64_t inString = jsonPrefixXor(quotes) ^ prevInString;
+        prevInString = (uint64_t) ((int64_t) inString >> 63);
+
+        uint64_t structurals = (m.op & ~inString) | quotes;
+
+        // A scalar starts after a separator, outside the strings.
+        uint64_t pseudoPred = structurals | m.space;
+        uint64_t shifted = (pseudoPred << 1) | prevPseudo;
+        prevPseudo = pseudoPred >> 63;
+        structurals |= shifted & ~m.space & ~inString;
+
+        // Drop the closing quotes.
+        structurals &= ~(quotes & ~inString);
+
+        if(doc->num + 64 > doc->len)
+        {
+            size_t len = doc->len * 2;
+            uint32_t *pos = (uint32_t *) realloc(doc->pos, sizeof(uint32_t) * len);
+            if(pos == NULL)
+                goto nomem;
+
+            doc->pos = pos;
+            doc->len = len;
+        }
+
+        while(structurals != 0)
+        {
+            doc->pos[doc->num++] = (uint32_t) (off + __builtin_ctzll(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if(prevInString != 0)
+    {
+        ArgParserError_set(doc->obj, "Unterminated string in '%s'.", doc->path);
+        return 1;
+    }
+
+    return 0;
+
+nomem: /* error handling */
+
+    ArgParserError_set(doc->obj, "Cannot allocate memory.");
+    return 1;
+}
+
+
+/**
+ *  @brief Walk the structural index, and apply the values. (Stage 2)
+ *  @param [in] doc Document
+ *  @return Execution status
+ */
+static int jsonWalk(JsonDoc *doc)
+{
+    char path[APARSER_MAX_SPELLING];
+    size_t lens[APARSER_JSON_MAX_DEPTH];    // Path length at each depth
+    char scalar[APARSER_JSON_MAX_SCALAR];
+    unsigned int depth = 0;
+    const char *buf = doc->buf;
+    size_t i;
+
+    if((doc->num == 0) || (doc->buf[doc->pos[0]] != '{'))
+    {
+        ArgParserError_set(doc->obj, "The top level of '%s' is not an object.", doc->path);
+        return 1;
+    }
+
+    strcpy(path, "--");
+    lens[0] = 2;
+    i = 1;
+
+    bool isFirst = true;
+    while(true)
+    {
+        if(i >= doc->num)
+            goto truncated;
+
+        /* Member (an empty object is closed below) */
+        if((isFirst == false) || (buf[doc->pos[i]] != '}'))
+        {
+            char *key;
+            size_t keyLen;
+            if((buf[doc->pos[i]] != '"') || (jsonString(doc, i, &key, &keyLen) != 0))
+                goto syntax;
+
+            i++;
+            if((i >= doc->num) || (buf[doc->pos[i]] != ':'))
+                goto syntax;
+
+            i++;
+            if(i >= doc->num)
+                goto truncated;
+
+            // A path too long matches no option.
+            size_t len = lens[depth];
+            bool fits = (len + keyLen + 1 < sizeof(path)) && (memchr(key, '\0', keyLen) == NULL);
+            if(fits == true)
+            {
+                memcpy(path + len, key, keyLen);
+                path[len + keyLen] = '\0';
+            }
+
+            const char *value = NULL;
+            char c = buf[doc->pos[i]];
+            if(c == '{')
+            {
+                if(depth + 1 == APARSER_JSON_MAX_DEPTH)
+                {
+                    ArgParserError_set(doc->obj, "Too deep nesting in '%s' at offset %u.", doc->path, doc->pos[i]);
+                    return 1;
+                }
+
+                depth++;
+                lens[depth] = sizeof(path);
+                if(fits == true)
+                {
+                    path[len + keyLen] = '.';
+                    lens[depth] = len + keyLen + 1;
+                }
+
+                i++;
+                isFirst = true;
+                continue;
+            }
+            else if(c == '[')
+            {
+                // Arrays are not option values.
+                i = jsonSkip(doc, i);
+                if(i == 0)
+                    goto truncated;
+            }
+            else if(c == '"')
+            {
+                char *str;
+                size_t strLen;
+                if(jsonString(doc, i, &str, &strLen) != 0)
+                    goto syntax;
+
+                value = str;
+                i++;
+            }
+            else
+            {
+                size_t start = doc->pos[i];
+                size_t end = (i + 1 < doc->num) ? doc->pos[i + 1] : doc->size;
+                while((end > start) && ((buf[end - 1] == ' ') || (buf[end - 1] == '\t') || (buf[end - 1] == '\n') || (buf[end - 1] == '\r')))
+                    end--;
+
+                if(end - start >= sizeof(scalar))
+                    goto syntax;
+                memcpy(scalar, buf + start, end - start);
+                scalar[end - start] = '\0';
+
+                if(strcmp(scalar, "true") == 0)
+                    value = "1";
+                else if(strcmp(scalar, "false") == 0)
+                    value = "0";
+                else if(strcmp(scalar, "null") != 0)
+                {
+                    if((scalar[0] != '-') && ((scalar[0] < '0') || (scalar[0] > '9')))
+                        goto syntax;
+                    value = scalar;
+                }
+
+                i++;
+            }
+
+            if(value != NULL)
+            {
+                int status = (fits == true) ? ArgParserConfig_apply(doc->obj, path, value) : -1;
+                if(status == 1)
+                    return 1;
+
+                if((status == -1) && (doc->obj->ignoreUnknownConfig == false))
+                {
+                    if(fits == true)
+                        ArgParserError_set(doc->obj, "Unknown option '%s' in '%s'.", path + 2, doc->path);
+                    else
+                        ArgParserError_set(doc->obj, "Unknown option '%.*s' in '%s'.", (int) keyLen, key, doc->path);
+                    return 1;
+                }
+            }
+        }
+
+        /* ',' continues the object, and '}' closes it. */
+        while(true)
+        {
+            if(i >= doc->num)
+                goto truncated;
+
+            char c = buf[doc->pos[i]];
+            i++;
+            if(c == ',')
+                break;
+
+            if(c != '}')
+            {
+                i--;
+                goto syntax;
+            }
+
+            if(depth == 0)
+            {
+                if(i != doc->num)
+                    goto syntax;
+                return 0;
+            }
+            depth--;
+        }
+        isFirst = false;
+    }
+
+syntax: /* error handling */
+
+    ArgParserError_set(doc->obj, "Syntax error in '%s' at offset %zu.", doc->path, (i < doc->num) ? (size_t) doc->pos[i] : doc->size);
+    return 1;
+
+truncated: /* error handling */
+
+    ArgParserError_set(doc->obj, "Unexpected end of '%s'.", doc->path);
+    return 1;
+}
+
+
+/**
+ *  @brief Unescape a string in place, and terminate it with a NUL.
+ *         The closing quote is the last quote before the next position.
+ *  @param [in]  doc Document
+ *  @param [in]  i   Index of the opening quote
+ *  @param [out] str String
+ *  @param [out] len String length
+ *  @return Execution status
+ */
+static int jsonString(JsonDoc *doc, size_t i, char **str, size_t *len)
+{
+    char *buf = doc->buf;
+    size_t start = doc->pos[i] + 1;
+    size_t end = (i + 1 < doc->num) ? doc->pos[i + 1] : doc->size;
+
+    while((end > start) && (buf[end - 1] != '"'))
+    {
+        char c = buf[end - 1];
+        if((c != ' ') && (c != '\t') && (c != '\n') && (c != '\r'))
+            return 1;
+        end--;
+    }
+    if(end == start)
+        return 1;
+    end--;  // Closing quote
+
+    size_t r = start;
+    size_t w = start;
+    while(r < end)
+    {
+        unsigned char c = (unsigned char) buf[r++];
+        if(c < 0x20)
+            return 1;
+
+        if(c != '\\')
+        {
+            buf[w++] = (char) c;
+            continue;
+        }
+
+        if(r == end)
+            return 1;
+
+        c = (unsigned char) buf[r++];
+        switch(c)
+        {
+            case '"':  buf[w++] = '"';  break;
+            case '\\': buf[w++] = '\\'; break;
+            case '/':  buf[w++] = '/';  break;
+            case 'b':  buf[w++] = '\b'; break;
+            case 'f':  buf[w++] = '\f'; break;
+            case 'n':  buf[w++] = '\n'; break;
+            case 'r':  buf[w++] = '\r'; break;
+            case 't':  buf[w++] = '\t'; break;
+            case 'u':
+            {
+                uint32_t cp = 0;
+                unsigned int k, n;
+                for(n = 0; n < 2; n++)
+                {
+                    uint32_t unit = 0;
+                    if(end - r < 4)
+                        return 1;
+                    for(k = 0; k < 4; k++)
+                    {
+                        char h = buf[r++];
+                        unit <<= 4;
+                        if((h >= '0') && (h <= '9'))      unit |= (uint32_t) (h - '0');
+                        else if((h >= 'a') && (h <= 'f')) unit |= (uint32_t) (h - 'a' + 10);
+                        else if((h >= 'A') && (h <= 'F')) unit |= (uint32_t) (h - 'A' + 10);
+                        else return 1;
+                    }
+
+                    if(n == 0)
+                    {
+                        cp = unit;
+                        if((cp < 0xD800) || (cp > 0xDBFF))
+                            break;
+
+                        // High surrogate: the low one follows.
+                        if((end - r < 2) || (buf[r] != '\\') || (buf[r + 1] != 'u'))
+                            return 1;
+                        r += 2;
+                    }
+                    else
+                    {
+                        if((unit < 0xDC00) || (unit > 0xDFFF))
+                            return 1;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (unit - 0xDC00);
+                    }
+                }
+
+                if((cp >= 0xDC00) && (cp <= 0xDFFF))
+                    return 1;
+
+                if(cp < 0x80)
+                    buf[w++] = (char) cp;
+                else if(cp < 0x800)
+                {
+                    buf[w++] = (char) (0xC0 | (cp >> 6));
+                    buf[w++] = (char) (0x80 | (cp & 0x3F));
+                }
+                else if(cp < 0x10000)
+                {
+                    buf[w++] = (char) (0xE0 | (cp >> 12));
+                    buf[w++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    buf[w++] = (char) (0x80 | (cp & 0x3F));
+                }
+                else
+                {
+                    buf[w++] = (char) (0xF0 | (cp >> 18));
+                    buf[w++] = (char) (0x80 | ((cp >> 12) & 0x3F));
+                    buf[w++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    buf[w++] = (char) (0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return 1;
+        }
+    }
+
+    // The closing quote (or an earlier byte) takes the NUL; the positions stay intact.
+    buf[w] = '\0';
+    *str = buf + start;
+    *len = w - start;
+    return 0;
+}
+
+
+/**
+ *  @brief Skip an array or an object.
+ *  @param [in] doc Document
+ *  @param [in] i   Index of the opening bracket
+ *  @return Index after the closing bracket, or 0 if the document ends.
+ */
+static size_t jsonSkip(JsonDoc *doc, size_t i)
+{
+    size_t level = 0;
+
+    for(; i < doc->num; i++)
+    {
+        char c = doc->buf[doc->pos[i]];
+        if((c == '[') || (c == '{'))
+            level++;
+        else if((c == ']') || (c == '}'))
+        {
+            level--;
+            if(level == 0)
+                return i + 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,540 @@
+/**
+ *  @file      ArgParser_telemetry.c
+ *  @brief     Argument Parser, option-usage telemetry.
+ *             The parse path pushes the indices of the given parameters into a lock-free
+ *             ring buffer shared by the process. A background thread drains the ring and
+ *             appends the counts to a file. (See ArgParser_local.h for the record format.)
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+/* Macros */
+/**
+ *  @brief Number of entries in the ring buffer. (Power of two)
+ */
+#ifndef APARSER_TELEMETRY_RING
+#define APARSER_TELEMETRY_RING      4096
+#endif
+
+/**
+ *  @brief Maximum number of schemas recorded by a process.
+ */
+#define APARSER_TELEMETRY_SCHEMAS   64
+
+/**
+ *  @brief Flush period of the background thread in milliseconds.
+ */
+#define APARSER_TELEMETRY_PERIOD_MS 200
+
+/**
+ *  @brief Ring entry value marking a parse. (The lower 16 bits are the parameter index otherwise.)
+ */
+#define APARSER_TELEMETRY_PARSE     0xFFFF
+
+
+/* Structs */
+/**
+ *  @brief Ring buffer slot
+ */
+typedef struct TelemetrySlot_
+{
+    _Atomic uint64_t seq;   ///< Position + 1 of the entry, once published
+    uint32_t         val;   ///< Schema index << 16 | parameter index
+} TelemetrySlot;
+
+
+/**
+ *  @brief Schema registered for the telemetry
+ */
+typedef struct TelemetrySchema_
+{
+    uint32_t      id;         ///< Schema ID (hash of the program name and the parameter names)
+    unsigned int  numOptPrms; ///< Number of optional parameters
+    unsigned int  numPosPrms; ///< Number of positional parameters
+    char        **names;      ///< Parameter names (optional ones first)
+    bool          isWritten;  ///< If set, the schema record is in the file.
+    uint32_t      parses;     ///< Parses since the last flush
+    uint32_t      counts[2 * APARSER_MAX_ARG_PRMS]; ///< Uses since the last flush
+} TelemetrySchema;
+
+
+/* Variables */
+static TelemetrySlot    slots[APARSER_TELEMETRY_RING];  ///< Ring buffer
+static _Atomic uint64_t ringHead;                       ///< Next position to reserve (producers)
+static _Atomic uint64_t ringTail;                       ///< Next position to consume (flusher)
+static _Atomic uint32_t numDropped;                     ///< Entries dropped on overflow
+
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER; ///< Guards the schemas, the file and the consumer side.
+static TelemetrySchema  schemas[APARSER_TELEMETRY_SCHEMAS];
+static unsigned int     numSchemas;
+static char            *filePath;
+static int              fileFd = -1;
+static pthread_t        flusher;
+static bool             isStarted;
+static _Atomic bool     isStopping;
+
+
+/* Signatures */
+static int registerSchema(ArgParser *obj);
+static inline void push(uint32_t val);
+static void drain(void);
+static int writeRecords(void);
+static void* flusherMain(void *arg);
+static void stopFlusher(void);
+static void lockForFork(void);
+static void unlockAfterFork(void);
+static void resetAfterFork(void);
+
+
+/* Functions */
+/**
+ *  @brief Enable the option-usage telemetry.
+ *         After each successful parse, the given parameters are counted, and the counts are
+ *         appended to the file by a background thread. The file is shared by the process.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path Output file, or NULL to use $ARGPARSER_TELEMETRY.
+ *  @return Execution status
+ */
+int ArgParser_enableTelemetry(ArgParser *obj, const char *path)
+{
+    if(obj->isShrunk == true)
+    {
+        ArgParserError_set(obj, "The parameter definitions have been released by ArgParser_shrink().");
+        return 1;
+    }
+
+    if(path == NULL)
+        path = getenv("ARGPARSER_TELEMETRY");
+
+    pthread_mutex_lock(&lock);
+
+    if(fileFd >= 0)
+    {
+        // One file per process.
+        if((path != NULL) && (strcmp(path, filePath) != 0))
+        {
+            ArgParserError_set(obj, "The telemetry is already written to '%s'.", filePath);
+            goto error;
+        }
+    }
+    else
+    {
+        if(path == NULL)
+        {
+            ArgParserError_set(obj, "No telemetry file. (Neither the path nor $ARGPARSER_TELEMETRY is given.)");
+            goto error;
+        }
+
+        filePath = strdup(path);
+        fileFd   = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if((filePath == NULL) || (fileFd < 0))
+        {
+            ArgParserError_set(obj, "Cannot open the telemetry file '%s'.", path);
+            goto error;
+        }
+
+        if(pthread_create(&flusher, NULL, flusherMain, NULL) != 0)
+        {
+            ArgParserError_set(obj, "Cannot start the telemetry thread.");
+            goto error;
+        }
+        isStarted = true;
+
+        // Write the remaining entries at exit, and keep a forked child off the entries of the parent.
+        atexit(stopFlusher);
+        pthread_atfork(lockForFork, unlockAfterFork, resetAfterFork);
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    obj->useTelemetry = true;
+    return 0;
+
+error: /* error handling */
+
+    if(isStarted == false)
+    {
+        if(fileFd >= 0)
+            close(fileFd);
+        fileFd = -1;
+
+        free(filePath);
+        filePath = NULL;
+    }
+
+    pthread_mutex_unlock(&lock);
+    return 1;
+}
+
+
+/**
+ *  @brief Write the telemetry collected so far to the file.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_flushTelemetry(ArgParser *obj)
+{
+    int status;
+
+    pthread_mutex_lock(&lock);
+    drain();
+    status = writeRecords();
+    pthread_mutex_unlock(&lock);
+
+    if(status != 0)
+        ArgParserError_set(obj, "Cannot write the telemetry file '%s'.", filePath);
+
+    return status;
+}
+
+
+/**
+ *  @brief Record the parameters given in the last parse.
+ *         A few stores per parameter. Nothing is recorded when the ring is full.
+ *  @param [in] obj ArgParser object
+ */
+void ArgParserTelemetry_record(ArgParser *obj)
+{
+    unsigned int i;
+
+    if((obj->telemetryId == 0) && (registerSchema(obj) != 0))
+        return;
+
+    uint32_t sid = (uint32_t) (obj->telemetryId - 1) << 16;
+    push(sid | APARSER_TELEMETRY_PARSE);
+
+    for(i = 0; i < obj->numOptPrms; i++)
+    {
+        if(obj->optStates[i].isSet == true)
+            push(sid | i);
+    }
+
+    for(i = 0; i < obj->numPosPrms; i++)
+    {
+        if(obj->posStates[i].isSet == true)
+            push(sid | (APARSER_MAX_ARG_PRMS + i));
+    }
+}
+
+
+/**
+ *  @brief Register the schema of an object. The same schema is registered once per process.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+static int registerSchema(ArgParser *obj)
+{
+    TelemetrySchema *schema = NULL;
+    uint32_t id = 0x811c9dc5;
+    unsigned int i, j;
+
+    /* Hash the program name and the parameter names. (FNV-1a) */
+    const char *strs[2 * APARSER_MAX_ARG_PRMS + 1];
+    unsigned int numStrs = 0;
+
+    strs[numStrs++] = obj->progName;
+    for(i = 0; i < obj->numOptPrms; i++)
+        strs[numStrs++] = obj->optPrms[i].name;
+    for(i = 0; i < obj->numPosPrms; i++)
+        strs[numStrs++] = obj->posPrms[i].name;
+
+    for(i = 0; i < numStrs; i++)
+    {
+        for(j = 0; strs[i][j] != '\0'; j++)
+            id = (id ^ (uint8_t) strs[i][j]) * 0x01000193;
+        id = (id ^ 0xFF) * 0x01000193;
+    }
+
+    pthread_mutex_lock(&lock);
+
+    for(i = 0; i < numSchemas; i++)
+    {
+        if(schemas[i].id == id)
+        {
+            schema = &(schemas[i]);
+            break;
+        }
+    }
+
+    if(schema == NULL)
+    {
+        if(numSchemas >= APARSER_TELEMETRY_SCHEMAS)
+            goto error;
+
+        schema = &(schemas[numSchemas]);
+        memset(schema, 0x00, sizeof(TelemetrySchema));
+        schema->id         = id;
+        schema->numOptPrms = obj->numOptPrms;
+        schema->numPosPrms = obj->numPosPrms;
+
+        // The object may be gone before the flush, so the names are copied.
+        schema->names = (char **) calloc(numStrs - 1, sizeof(char *));
+        if(schema->names == NULL)
+            goto error;
+
+        for(i = 1; i < numStrs; i++)
+        {
+            schema->names[i - 1] = strdup(strs[i]);
+            if(schema->names[i - 1] == NULL)
+            {
+                for(j = 1; j < i; j++)
+                    free(schema->names[j - 1]);
+                free(schema->names);
+                goto error;
+            }
+        }
+
+        numSchemas++;
+    }
+
+    obj->telemetryId = (schema - schemas) + 1;
+    pthread_mutex_unlock(&lock);
+    return 0;
+
+error: /* error handling */
+
+    pthread_mutex_unlock(&lock);
+    return 1;
+}
+
+
+/**
+ *  @brief Push an entry into the ring buffer. (Multiple producers)
+ *  @param [in] val Entry value
+ */
+static inline void push(uint32_t val)
+{
+    uint64_t head = atomic_load_explicit(&ringHead, memory_order_relaxed);
+
+    /* Reserve a position, unless the flusher is a whole ring behind. */
+    do
+    {
+        if(head - atomic_load_explicit(&ringTail, memory_order_acquire) >= APARSER_TELEMETRY_RING)
+        {
+            atomic_fetch_add_explicit(&numDropped, 1, memory_order_relaxed);
+            return;
+        }
+    }
+    while(atomic_compare_exchange_weak_explicit(&ringHead, &head, head + 1, memory_order_relaxed, memory_order_relaxed) == false);
+
+    /* Publish the entry. */
+    TelemetrySlot *slot = &(slots[head & (APARSER_TELEMETRY_RING - 1)]);
+    slot->val = val;
+    atomic_store_explicit(&(slot->seq), head + 1, memory_order_release);
+}
+
+
+/**
+ *  @brief Drain the ring buffer into the counters. (Single consumer, under the lock)
+ */
+static void drain(void)
+{
+    uint64_t tail = atomic_load_explicit(&ringTail, memory_order_relaxed);
+
+    while(1)
+    {
+        TelemetrySlot *slot = &(slots[tail & (APARSER_TELEMETRY_RING - 1)]);
+        if(atomic_load_explicit(&(slot->seq), memory_order_acquire) != tail + 1)
+            break; // Not published yet.
+
+        uint32_t val = slot->val;
+        tail++;
+        atomic_store_explicit(&ringTail, tail, memory_order_release);
+
+        TelemetrySchema *schema = &(schemas[val >> 16]);
+        unsigned int idx = val & 0xFFFF;
+        if(idx == APARSER_TELEMETRY_PARSE)
+            schema->parses++;
+        else
+            schema->counts[idx]++;
+    }
+}
+
+
+/**
+ *  @brief Append the counters to the file with a single write, and reset them. (Under the lock)
+ *  @return Execution status
+ */
+static int writeRecords(void)
+{
+    unsigned int i, j;
+    size_t size = 0;
+    size_t cap  = 5; // Dropped record
+    int status  = 0;
+
+    if(fileFd < 0)
+        return 0;
+
+    /* Calculate the maximum chunk size: schema, parses and use records. */
+    for(i = 0; i < numSchemas; i++)
+    {
+        TelemetrySchema *schema = &(schemas[i]);
+        cap += 9 + (schema->numOptPrms + schema->numPosPrms) * 256;
+        cap += 9 + 2 * APARSER_MAX_ARG_PRMS * 11;
+    }
+
+    uint8_t *chunk = (uint8_t *) malloc(cap);
+    if(chunk == NULL)
+        return 1;
+
+    #define PUT(type, value) do { type v_ = (type) (value); memcpy(chunk + size, &v_, sizeof(type)); size += sizeof(type); } while(0)
+
+    for(i = 0; i < numSchemas; i++)
+    {
+        TelemetrySchema *schema = &(schemas[i]);
+        if(schema->parses == 0)
+            continue;
+
+        /* Schema record, once per file. */
+        if(schema->isWritten == false)
+        {
+            unsigned int numNames = schema->numOptPrms + schema->numPosPrms;
+            PUT(uint8_t,  APARSER_TELEMETRY_REC_SCHEMA);
+            PUT(uint32_t, schema->id);
+            PUT(uint16_t, schema->numOptPrms);
+            PUT(uint16_t, schema->numPosPrms);
+            for(j = 0; j < numNames; j++)
+            {
+                size_t len = strlen(schema->names[j]);
+                len = (len > 255) ? 255 : len;
+                PUT(uint8_t, len);
+                memcpy(chunk + size, schema->names[j], len);
+                size += len;
+            }
+            schema->isWritten = true;
+        }
+
+        PUT(uint8_t,  APARSER_TELEMETRY_REC_PARSES);
+        PUT(uint32_t, schema->id);
+        PUT(uint32_t, schema->parses);
+
+        for(j = 0; j < 2 * APARSER_MAX_ARG_PRMS; j++)
+        {
+            if(schema->counts[j] == 0)
+                continue;
+
+            PUT(uint8_t,  APARSER_TELEMETRY_REC_USES);
+            PUT(uint32_t, schema->id);
+            PUT(uint16_t, j);
+            PUT(uint32_t, schema->counts[j]);
+        }
+
+        schema->parses = 0;
+        memset(schema->counts, 0x00, sizeof(schema->counts));
+    }
+
+    uint32_t dropped = atomic_exchange_explicit(&numDropped, 0, memory_order_relaxed);
+    if(dropped != 0)
+    {
+        PUT(uint8_t,  APARSER_TELEMETRY_REC_DROPPED);
+        PUT(uint32_t, dropped);
+    }
+
+    #undef PUT
+
+    /* Append the chunk at once, so that the processes sharing the file don't interleave. */
+    if((size != 0) && (write(fileFd, chunk, size) != (ssize_t) size))
+        status = 1;
+
+    free(chunk);
+    return status;
+}
+
+
+/**
+ *  @brief Background thread which flushes the telemetry periodically.
+ *  @param [in] arg Not used
+ *  @return NULL
+ */
+static void* flusherMain(void *arg)
+{
+    struct timespec period = { 0, APARSER_TELEMETRY_PERIOD_MS * 1000 * 1000 };
+
+    while(atomic_load(&isStopping) == false)
+    {
+        nanosleep(&period, NULL);
+
+        pthread_mutex_lock(&lock);
+        drain();
+        writeRecords();
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+
+/**
+ *  @brief Stop the background thread, and write the remaining entries. (atexit handler)
+ */
+static void stopFlusher(void)
+{
+    // A forked child has no background thread.
+    atomic_store(&isStopping, true);
+    if(isStarted == true)
+        pthread_join(flusher, NULL);
+    isStarted = false;
+
+    pthread_mutex_lock(&lock);
+    drain();
+    writeRecords();
+    close(fileFd);
+    fileFd = -1;
+    pthread_mutex_unlock(&lock);
+}
+
+
+/**
+ *  @brief Take the lock before a fork, so that the child gets the counters in a consistent state. (atfork handler)
+ */
+static void lockForFork(void)
+{
+    pthread_mutex_lock(&lock);
+}
+
+
+/**
+ *  @brief Release the lock in the parent after a fork. (atfork handler)
+ */
+static void unlockAfterFork(void)
+{
+    pthread_mutex_unlock(&lock);
+}
+
+
+/**
+ *  @brief Reset the telemetry in the child after a fork. (atfork handler)
+ *         The entries and the counters collected so far are written by the parent.
+ *         The child has no background thread: its own entries are written at exit,
+ *         or by ArgParser_flushTelemetry().
+ */
+static void resetAfterFork(void)
+{
+    unsigned int i;
+
+    // Positions reserved by the other threads of the parent are never published in the child.
+    atomic_store(&ringTail, atomic_load(&ringHead));
+    atomic_store(&numDropped, 0);
+
+    for(i = 0; i < numSchemas; i++)
+    {
+        schemas[i].parses = 0;
+        memset(schemas[i].counts, 0, sizeof(schemas[i].counts));
+    }
+
+    isStarted = false;
+    pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,221 @@
+/**
+ *  @file      ArgParser_trace.c
+ *  @brief     Argument Parser, parse tracing.
+ *             The parse path records the begin and end times of the classify, lookup and
+ *             convert phases of each token, and of the config files and layers, into a
+ *             preallocated buffer. The buffer is written in the Chrome trace format.
+ *             The hooks exist only in the builds with APARSER_TRACE. (See ArgParser_local.h)
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+
+/* Signatures */
+#if defined(APARSER_TRACE)
+static void writeLabel(FILE *fp, const char *label);
+#endif
+
+
+/* Functions */
+/**
+ *  @brief Enable the parse tracing, or disable it.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] capacity Number of events kept (0: disable)
+ *  @return Execution status
+ */
+int ArgParser_enableTrace(ArgParser *obj, unsigned int capacity)
+{
+#if defined(APARSER_TRACE)
+    free(obj->trace);
+    obj->trace        = NULL;
+    obj->traceLen     = 0;
+    obj->numTrace     = 0;
+    obj->traceDropped = 0;
+    if(capacity == 0)
+        return 0;
+
+    // Allocated and touched here, so that the recording neither allocates nor faults.
+    obj->trace = (TraceEvent *) calloc(capacity, sizeof(TraceEvent));
+    if(obj->trace == NULL)
+    {
+        ArgParserError_set(obj, "Cannot allocate memory.");
+        return 1;
+    }
+
+    obj->traceLen = capacity;
+    return 0;
+#else
+    (void) capacity;
+    ArgParserError_set(obj, "The tracing is not built in. (Build with APARSER_TRACE.)");
+    return 1;
+#endif
+}
+
+
+/**
+ *  @brief Write the recorded events in the Chrome trace format, and clear them.
+ *  @param [in] obj ArgParser object
+ *  @param [in] fp  Output file pointer
+ *  @return Execution status
+ */
+int ArgParser_writeTrace(ArgParser *obj, FILE *fp)
+{
+#if defined(APARSER_TRACE)
+    static const char *phaseNames[TracePhase_Num] =
+    {
+        "classify", "lookup", "convert", "defaults", "providers", "json", "conf.scan", "conf.read", "conf.merge"
+    };
+    unsigned int i;
+
+    if(obj->trace == NULL)
+    {
+        ArgParserError_set(obj, "The tracing is not enabled.");
+        return 1;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[");
+    for(i = 0; i < obj->numTrace; i++)
+    {
+        TraceEvent *ev = &(obj->trace[i]);
+
+        // Microseconds on the CLOCK_MONOTONIC base, the clock of "perf record -k CLOCK_MONOTONIC".
+        fprintf(fp, "%s\n{\"name\":\"%s\",\"cat\":\"argparser\",\"ph\":\"X\",\"ts\":%llu.%03u,\"dur\":%llu.%03u,"
+                    "\"pid\":%d,\"tid\":%u,\"args\":{\"token\":%d,\"label\":",
+                (i == 0) ? "" : ",", phaseNames[ev->phase],
+                (unsigned long long) (ev->begin / 1000), (unsigned int) (ev->begin % 1000),
+                (unsigned long long) ((ev->end - ev->begin) / 1000), (unsigned int) ((ev->end - ev->begin) % 1000),
+                (int) getpid(), ev->tid, ev->token);
+        writeLabel(fp, ev->label);
+        fprintf(fp, "}}");
+    }
+    fprintf(fp, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%u}}\n", obj->traceDropped);
+
+    obj->numTrace     = 0;
+    obj->traceDropped = 0;
+
+    if(ferror(fp) != 0)
+    {
+        ArgParserError_set(obj, "Cannot write the trace.");
+        return 1;
+    }
+    return 0;
+#else
+    (void) fp;
+    ArgParserError_set(obj, "The tracing is not built in. (Build with APARSER_TRACE.)");
+    return 1;
+#endif
+}
+
+
+#if defined(APARSER_TRACE)
+/**
+ *  @brief Get the trace clock.
+ *  @return CLOCK_MONOTONIC time in ns
+ */
+uint64_t ArgParserTrace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+
+/**
+ *  @brief Get the ID of the calling thread. (Cached per thread)
+ *  @return Thread ID
+ */
+uint32_t ArgParserTrace_tid(void)
+{
+    static __thread uint32_t tid;
+    if(tid == 0)
+        tid = (uint32_t) syscall(SYS_gettid);
+    return tid;
+}
+
+
+/**
+ *  @brief Record a trace event of the calling thread, ending now.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] phase Phase
+ *  @param [in] begin Begin time
+ *  @param [in] token Index of the token in argv (-1: none)
+ *  @param [in] label Token or file path (NULL: none)
+ */
+void ArgParserTrace_end(ArgParser *obj, TracePhase phase, uint64_t begin, int token, const char *label)
+{
+    ArgParserTrace_record(obj, phase, ArgParserTrace_tid(), begin, ArgParserTrace_now(), token, label);
+}
+
+
+/**
+ *  @brief Record a trace event.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] phase Phase
+ *  @param [in] tid   Thread ID
+ *  @param [in] begin Begin time
+ *  @param [in] end   End time
+ *  @param [in] token Index of the token in argv (-1: none)
+ *  @param [in] label Token or file path (NULL: none)
+ */
+void ArgParserTrace_record(ArgParser *obj, TracePhase phase, uint32_t tid, uint64_t begin, uint64_t end, int token, const char *label)
+{
+    if(obj->trace == NULL)
+        return;
+
+    if(obj->numTrace == obj->traceLen)
+    {
+        obj->traceDropped++;
+        return;
+    }
+
+    TraceEvent *ev = &(obj->trace[obj->numTrace++]);
+    ev->begin = begin;
+    ev->end   = end;
+    ev->tid   = tid;
+    ev->phase = (uint8_t) phase;
+    ev->token = token;
+
+    // The tokens and paths may be gone by the export.
+    size_t len = 0;
+    if(label != NULL)
+    {
+        len = strnlen(label, APARSER_TRACE_LABEL - 1);
+        memcpy(ev->label, label, len);
+    }
+    ev->label[len] = '\0';
+}
+
+
+/**
+ *  @brief Write a label as a JSON string.
+ *  @param [in] fp    Output file pointer
+ *  @param [in] label Label
+ */
+static void writeLabel(FILE *fp, const char *label)
+{
+    const unsigned char *p;
+
+    fputc('"', fp);
+    for(p = (const unsigned char *) label; *p != '\0'; p++)
+    {
+        if((*p == '"') || (*p == '\\'))
+            fprintf(fp, "\\%c", *p);
+        else if((*p < 0x20) || (*p >= 0x80))
+            fprintf(fp, "\\u%04x", *p);   // Bytes, not UTF-8: a truncated token may end in the middle of a sequence.
+        else
+            fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+#endif
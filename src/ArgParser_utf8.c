@@ -0,0 +1,322 @@
+/**
+ *  @file      ArgParser_utf8.c
+ *  @brief     Argument Parser, UTF-8 validation of string arguments.
+ *             The scanners validate the encoding, screen the control characters, and measure
+ *             the string in a single pass. On x86 with SSSE3 (detected at run time), 16 bytes
+ *             are checked at a time with the lookup tables of Keiser and Lemire; otherwise a
+ *             scalar decoder is used.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define APARSER_UTF8_SSSE3
+#include <tmmintrin.h>
+#endif
+
+
+/* Signatures */
+static size_t scanTextScalar(const char *str, bool allowControl, int *status);
+#if defined(APARSER_UTF8_SSSE3)
+static size_t scanTextSsse3(const char *str, bool allowControl, int *status);
+#endif
+
+
+/* Functions */
+/**
+ *  @brief Select the text scanner for this CPU.
+ *  @return Text scanner
+ */
+TextScanFn ArgParserText_select(void)
+{
+#if defined(APARSER_UTF8_SSSE3)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("ssse3"))
+        return scanTextSsse3;
+#endif
+
+    return scanTextScalar;
+}
+
+
+/**
+ *  @brief Get the scalar text scanner.
+ *  @return Text scanner
+ */
+TextScanFn ArgParserText_scalar(void)
+{
+    return scanTextScalar;
+}
+
+
+/**
+ *  @brief Validate and measure a string, a byte at a time.
+ *  @param [in]  str          String
+ *  @param [in]  allowControl If set, the control characters are accepted.
+ *  @param [out] status       Result (ArgStatus)
+ *  @return String length
+ */
+static size_t scanTextScalar(const char *str, bool allowControl, int *status)
+{
+    const unsigned char *p = (const unsigned char *) str;
+
+    *status = ArgStatus_OK;
+    while(*p != '\0')
+    {
+        unsigned char c = *p;
+        if(c < 0x80)
+        {
+            if(((c < 0x20) || (c == 0x7F)) && (allowControl == false))
+                *status = ArgStatus_Control;
+            p++;
+            continue;
+        }
+
+        /* Lead byte: the number of continuations, and the lowest valid second byte range. */
+        unsigned int n;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if((c >= 0xC2) && (c <= 0xDF))
+            n = 1;
+        else if((c >= 0xE0) && (c <= 0xEF))
+        {
+            n = 2;
+            if(c == 0xE0) lo = 0xA0;    // Overlong
+            if(c == 0xED) hi = 0x9F;    // Surrogates
+        }
+        else if((c >= 0xF0) && (c <= 0xF4))
+        {
+            n = 3;
+            if(c == 0xF0) lo = 0x90;    // Overlong
+            if(c == 0xF4) hi = 0x8F;    // Above U+10FFFF
+        }
+        else
+        {
+            *status = ArgStatus_Utf8;
+            return strlen(str);
+        }
+
+        p++;
+        if((*p < lo) || (*p > hi))
+        {
+            *status = ArgStatus_Utf8;
+            return strlen(str);
+        }
+
+        for(p++, n--; n != 0; p++, n--)
+        {
+            if((*p & 0xC0) != 0x80)
+            {
+                *status = ArgStatus_Utf8;
+                return strlen(str);
+            }
+        }
+    }
+
+    return (size_t) (p - (const unsigned char *) str);
+}
+
+
+#if defined(APARSER_UTF8_SSSE3)
+/**
+ *  @brief Error classes of the byte pairs.
+ *         (Keiser and Lemire, "Validating UTF-8 in less than one instruction per byte")
+ */
+enum
+{
+    Utf8_TooShort = 1 << 0, Utf8_TooLong = 1 << 1, Utf8_Overlong3 = 1 << 2, Utf8_TooLarge = 1 << 3,
+    Utf8_Surrogate = 1 << 4, Utf8_Overlong2 = 1 << 5, Utf8_TooLarge1000 = 1 << 6, Utf8_Overlong4 = 1 << 6,
+    Utf8_TwoConts = 1 << 7, Utf8_Carry = Utf8_TooShort | Utf8_TooLong | Utf8_TwoConts
+};
+
+
+/**
+ *  @brief Check the 16 bytes of a block, continuing the previous one.
+ *  @param [in]     v          Block
+ *  @param [in]     prev       Previous block
+ *  @param [in,out] error      Error bits
+ *  @param [out]    incomplete Nonzero bytes if the block ends in the middle of a sequence
+ */
+__attribute__((target("ssse3"), always_inline))
+static inline void checkUtf8Block(__m128i v, __m128i prev, __m128i *error, __m128i *incomplete)
+{
+    const __m128i byte1High = _mm_setr_epi8(
+        Utf8_TooLong, Utf8_TooLong, Utf8_TooLong, Utf8_TooLong, Utf8_TooLong, Utf8_TooLong, Utf8_TooLong, Utf8_TooLong,
+        (char) Utf8_TwoConts, (char) Utf8_TwoConts, (char) Utf8_TwoConts, (char) Utf8_TwoConts,
+        Utf8_TooShort | Utf8_Overlong2, Utf8_TooShort, Utf8_TooShort | Utf8_Overlong3 | Utf8_Surrogate,
+        Utf8_TooShort | Utf8_TooLarge | Utf8_TooLarge1000 | Utf8_Overlong4);
+    const __m128i byte1Low = _mm_setr_epi8(
+        (char) (Utf8_Carry | Utf8_Overlong3 | Utf8_Overlong2 | Utf8_Overlong4), (char) (Utf8_Carry | Utf8_Overlong2),
+        (char) Utf8_Carry, (char) Utf8_Carry,
+        (char) (Utf8_Carry | Utf8_TooLarge), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000),
+        (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000),
+        (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000),
+        (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000),
+        (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000 | Utf8_Surrogate),
+        (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000), (char) (Utf8_Carry | Utf8_TooLarge | Utf8_TooLarge1000));
+    const __m128i byte2High = _mm_setr_epi8(
+        Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort,
+        (char) (Utf8_TooLong | Utf8_Overlong2 | Utf8_TwoConts | Utf8_Overlong3 | Utf8_TooLarge1000 | Utf8_Overlong4),
+        (char) (Utf8_TooLong | Utf8_Overlong2 | Utf8_TwoConts | Utf8_Overlong3 | Utf8_TooLarge),
+        (char) (Utf8_TooLong | Utf8_Overlong2 | Utf8_TwoConts | Utf8_Surrogate | Utf8_TooLarge),
+        (char) (Utf8_TooLong | Utf8_Overlong2 | Utf8_TwoConts | Utf8_Surrogate | Utf8_TooLarge),
+        Utf8_TooShort, Utf8_TooShort, Utf8_TooShort, Utf8_TooShort);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i incompleteMax = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                (char) (0xF0 - 1), (char) (0xE0 - 1), (char) (0xC0 - 1));
+
+    /* Classify the pairs of the bytes. */
+    __m128i prev1 = _mm_alignr_epi8(v, prev, 15);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                      _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+
+    /* The third and fourth bytes must be continuations, and the only two continuations in a row. */
+    __m128i prev2 = _mm_alignr_epi8(v, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(v, prev, 13);
+    __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xE0 - 0x80))),
+                                  _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xF0 - 0x80))));
+    *error = _mm_or_si128(*error, _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8((char) 0x80)), special));
+    *incomplete = _mm_subs_epu8(v, incompleteMax);
+}
+
+
+/**
+ *  @brief Validate and measure a string, 16 bytes at a time.
+ *         The loads are aligned, so they never cross a page past the terminator; the bytes
+ *         out of the string are cleared to NULs, which are valid ASCII.
+ *  @param [in]  str          String
+ *  @param [in]  allowControl If set, the control characters are accepted.
+ *  @param [out] status       Result (ArgStatus)
+ *  @return String length
+ */
+__attribute__((target("ssse3"), no_sanitize_address))
+static size_t scanTextSsse3(const char *str, bool allowControl, int *status)
+{
+    // 0xFF for the bytes [16, 32): a window of it masks a block.
+    static const uint8_t window[48] =
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    };
+
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i lastCtrl = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t head = (uintptr_t) str & 15;
+    const char *first = str - head;
+    const char *block = first;
+    __m128i prev = zero;
+    __m128i prevIncomplete = zero;
+    __m128i error = zero;
+    unsigned int controls = 0;
+
+    // Clear the bytes before the string in the first block.
+    __m128i keep = _mm_loadu_si128((const __m128i *) (window + 16 - head));
+
+    while(true)
+    {
+        /* 64 bytes at a time, until a terminator (or a control character to report) */
+        if((((uintptr_t) block & 63) == 0) && (block != first))
+        {
+            while(true)
+            {
+                __m128i a = _mm_load_si128((const __m128i *) block);
+                __m128i b = _mm_load_si128((const __m128i *) (block + 16));
+                __m128i c = _mm_load_si128((const __m128i *) (block + 32));
+                __m128i d = _mm_load_si128((const __m128i *) (block + 48));
+
+                // Controls include NUL; the unsigned minimum finds the bytes <= 0x1F.
+                __m128i stop;
+                if(allowControl == false)
+                {
+                    stop = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(a, lastCtrl), a), _mm_cmpeq_epi8(_mm_min_epu8(b, lastCtrl), b)),
+                        _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(c, lastCtrl), c), _mm_cmpeq_epi8(_mm_min_epu8(d, lastCtrl), d)));
+                    stop = _mm_or_si128(stop, _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(a, del), _mm_cmpeq_epi8(b, del)),
+                                                           _mm_or_si128(_mm_cmpeq_epi8(c, del), _mm_cmpeq_epi8(d, del))));
+                }
+                else
+                {
+                    stop = _mm_cmpeq_epi8(_mm_min_epu8(_mm_min_epu8(a, b), _mm_min_epu8(c, d)), zero);
+                }
+                if(_mm_movemask_epi8(stop) != 0)
+                    break;
+
+                if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0)
+                {
+                    // ASCII: only a sequence left open by the previous block is an error.
+                    error = _mm_or_si128(error, prevIncomplete);
+                    prevIncomplete = zero;
+                }
+                else
+                {
+                    checkUtf8Block(a, prev, &error, &prevIncomplete);
+                    checkUtf8Block(b, a, &error, &prevIncomplete);
+                    checkUtf8Block(c, b, &error, &prevIncomplete);
+                    checkUtf8Block(d, c, &error, &prevIncomplete);
+                }
+
+                prev  = d;
+                block += 64;
+            }
+        }
+
+        /* A block at a time around the ends */
+        __m128i raw = _mm_load_si128((const __m128i *) block);
+        unsigned int nuls = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(raw, zero)) & (unsigned int) _mm_movemask_epi8(keep);
+        bool isLast = (nuls != 0);
+        if(isLast == true)
+        {
+            // Clear the bytes from the terminator.
+            unsigned int end = (unsigned int) __builtin_ctz(nuls);
+            keep = _mm_and_si128(keep, _mm_loadu_si128((const __m128i *) (window + 32 - end)));
+        }
+        __m128i v = _mm_and_si128(raw, keep);
+
+        if(allowControl == false)
+        {
+            __m128i ctrl = _mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del));
+            controls |= (unsigned int) _mm_movemask_epi8(_mm_andnot_si128(_mm_cmpeq_epi8(v, zero), ctrl)) &
+                        ~(unsigned int) _mm_movemask_epi8(v);
+        }
+
+        if(_mm_movemask_epi8(v) == 0)
+        {
+            error = _mm_or_si128(error, prevIncomplete);
+            prevIncomplete = zero;
+        }
+        else
+        {
+            checkUtf8Block(v, prev, &error, &prevIncomplete);
+        }
+
+        if(isLast == true)
+        {
+            size_t len = (size_t) (block + __builtin_ctz(nuls) - str);
+            error = _mm_or_si128(error, prevIncomplete);
+
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+                *status = ArgStatus_Utf8;
+            else
+                *status = (controls != 0) ? ArgStatus_Control : ArgStatus_OK;
+            return len;
+        }
+
+        prev  = v;
+        block += 16;
+        keep  = _mm_set1_epi8((char) 0xFF);
+    }
+}
+#endif
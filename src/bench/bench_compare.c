@@ -0,0 +1,486 @@
+/**
+ *  @file      bench_compare.c
+ *  @brief     Comparative benchmark against getopt_long() and argp.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <argp.h>
+#include <malloc.h>
+#include "ArgParser.h"
+#include "bench.h"
+
+/* Macros */
+/**
+ *  @brief Maximum number of options in a schema.
+ *         (The help and version options are registered by ArgParser.)
+ */
+#define MAX_OPTIONS      30
+
+/**
+ *  @brief Maximum string value length.
+ */
+#define MAX_STRING_LEN   32
+
+/**
+ *  @brief Parse time budget per measurement in nanoseconds.
+ */
+#define TIME_BUDGET_NS   (200 * 1000 * 1000)
+
+
+/* Enums */
+/**
+ *  @brief Option kind, determined by the option index.
+ */
+typedef enum OptKind_
+{
+    OptKind_Int    = 0, ///< int option
+    OptKind_Double = 1, ///< double option
+    OptKind_String = 2, ///< string option
+    OptKind_Switch = 3, ///< switch option (no value)
+    OptKind_Num    = 4  ///< Number of kinds
+
+} OptKind;
+
+
+/* Structs */
+/**
+ *  @brief Command line corpus.
+ */
+typedef struct Corpus_
+{
+    const char *name;   ///< Corpus name
+    int numOpts;        ///< Number of options in the schema
+    int numTokens;      ///< Number of option occurrences in the command line
+} Corpus;
+
+
+/**
+ *  @brief Parser under test.
+ */
+typedef struct Parser_
+{
+    const char *name;                        ///< Parser name
+    int  (*setup)(int numOpts);              ///< Build the schema
+    int  (*parse)(int argc, char **argv);    ///< Parse a command line
+    void (*teardown)(void);                  ///< Release the schema
+} Parser;
+
+
+/**
+ *  @brief Destinations.
+ */
+typedef struct Config_
+{
+    int    ints[MAX_OPTIONS];
+    double doubles[MAX_OPTIONS];
+    char   strings[MAX_OPTIONS][MAX_STRING_LEN];
+    bool   switches[MAX_OPTIONS];
+} Config;
+
+
+/* Signatures */
+static int setupArgParser(int numOpts);
+static int parseArgParser(int argc, char **argv);
+static void teardownArgParser(void);
+static int setupGetopt(int numOpts);
+static int parseGetopt(int argc, char **argv);
+static void teardownGetopt(void);
+static int setupArgp(int numOpts);
+static int parseArgp(int argc, char **argv);
+static void teardownArgp(void);
+static error_t argpParser(int key, char *arg, struct argp_state *state);
+static int convert(int idx, const char *arg);
+static size_t heapInUse(void);
+
+
+/* Variables */
+static const Corpus corpora[] =
+{
+    { "small",    4,     6 }, // A tiny tool
+    { "typical", 16,    24 }, // A typical service
+    { "huge",    30, 20000 }, // Generated command line with many repeats
+};
+
+static const Parser parsers[] =
+{
+    { "ArgParser",   setupArgParser, parseArgParser, teardownArgParser },
+    { "getopt_long", setupGetopt,    parseGetopt,    teardownGetopt    },
+    { "argp",        setupArgp,      parseArgp,      teardownArgp      },
+};
+
+static Config config;
+static char shortNames[MAX_OPTIONS][4];      // "-a"
+static char longNames[MAX_OPTIONS][16];      // "--option-0"
+static int  charToIdx[256];
+
+static ArgParser *aparser = NULL;
+static struct option *getoptLongOpts = NULL;
+static char getoptShortOpts[3 * MAX_OPTIONS + 3];
+static struct argp_option *argpOpts = NULL;
+static int numOptions = 0;
+
+
+/* Functions */
+/**
+ *  @brief Run the comparative benchmark.
+ *         Usage: compare [csv|json]
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+int Bench_compare(int argc, char **argv)
+{
+    unsigned int numCorpora = sizeof(corpora) / sizeof(corpora[0]);
+    unsigned int numParsers = sizeof(parsers) / sizeof(parsers[0]);
+    bool json = (argc >= 2) && (strcmp(argv[1], "json") == 0);
+    bool first = true;
+    unsigned int c, p;
+    int i;
+
+    for(i = 0; i < MAX_OPTIONS; i++)
+    {
+        // '-h' and '-v' are taken by ArgParser.
+        char ch = "abcdefgijklmnopqrstuwxyzABCDEFGHIJ"[i];
+        snprintf(shortNames[i], sizeof(shortNames[i]), "-%c", ch);
+        snprintf(longNames[i], sizeof(longNames[i]), "--option-%d", i);
+        charToIdx[(unsigned char) ch] = i;
+    }
+
+    if(json == true)
+        printf("[\n");
+    else
+        printf("corpus,parser,options,args,startup_ns,parse_ns,ns_per_arg,heap_bytes\n");
+
+    for(c = 0; c < numCorpora; c++)
+    {
+        const Corpus *corpus = &corpora[c];
+
+        /* Build the command line. Long and short spellings are mixed. */
+        int maxArgs = 1 + 2 * corpus->numTokens;
+        char **args = (char **) malloc(sizeof(char *) * (maxArgs + 1));
+        if(args == NULL)
+            return 1;
+
+        int numArgs = 0;
+        srand(c);
+        args[numArgs++] = "bench";
+        for(i = 0; i < corpus->numTokens; i++)
+        {
+            int idx = rand() % corpus->numOpts;
+            args[numArgs++] = (rand() % 2) ? longNames[idx] : shortNames[idx];
+
+            static char *values[OptKind_Num] = { "12345", "3.25", "some_text", NULL };
+            if(values[idx % OptKind_Num] != NULL)
+                args[numArgs++] = values[idx % OptKind_Num];
+        }
+        args[numArgs] = NULL;
+
+        for(p = 0; p < numParsers; p++)
+        {
+            const Parser *parser = &parsers[p];
+            uint64_t start, elapsed;
+            int n;
+
+            /* Startup: building and releasing the schema. */
+            int numStartups = 1000;
+            start = Bench_now();
+            for(n = 0; n < numStartups; n++)
+            {
+                if(parser->setup(corpus->numOpts) != 0)
+                    return 1;
+                parser->teardown();
+            }
+            double startupNs = (double) (Bench_now() - start) / numStartups;
+
+            /* Memory: heap in use with the schema built and a command line parsed. */
+            size_t heapBase = heapInUse();
+            if(parser->setup(corpus->numOpts) != 0)
+                return 1;
+
+            if(parser->parse(numArgs, args) != 0)
+            {
+                fprintf(stderr, "Error: %s failed to parse the '%s' corpus.\n", parser->name, corpus->name);
+                return 1;
+            }
+            size_t heapBytes = heapInUse() - heapBase;
+
+            /* Parse: repeated until the time budget is spent. */
+            int numParses = 0;
+            start = Bench_now();
+            do
+            {
+                for(n = 0; n < 16; n++)
+                    parser->parse(numArgs, args);
+                numParses += n;
+                elapsed = Bench_now() - start;
+            } while(elapsed < TIME_BUDGET_NS);
+            parser->teardown();
+
+            double parseNs = (double) elapsed / numParses;
+            if(json == true)
+            {
+                printf("%s  {\"corpus\": \"%s\", \"parser\": \"%s\", \"options\": %d, \"args\": %d, "
+                       "\"startup_ns\": %.1f, \"parse_ns\": %.1f, \"ns_per_arg\": %.2f, \"heap_bytes\": %zu}",
+                        (first == true) ? "" : ",\n", corpus->name, parser->name, corpus->numOpts, numArgs - 1,
+                        startupNs, parseNs, parseNs / (numArgs - 1), heapBytes);
+            }
+            else
+            {
+                printf("%s,%s,%d,%d,%.1f,%.1f,%.2f,%zu\n",
+                        corpus->name, parser->name, corpus->numOpts, numArgs - 1,
+                        startupNs, parseNs, parseNs / (numArgs - 1), heapBytes);
+            }
+            first = false;
+        }
+
+        free(args);
+    }
+
+    if(json == true)
+        printf("\n]\n");
+
+    return 0;
+}
+
+
+/**
+ *  @brief Build the ArgParser schema.
+ *  @param [in] numOpts Number of options
+ *  @return Execution status
+ */
+static int setupArgParser(int numOpts)
+{
+    int status = 0;
+    int i;
+
+    aparser = ArgParser_new("bench", "Comparative benchmark.");
+    if(aparser == NULL)
+        return 1;
+
+    for(i = 0; i < numOpts; i++)
+    {
+        switch(i % OptKind_Num)
+        {
+            case OptKind_Int:
+                status |= ArgParser_addInt(aparser, &config.ints[i], 0, shortNames[i], longNames[i], "int", "");
+                break;
+            case OptKind_Double:
+                status |= ArgParser_addDouble(aparser, &config.doubles[i], 0, shortNames[i], longNames[i], "double", "");
+                break;
+            case OptKind_String:
+                status |= ArgParser_addString(aparser, config.strings[i], "", MAX_STRING_LEN, shortNames[i], longNames[i], "string", "");
+                break;
+            default:
+                status |= ArgParser_addTrue(aparser, &config.switches[i], shortNames[i], longNames[i], "switch", "");
+                break;
+        }
+    }
+
+    status |= ArgParser_freeze(aparser);
+    return status;
+}
+
+
+/**
+ *  @brief Parse with ArgParser.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+static int parseArgParser(int argc, char **argv)
+{
+    return ArgParser_parse(aparser, argc, argv);
+}
+
+
+/**
+ *  @brief Release the ArgParser schema.
+ */
+static void teardownArgParser(void)
+{
+    ArgParser_delete(aparser);
+    aparser = NULL;
+}
+
+
+/**
+ *  @brief Build the getopt_long() schema.
+ *  @param [in] numOpts Number of options
+ *  @return Execution status
+ */
+static int setupGetopt(int numOpts)
+{
+    int len = 0;
+    int i;
+
+    getoptLongOpts = (struct option *) calloc(numOpts + 1, sizeof(struct option));
+    if(getoptLongOpts == NULL)
+        return 1;
+
+    getoptShortOpts[len++] = '+'; // Don't permute argv.
+    getoptShortOpts[len++] = ':'; // Don't print errors.
+    for(i = 0; i < numOpts; i++)
+    {
+        bool hasArg = (i % OptKind_Num) != OptKind_Switch;
+        getoptLongOpts[i].name    = &longNames[i][2];
+        getoptLongOpts[i].has_arg = hasArg ? required_argument : no_argument;
+        getoptLongOpts[i].flag    = NULL;
+        getoptLongOpts[i].val     = shortNames[i][1];
+
+        getoptShortOpts[len++] = shortNames[i][1];
+        if(hasArg)
+            getoptShortOpts[len++] = ':';
+    }
+    getoptShortOpts[len] = '\0';
+    numOptions = numOpts;
+
+    return 0;
+}
+
+
+/**
+ *  @brief Parse with getopt_long().
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+static int parseGetopt(int argc, char **argv)
+{
+    int ch;
+
+    optind = 0; // Full reinitialization (glibc).
+    while((ch = getopt_long(argc, argv, getoptShortOpts, getoptLongOpts, NULL)) != -1)
+    {
+        if((ch == '?') || (ch == ':'))
+            return 1;
+
+        if(convert(charToIdx[(unsigned char) ch], optarg) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  @brief Release the getopt_long() schema.
+ */
+static void teardownGetopt(void)
+{
+    free(getoptLongOpts);
+    getoptLongOpts = NULL;
+}
+
+
+/**
+ *  @brief Build the argp schema.
+ *  @param [in] numOpts Number of options
+ *  @return Execution status
+ */
+static int setupArgp(int numOpts)
+{
+    int i;
+
+    argpOpts = (struct argp_option *) calloc(numOpts + 1, sizeof(struct argp_option));
+    if(argpOpts == NULL)
+        return 1;
+
+    for(i = 0; i < numOpts; i++)
+    {
+        argpOpts[i].name = &longNames[i][2];
+        argpOpts[i].key  = shortNames[i][1];
+        argpOpts[i].arg  = ((i % OptKind_Num) != OptKind_Switch) ? "VALUE" : NULL;
+        argpOpts[i].doc  = "";
+    }
+    numOptions = numOpts;
+
+    return 0;
+}
+
+
+/**
+ *  @brief Parse with argp.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+static int parseArgp(int argc, char **argv)
+{
+    struct argp argp = { argpOpts, argpParser, NULL, NULL, NULL, NULL, NULL };
+    return (argp_parse(&argp, argc, argv, ARGP_SILENT | ARGP_IN_ORDER, NULL, NULL) != 0) ? 1 : 0;
+}
+
+
+/**
+ *  @brief argp option handler.
+ *  @param [in] key   Option key
+ *  @param [in] arg   Option argument
+ *  @param [in] state Parser state
+ *  @return Error code
+ */
+static error_t argpParser(int key, char *arg, struct argp_state *state)
+{
+    if((key < 0) || (key > 0xff) || (strchr(getoptShortOpts + 2, key) == NULL))
+        return ARGP_ERR_UNKNOWN;
+
+    return (convert(charToIdx[key], arg) == 0) ? 0 : EINVAL;
+}
+
+
+/**
+ *  @brief Release the argp schema.
+ */
+static void teardownArgp(void)
+{
+    free(argpOpts);
+    argpOpts = NULL;
+}
+
+
+/**
+ *  @brief Convert an option value as ArgParser does.
+ *  @param [in] idx Option index
+ *  @param [in] arg Option argument
+ *  @return Execution status
+ */
+static int convert(int idx, const char *arg)
+{
+    char *errPtr = NULL;
+    switch(idx % OptKind_Num)
+    {
+        case OptKind_Int:
+            config.ints[idx] = strtol(arg, &errPtr, 0);
+            return (*errPtr != '\0') ? 1 : 0;
+
+        case OptKind_Double:
+            config.doubles[idx] = strtod(arg, &errPtr);
+            return (*errPtr != '\0') ? 1 : 0;
+
+        case OptKind_String:
+            snprintf(config.strings[idx], MAX_STRING_LEN, "%s", arg);
+            return 0;
+
+        default:
+            config.switches[idx] = true;
+            return 0;
+    }
+}
+
+
+/**
+ *  @brief Get the heap size in use.
+ *  @return Allocated bytes
+ */
+static size_t heapInUse(void)
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
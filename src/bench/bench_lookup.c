@@ -0,0 +1,156 @@
+/**
+ *  @file      bench_lookup.c
+ *  @brief     Benchmark of the option lookup strategies.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ArgParser.h"
+#include "bench.h"
+
+/* Macros */
+/**
+ *  @brief Maximum number of user options in a schema.
+ *         (The help and version options are registered by the parser.)
+ */
+#define MAX_OPTIONS      30
+
+/**
+ *  @brief Number of option/value pairs in a command line.
+ */
+#define NUM_PAIRS        256
+
+/**
+ *  @brief Number of parse iterations per measurement.
+ */
+#define NUM_ITERATIONS   2000
+
+/**
+ *  @brief Number of measurements per data point. The fastest one is reported.
+ */
+#define NUM_TRIALS       5
+
+
+/* Signatures */
+static double measure(int numOpts, unsigned int threshold, int argc, char **argv);
+
+
+/* Functions */
+/**
+ *  @brief Run the lookup strategy benchmark.
+ *         Prints the cost per option token of each strategy and the crossover point.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+int Bench_lookup(int argc, char **argv)
+{
+    static char names[MAX_OPTIONS][2][32];
+    static char *args[1 + 2 * NUM_PAIRS];
+    int crossover = -1;
+    int n, i;
+
+    for(n = 0; n < MAX_OPTIONS; n++)
+    {
+        snprintf(names[n][0], sizeof(names[n][0]), "-o%d", n);
+        snprintf(names[n][1], sizeof(names[n][1]), "--option-%d", n);
+    }
+
+    printf("options,spellings,linear_ns_per_token,hash_ns_per_token\n");
+    for(n = 1; n <= MAX_OPTIONS; n++)
+    {
+        /* Build a command line which uses all options evenly. */
+        srand(n);
+        args[0] = "bench";
+        for(i = 0; i < NUM_PAIRS; i++)
+        {
+            args[1 + 2 * i]     = names[rand() % n][rand() % 2];
+            args[1 + 2 * i + 1] = "12345";
+        }
+
+        double linear = -1;
+        double hash   = -1;
+        int t;
+        for(t = 0; t < NUM_TRIALS; t++)
+        {
+            double l = measure(n, (unsigned int) -1, 1 + 2 * NUM_PAIRS, args);
+            double h = measure(n, 0, 1 + 2 * NUM_PAIRS, args);
+            if((l < 0) || (h < 0))
+                return 1;
+
+            linear = ((linear < 0) || (l < linear)) ? l : linear;
+            hash   = ((hash   < 0) || (h < hash))   ? h : hash;
+        }
+
+        // The crossover is where the hash table starts to win for good.
+        if(hash >= linear)
+            crossover = -1;
+        else if(crossover < 0)
+            crossover = n;
+
+        printf("%d,%d,%.2f,%.2f\n", n, 2 * (n + 2), linear, hash);
+    }
+
+    if(crossover < 0)
+        printf("# crossover: none (linear scan wins up to %d options)\n", MAX_OPTIONS);
+    else
+        printf("# crossover: %d options (%d spellings incl. help/version)\n", crossover, 2 * (crossover + 2));
+
+    return 0;
+}
+
+
+/**
+ *  @brief Measure the parse time per option token.
+ *  @param [in] numOpts   Number of user options
+ *  @param [in] threshold Lookup threshold
+ *  @param [in] argc      Number of command line arguments
+ *  @param [in] argv[]    Command line argument array
+ *  @return Nanoseconds per option token, or negative value on error.
+ */
+static double measure(int numOpts, unsigned int threshold, int argc, char **argv)
+{
+    static int dest[MAX_OPTIONS];
+    char optNames[2][32];
+    int i;
+
+    ArgParser *aparser = ArgParser_new("bench", "Lookup benchmark.");
+    if(aparser == NULL)
+        return -1;
+
+    for(i = 0; i < numOpts; i++)
+    {
+        snprintf(optNames[0], sizeof(optNames[0]), "-o%d", i);
+        snprintf(optNames[1], sizeof(optNames[1]), "--option-%d", i);
+        if(ArgParser_addInt(aparser, &dest[i], 0, optNames[0], optNames[1], "option", "") != 0)
+            goto error;
+    }
+
+    if(ArgParser_setLookupThreshold(aparser, threshold) != 0)
+        goto error;
+
+    if(ArgParser_freeze(aparser) != 0)
+        goto error;
+
+    uint64_t start = Bench_now();
+    for(i = 0; i < NUM_ITERATIONS; i++)
+    {
+        if(ArgParser_parse(aparser, argc, argv) != 0)
+            goto error;
+    }
+    uint64_t elapsed = Bench_now() - start;
+
+    ArgParser_delete(aparser);
+    return (double) elapsed / ((double) NUM_ITERATIONS * (argc - 1) / 2);
+
+error: /* error handling */
+
+    fprintf(stderr, "Error: %s\n", ArgParser_getErrorMsg(aparser));
+    ArgParser_delete(aparser);
+    return -1;
+}
+
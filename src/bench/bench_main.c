@@ -0,0 +1,76 @@
+/**
+ *  @file      bench_main.c
+ *  @brief     Benchmark main function.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+/* Structs */
+/**
+ *  @brief Benchmark definition
+ */
+typedef struct BenchDef_
+{
+    const char *name;                     ///< Benchmark name
+    const char *desc;                     ///< Benchmark description
+    int (*run)(int argc, char **argv);    ///< Benchmark function
+} BenchDef;
+
+
+/* Variables */
+static const BenchDef benchDefs[] =
+{
+    { "lookup",  "Linear scan vs. hash table lookup, by schema size.",                   Bench_lookup  },
+    { "compare", "ArgParser vs. getopt_long() and argp, in CSV (or 'compare json').", Bench_compare },
+};
+
+
+/* Functions */
+/**
+ *  @brief Get current time.
+ *  @return Monotonic time in nanoseconds
+ */
+uint64_t Bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+
+/**
+ *  @brief Main function
+ *  @param [in] argc     Number of command line arguments
+ *  @param [in] argv[]   Command line argument array
+ *  @return   Execution status
+ */
+int main(int argc, char *argv[])
+{
+    unsigned int numDefs = sizeof(benchDefs) / sizeof(benchDefs[0]);
+    unsigned int i;
+
+    if(argc >= 2)
+    {
+        for(i = 0; i < numDefs; i++)
+        {
+            if(strcmp(argv[1], benchDefs[i].name) == 0)
+                return benchDefs[i].run(argc - 1, argv + 1);
+        }
+    }
+
+    fprintf(stderr, "Usage: %s <benchmark> [args ...]\n", argv[0]);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Benchmarks:\n");
+    for(i = 0; i < numDefs; i++)
+        fprintf(stderr, "    %-10s : %s\n", benchDefs[i].name, benchDefs[i].desc);
+
+    return 1;
+}
+
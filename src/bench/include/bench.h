@@ -0,0 +1,40 @@
+/**
+ *  @file      bench.h
+ *  @brief     Benchmark programs.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#ifndef SRC_BENCH_BENCH_H_
+#define SRC_BENCH_BENCH_H_
+
+#include <stdint.h>
+
+/* Signatures */
+/**
+ *  @brief Get current time.
+ *  @return Monotonic time in nanoseconds
+ */
+uint64_t Bench_now(void);
+
+/**
+ *  @brief Run the lookup strategy benchmark.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+int Bench_lookup(int argc, char **argv);
+
+/**
+ *  @brief Run the comparative benchmark against getopt_long() and argp.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Execution status
+ */
+int Bench_compare(int argc, char **argv);
+
+
+#endif // SRC_BENCH_BENCH_H_
+
@@ -0,0 +1,401 @@
+/**
+ *  @file      ArgParser_fuzz.c
+ *  @brief     Fuzzing harness with a per-input time and memory budget.
+ *             Built with -DAPARSER_LIBFUZZER, this file is a libFuzzer target.
+ *             Otherwise it is a standalone driver which runs the files and directories
+ *             given on the command line (e.g. the regression corpus), or stdin for AFL.
+ *             With $ARGPARSER_FUZZ_MODE=json, an input is a JSON config file instead of
+ *             a command line, loaded with ArgParser_loadJson().
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "ArgParser.h"
+
+/* Macros */
+/**
+ *  @brief Fixed time budget per input in nanoseconds.
+ */
+#define FUZZ_BASE_NS        (20 * 1000 * 1000)
+
+/**
+ *  @brief Default time budget per input byte in nanoseconds.
+ *         Overridden by $ARGPARSER_FUZZ_NS_PER_BYTE.
+ */
+#define FUZZ_NS_PER_BYTE    2000
+
+/**
+ *  @brief Default budget of the peak memory growth in KiB.
+ *         Overridden by $ARGPARSER_FUZZ_RSS_KB.
+ */
+#define FUZZ_RSS_KB         (64 * 1024)
+
+/**
+ *  @brief Maximum number of command line arguments built from an input.
+ */
+#define FUZZ_MAX_ARGS       4096
+
+/**
+ *  @brief Size of the string destination.
+ *         Large enough to expose costs which depend on the buffer size.
+ */
+#define FUZZ_STRING_BUF     (1 << 20)
+
+
+/* Structs */
+/**
+ *  @brief Destinations of the fuzzed schema.
+ */
+typedef struct FuzzConfig_
+{
+    int intParam;
+    unsigned int uintParam;
+    char stringParam[FUZZ_STRING_BUF];
+    bool boolParam;
+    int32_t int32Param;
+    uint32_t uint32Param;
+    float floatParam;
+    double doubleParam;
+    bool swParam;
+    unsigned int actionCount;
+    int posParam;
+    char posString[64];
+    int dbPort;
+    char dbHost[64];
+} FuzzConfig;
+
+
+/* Variables */
+static ArgParser *aparser = NULL;
+static FuzzConfig config;
+static uint64_t nsPerByte = FUZZ_NS_PER_BYTE;
+static long rssBudgetKB = FUZZ_RSS_KB;
+static long rssBaseKB = 0;
+static bool isJson = false;
+static char jsonPath[] = "/tmp/arg_parser_fuzz_XXXXXX";
+static int jsonFd = -1;
+
+
+/* Signatures */
+static int initialize(void);
+static int runInput(const uint8_t *data, size_t size);
+static int runArgs(const uint8_t *data, size_t size);
+static int runJson(const uint8_t *data, size_t size);
+static int countAction(ArgParser *obj, const char *arg, void *ctx);
+static uint64_t now(void);
+static long peakRssKB(void);
+
+
+/* Functions */
+/**
+ *  @brief Create the fuzzed parser and read the budgets.
+ *  @return Execution status
+ */
+static int initialize(void)
+{
+    int status = 0;
+    const char *env;
+
+    if(aparser != NULL)
+        return 0;
+
+    env = getenv("ARGPARSER_FUZZ_NS_PER_BYTE");
+    if(env != NULL)
+        nsPerByte = strtoull(env, NULL, 0);
+
+    env = getenv("ARGPARSER_FUZZ_RSS_KB");
+    if(env != NULL)
+        rssBudgetKB = strtol(env, NULL, 0);
+
+    // The JSON inputs are written to a file, as the loader maps its file.
+    env = getenv("ARGPARSER_FUZZ_MODE");
+    if((env != NULL) && (strcmp(env, "json") == 0))
+    {
+        isJson = true;
+        jsonFd = mkstemp(jsonPath);
+        if(jsonFd < 0)
+        {
+            fprintf(stderr, "Error: Cannot create '%s'.\n", jsonPath);
+            return 1;
+        }
+        unlink(jsonPath);
+        snprintf(jsonPath, sizeof(jsonPath), "/proc/self/fd/%d", jsonFd);
+    }
+
+    aparser = ArgParser_new("fuzz", "Fuzzing target.");
+    if(aparser == NULL)
+        return 1;
+
+    status |= ArgParser_addInt(aparser, &config.intParam, 1, "-i", "--int", "int", "int");
+    status |= ArgParser_addUInt(aparser, &config.uintParam, 2, "-u", "--uint", "uint", "uint");
+    status |= ArgParser_addString(aparser, config.stringParam, "default", FUZZ_STRING_BUF, "-s", "--string", "string", "string");
+    status |= ArgParser_addBool(aparser, &config.boolParam, false, "-b", "--bool", "bool", "bool");
+    status |= ArgParser_addInt32(aparser, &config.int32Param, 3, "", "--int32", "int32", "int32");
+    status |= ArgParser_addUInt32(aparser, &config.uint32Param, 4, "", "--uint32", "uint32", "uint32");
+    status |= ArgParser_addFloat(aparser, &config.floatParam, 5.0, "-f", "--float", "float", "float");
+    status |= ArgParser_addDouble(aparser, &config.doubleParam, 6.0, "-d", "--double", "double", "double");
+    status |= ArgParser_addTrue(aparser, &config.swParam, "-w", "--switch", "switch", "switch");
+    status |= ArgParser_addAction(aparser, countAction, NULL, "-a", "--action", "action", "action");
+    status |= ArgParser_setExitOnHelp(aparser, false); // The help/version options only stop the parse.
+    status |= ArgParser_addInt(aparser, &config.posParam, 7, NULL, NULL, "pos_int", "positional int");
+    status |= ArgParser_addString(aparser, config.posString, "", sizeof(config.posString), NULL, NULL, "pos_string", "positional string");
+    status |= ArgParser_addInt(aparser, &config.dbPort, 8, "", "--db.port", "db.port", "nested int");
+    status |= ArgParser_addString(aparser, config.dbHost, "", sizeof(config.dbHost), "", "--db.host", "db.host", "nested string");
+    status |= ArgParser_setIgnoreUnknownConfig(aparser, isJson); // Lets the loader walk past the unknown keys.
+    if(status != 0)
+    {
+        fprintf(stderr, "Error: %s\n", ArgParser_getErrorMsg(aparser));
+        return 1;
+    }
+
+    rssBaseKB = peakRssKB();
+    return 0;
+}
+
+
+/**
+ *  @brief Parse one input and check the budgets. Aborts if exceeded.
+ *  @param [in] data Input data
+ *  @param [in] size Input size
+ *  @return Parse status
+ */
+static int runInput(const uint8_t *data, size_t size)
+{
+    uint64_t start = now();
+    int status = (isJson == true) ? runJson(data, size) : runArgs(data, size);
+    uint64_t elapsed = now() - start;
+
+    uint64_t budget = FUZZ_BASE_NS + nsPerByte * size;
+    if(elapsed > budget)
+    {
+        fprintf(stderr, "Error: Too slow: %zu bytes took %llu ns (budget %llu ns).\n",
+                size, (unsigned long long) elapsed, (unsigned long long) budget);
+        abort();
+    }
+
+    long growth = peakRssKB() - rssBaseKB;
+    if(growth > rssBudgetKB)
+    {
+        fprintf(stderr, "Error: Too much memory: peak grew by %ld KiB (budget %ld KiB).\n", growth, rssBudgetKB);
+        abort();
+    }
+
+    return status;
+}
+
+
+/**
+ *  @brief Parse an input as a command line.
+ *         The input is split on NULs into command line arguments,
+ *         like /proc/self/cmdline.
+ *  @param [in] data Input data
+ *  @param [in] size Input size
+ *  @return Parse status
+ */
+static int runArgs(const uint8_t *data, size_t size)
+{
+    static char *args[FUZZ_MAX_ARGS + 1];
+    int argc = 0;
+    size_t i;
+
+    char *buf = (char *) malloc(size + 1);
+    if(buf == NULL)
+        return 1;
+    memcpy(buf, data, size);
+    buf[size] = '\0';
+
+    args[argc++] = "fuzz";
+    for(i = 0; (i < size) && (argc < FUZZ_MAX_ARGS); i += strlen(&buf[i]) + 1)
+        args[argc++] = &buf[i];
+    args[argc] = NULL;
+
+    int status = ArgParser_parse(aparser, argc, args);
+    free(buf);
+    return status;
+}
+
+
+/**
+ *  @brief Load an input as a JSON config file, then parse an empty command line
+ *         to apply the loaded defaults.
+ *  @param [in] data Input data
+ *  @param [in] size Input size
+ *  @return Load/parse status
+ */
+static int runJson(const uint8_t *data, size_t size)
+{
+    static char *args[] = { "fuzz", NULL };
+
+    if((ftruncate(jsonFd, 0) != 0) || (pwrite(jsonFd, data, size, 0) != (ssize_t) size))
+    {
+        fprintf(stderr, "Error: Cannot write '%s'.\n", jsonPath);
+        abort();
+    }
+
+    int status = ArgParser_loadJson(aparser, jsonPath);
+    status |= ArgParser_parse(aparser, 1, args);
+    return status;
+}
+
+
+/**
+ *  @brief Action of the fuzzed schema. Counts its invocations.
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Value given as "--action=value", or NULL
+ *  @param [in] ctx Unused
+ *  @return Action result
+ */
+static int countAction(ArgParser *obj, const char *arg, void *ctx)
+{
+    (void) obj;
+    (void) ctx;
+
+    config.actionCount++;
+    return ((arg != NULL) && (strcmp(arg, "stop") == 0)) ? ArgParserAction_Stop : ArgParserAction_Continue;
+}
+
+
+/**
+ *  @brief Get current time.
+ *  @return Monotonic time in nanoseconds
+ */
+static uint64_t now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+
+/**
+ *  @brief Get the peak resident set size.
+ *  @return Peak RSS in KiB
+ */
+static long peakRssKB(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+
+#ifdef APARSER_LIBFUZZER
+
+/**
+ *  @brief libFuzzer entry point.
+ *  @param [in] data Input data
+ *  @param [in] size Input size
+ *  @return Always 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if(initialize() != 0)
+        abort();
+
+    runInput(data, size);
+    return 0;
+}
+
+#else
+
+/**
+ *  @brief Run a file, or all files in a directory.
+ *  @param [in] path File or directory path
+ *  @return Execution status
+ */
+static int runPath(const char *path)
+{
+    struct stat st;
+    if(stat(path, &st) != 0)
+    {
+        fprintf(stderr, "Error: Cannot open '%s'.\n", path);
+        return 1;
+    }
+
+    if(S_ISDIR(st.st_mode))
+    {
+        struct dirent **entries;
+        int num = scandir(path, &entries, NULL, alphasort);
+        int status = 0;
+        int i;
+        for(i = 0; i < num; i++)
+        {
+            if(entries[i]->d_name[0] != '.')
+            {
+                char child[4096];
+                snprintf(child, sizeof(child), "%s/%s", path, entries[i]->d_name);
+                status |= runPath(child);
+            }
+            free(entries[i]);
+        }
+        free(entries);
+        return status;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        fprintf(stderr, "Error: Cannot open '%s'.\n", path);
+        return 1;
+    }
+
+    uint8_t *data = (uint8_t *) malloc(st.st_size + 1);
+    size_t size = (data != NULL) ? fread(data, 1, st.st_size, fp) : 0;
+    fclose(fp);
+
+    uint64_t start = now();
+    int status = runInput(data, size);
+    uint64_t elapsed = now() - start;
+    free(data);
+
+    printf("%-40s %8zu bytes %10llu ns %8.1f ns/byte  parse=%s\n",
+            path, size, (unsigned long long) elapsed,
+            (size != 0) ? (double) elapsed / size : 0.0, (status == 0) ? "ok" : "error");
+    return 0;
+}
+
+
+/**
+ *  @brief Main function.
+ *         Runs the given files/directories, or stdin if none is given.
+ *  @param [in] argc     Number of command line arguments
+ *  @param [in] argv[]   Command line argument array
+ *  @return   Execution status
+ */
+int main(int argc, char *argv[])
+{
+    int status = 0;
+    int i;
+
+    if(initialize() != 0)
+        return 1;
+
+    if(argc < 2)
+    {
+        static uint8_t data[1 << 20];
+        size_t size = fread(data, 1, sizeof(data), stdin);
+        runInput(data, size);
+        return 0;
+    }
+
+    for(i = 1; i < argc; i++)
+        status |= runPath(argv[i]);
+
+    printf("peak RSS growth: %ld KiB\n", peakRssKB() - rssBaseKB);
+    return status;
+}
+
+#endif // APARSER_LIBFUZZER
+
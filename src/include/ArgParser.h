@@ -10,12 +10,85 @@
 #ifndef SRC_ARG_PARSER_H_
 #define SRC_ARG_PARSER_H_
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 /* Typedefs */
 typedef struct ArgParser_ ArgParser;
 
+/**
+ *  @brief Default value provider.
+ *         Writes the default value to the destination and returns 0,
+ *         or returns non-zero to fall back to the registered default value.
+ *  @param [out] dest Destination
+ *  @param [in]  size Destination size (the maximum length for strings)
+ *  @param [in]  ctx  User context
+ *  @return Execution status
+ */
+typedef int (*ArgParser_DefaultFn)(void *dest, size_t size, void *ctx);
+
+/**
+ *  @brief Config loader of a cached parse. It runs only when the cache misses.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Context given at ArgParser_parseCached()
+ *  @return Execution status
+ */
+typedef int (*ArgParser_LoadFn)(ArgParser *obj, void *ctx);
+
+/**
+ *  @brief Option module.
+ *         Registers the options of a library with the ArgParser_add*() functions.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx User context
+ *  @return Execution status
+ */
+typedef int (*ArgParser_ModuleFn)(ArgParser *obj, void *ctx);
+
+/**
+ *  @brief Action option callback.
+ *         Invoked during the parse when the option appears.
+ *  @param [in] obj ArgParser object being parsed
+ *  @param [in] arg Value given as "--option=value", or NULL
+ *  @param [in] ctx User context
+ *  @return Action result (ArgParserAction)
+ */
+typedef int (*ArgParser_ActionFn)(ArgParser *obj, const char *arg, void *ctx);
+
+
+/* Enums */
+/**
+ *  @brief Result of an action option.
+ */
+typedef enum ArgParserAction_
+{
+    ArgParserAction_Continue = 0, ///< Continue parsing.
+    ArgParserAction_Stop     = 1, ///< Stop parsing successfully. The rest of the arguments is not examined. (The default providers still run.)
+    ArgParserAction_Error    = 2  ///< Fail the parse.
+
+} ArgParserAction;
+
+
+/* Structs */
+/**
+ *  @brief Memory usage of an ArgParser object, in bytes.
+ */
+typedef struct ArgParserMemUsage_
+{
+    size_t object;    ///< Object itself (error message, counters, ...)
+    size_t tables;    ///< Parameter definition tables
+    size_t arena;     ///< String arena (capacity)
+    size_t arenaUsed; ///< String arena in use
+    size_t index;     ///< Lookup index
+    size_t help;      ///< Help text (names and descriptions) held in the arena
+    size_t helpCache; ///< Help messages rendered for each width, and the search index
+    size_t plans;     ///< Parse-plan cache
+    size_t defaults;  ///< Default values overridden on this instance
+    size_t shared;    ///< Definitions, arena and index of the schema, borrowed from its owner (clones only)
+    size_t total;     ///< Sum of object, tables, arena, index, plans, defaults and help cache (not shared)
+} ArgParserMemUsage;
+
+
 /* Signatures */
 /**
  *  @brief Create a new ArgParser object.
@@ -32,6 +105,27 @@ ArgParser* ArgParser_new(char *progName, char *progDesc);
  */
 int ArgParser_delete(ArgParser *obj);
 
+/**
+ *  @brief Create a clone which shares the schema.
+ *         The parameter definitions, the strings and the lookup index are shared,
+ *         and only the default values changed by ArgParser_setDefault() are copied.
+ *         The clones write to the same destinations, so parse them one at a time.
+ *         The shared schema cannot be changed any more.
+ *  @param [in] schema ArgParser object to clone
+ *  @return A new ArgParser object if success, NULL otherwise.
+ */
+ArgParser* ArgParser_clone(ArgParser *schema);
+
+/**
+ *  @brief Override the default value of a parameter on this object.
+ *         The other objects sharing the schema keep their default values.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] name  Parameter name
+ *  @param [in] value Default value, in the command line format
+ *  @return Execution status
+ */
+int ArgParser_setDefault(ArgParser *obj, const char *name, const char *value);
+
 /**
  *  @brief Require all positional parameters to be set.
  *         If invoked, user cannot omit positional parameters.
@@ -40,6 +134,24 @@ int ArgParser_delete(ArgParser *obj);
  */
 int ArgParser_requireFullPosParams(ArgParser *obj);
 
+/**
+ *  @brief Set the maximum number of option spellings searched linearly.
+ *         Schemas with more spellings are looked up through a hash table.
+ *  @param [in] obj       ArgParser object
+ *  @param [in] threshold Maximum number of spellings for the linear scan
+ *  @return Execution status
+ */
+int ArgParser_setLookupThreshold(ArgParser *obj, unsigned int threshold);
+
+/**
+ *  @brief Build the option lookup index.
+ *         The lookup strategy is chosen by the number of option spellings.
+ *         Invoked automatically by ArgParser_parse() if the schema has been changed.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_freeze(ArgParser *obj);
+
 /**
  *  @brief Set version string.
  *  @param [in] obj     ArgParser object
@@ -147,7 +259,7 @@ int ArgParser_addInt32(ArgParser *obj,
  *  @return Execution status
  */
 int ArgParser_addUInt32(ArgParser *obj,
-        int32_t *dest, int32_t defVal, char *sOpt, char *lOpt, const char *name, const char *desc);
+        uint32_t *dest, uint32_t defVal, char *sOpt, char *lOpt, const char *name, const char *desc);
 
 /**
  *  @brief Add float-type option.
@@ -191,7 +303,315 @@ int ArgParser_addTrue(ArgParser *obj,
         bool *dest, char *sOpt, char *lOpt, const char *name, const char *desc);
 
 /**
- *  @brief ---
+ *  @brief Add bool-type option bound to a bit of a word array.
+ *         The bit is words[bit / 64] & (1 << (bit % 64)). The other bits of the words are
+ *         kept, so many flags can share the words, and be copied or tested with masks.
+ *         A bit already bound to another parameter is rejected.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] words  Word array
+ *  @param [in] bit    Bit index in the array
+ *  @param [in] defVal Default value
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @param [in] name   Parameter name
+ *  @param [in] desc   Parameter description
+ *  @return Execution status
+ */
+int ArgParser_addBoolBit(ArgParser *obj,
+        uint64_t *words, unsigned int bit, bool defVal, char *sOpt, char *lOpt, const char *name, const char *desc);
+
+/**
+ *  @brief Add switch-type option bound to a bit of a word array.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] words Word array
+ *  @param [in] bit   Bit index in the array
+ *  @param [in] sOpt  Short option
+ *  @param [in] lOpt  Long option
+ *  @param [in] name  Parameter name
+ *  @param [in] desc  Parameter description
+ *  @return   Execution status
+ */
+int ArgParser_addTrueBit(ArgParser *obj,
+        uint64_t *words, unsigned int bit, char *sOpt, char *lOpt, const char *name, const char *desc);
+
+/**
+ *  @brief Add action-type option.
+ *         The action is invoked when the option appears, in the order of the arguments.
+ *         It takes no value argument, but may be given one as "--option=value".
+ *  @param [in] obj    ArgParser object
+ *  @param [in] action Action callback
+ *  @param [in] ctx    User context passed to the action
+ *  @param [in] sOpt   Short option
+ *  @param [in] lOpt   Long option
+ *  @param [in] name   Parameter name
+ *  @param [in] desc   Parameter description
+ *  @return   Execution status
+ */
+int ArgParser_addAction(ArgParser *obj,
+        ArgParser_ActionFn action, void *ctx, char *sOpt, char *lOpt, const char *name, const char *desc);
+
+/**
+ *  @brief Choose whether the help and version options terminate the process.
+ *         If disabled, they print their message and stop the parse, which returns success;
+ *         check it with ArgParser_isStopped(). Enabled by default.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] exit If set, exit(0) after the help or version message.
+ *  @return Execution status
+ */
+int ArgParser_setExitOnHelp(ArgParser *obj, bool exit);
+
+/**
+ *  @brief Check if the last parse was stopped by an action.
+ *  @param [in] obj ArgParser object
+ *  @retval true  An action stopped the parse. The values after it are not set.
+ *  @retval false The parse examined all arguments (or failed).
+ */
+bool ArgParser_isStopped(ArgParser *obj);
+
+/**
+ *  @brief Add another spelling of an optional parameter.
+ *         Any number of aliases can be added. They are looked up through the same index
+ *         as the short and long options, and are not shown in the help message.
+ *         A long alias of a bool or switch-type parameter is negatable as well. ("--no-...")
+ *  @param [in] obj      ArgParser object
+ *  @param [in] name     Parameter name
+ *  @param [in] spelling Option spelling ("-x", "--old-name")
+ *  @return Execution status
+ */
+int ArgParser_addAlias(ArgParser *obj, const char *name, const char *spelling);
+
+/**
+ *  @brief Add an option module.
+ *         The options registered by the module are merged into the same lookup index
+ *         as the others. An option spelling or a parameter name defined by two modules
+ *         (or by a module and the application) makes the freeze step fail.
+ *         If the module fails, the parameters, aliases and validators it registered are removed.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] name   Module name (used in the error messages)
+ *  @param [in] module Module function
+ *  @param [in] ctx    User context passed to the module function
+ *  @return Execution status
+ */
+int ArgParser_addModule(ArgParser *obj, const char *name, ArgParser_ModuleFn module, void *ctx);
+
+/**
+ *  @brief Set a lazily evaluated default value.
+ *         The provider runs only if the parameter is still unset after parsing,
+ *         so expensive defaults are not computed when the user overrides them.
+ *         The static default value is written before, so it stays if the provider fails.
+ *         A name shared by several parameters (of different modules) is rejected.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] name     Parameter name
+ *  @param [in] provider Default value provider
+ *  @param [in] ctx      User context passed to the provider
+ *  @return Execution status
+ */
+int ArgParser_setDefaultProvider(ArgParser *obj, const char *name, ArgParser_DefaultFn provider, void *ctx);
+
+/**
+ *  @brief Restrict a numeric parameter to a range. (int, uint, int32, uint32, float, double)
+ *         The bounds are converted to the parameter type once, and the values are
+ *         checked as they are converted.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] name Parameter name
+ *  @param [in] min  Minimum value (inclusive)
+ *  @param [in] max  Maximum value (inclusive)
+ *  @return Execution status
+ */
+int ArgParser_setRange(ArgParser *obj, const char *name, double min, double max);
+
+/**
+ *  @brief Restrict the length of a string parameter.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] name   Parameter name
+ *  @param [in] minLen Minimum length (inclusive)
+ *  @param [in] maxLen Maximum length (inclusive)
+ *  @return Execution status
+ */
+int ArgParser_setLength(ArgParser *obj, const char *name, unsigned int minLen, unsigned int maxLen);
+
+/**
+ *  @brief Restrict the characters of a string parameter.
+ *         The class is written as in a regular expression bracket, without the brackets:
+ *         characters and ranges ("a-z0-9_"), negated by a leading '^'.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] name    Parameter name
+ *  @param [in] charset Character class
+ *  @return Execution status
+ */
+int ArgParser_setCharset(ArgParser *obj, const char *name, const char *charset);
+
+/**
+ *  @brief Require a string parameter to be valid UTF-8.
+ *         Overlong forms, surrogates and code points above U+10FFFF are rejected, and so are
+ *         the control characters (U+0000 to U+001F, U+007F) unless allowed.
+ *  @param [in] obj          ArgParser object
+ *  @param [in] name         Parameter name
+ *  @param [in] allowControl If set, the control characters are accepted.
+ *  @return Execution status
+ */
+int ArgParser_setUtf8(ArgParser *obj, const char *name, bool allowControl);
+
+/**
+ *  @brief Bind a group of dotted options to a struct.
+ *         The long options "--db.pool.size" and "--db.pool.timeout" belong to the group "db.pool",
+ *         which is in the group "db". The destinations of a group are fields of the bound struct,
+ *         recorded by their offsets; a destination outside the struct is rejected. A subgroup bound
+ *         to a struct inside this one is a field too. Binding the group again moves these fields
+ *         to the new struct, and leaves the subgroups bound to their own structs where they are.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path Group path ("db.pool")
+ *  @param [in] base Struct of the group
+ *  @param [in] size Size of the struct
+ *  @return Execution status
+ */
+int ArgParser_bindGroup(ArgParser *obj, const char *path, void *base, size_t size);
+
+/**
+ *  @brief Take the default values of a group subtree from a struct.
+ *         Each parameter of the subtree reads the field at its offset in the bound struct.
+ *         The subgroups bound to their own structs are not in it, and are skipped.
+ *         Like ArgParser_setDefault(), this changes only this object.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] path     Group path
+ *  @param [in] defaults Struct of the same type as the bound one
+ *  @return Execution status
+ */
+int ArgParser_setGroupDefaults(ArgParser *obj, const char *path, const void *defaults);
+
+/**
+ *  @brief Print the values of a group subtree, a line for each parameter. ("db.pool.size = 10")
+ *  @param [in] obj  ArgParser object
+ *  @param [in] fp   Output file pointer
+ *  @param [in] path Group path (NULL: all parameters)
+ *  @return Execution status
+ */
+int ArgParser_dumpGroup(ArgParser *obj, FILE *fp, const char *path);
+
+/**
+ *  @brief Enable/disable the lazy conversion mode.
+ *         In the lazy mode, ArgParser_parse() only records the value token of each parameter.
+ *         The value is converted and written to the destination on the first access through
+ *         the ArgParser_get*() functions. The command line arguments must stay alive until then.
+ *         A value which fails the conversion is reported once, and the default value is kept.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] lazy If true, the lazy mode is enabled.
+ *  @return Execution status
+ */
+int ArgParser_setLazy(ArgParser *obj, bool lazy);
+
+/**
+ *  @brief Get an int-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getInt(ArgParser *obj, const char *name, int *value);
+
+/**
+ *  @brief Get an unsigned-int-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getUInt(ArgParser *obj, const char *name, unsigned int *value);
+
+/**
+ *  @brief Get a string-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value (the destination buffer)
+ *  @return Execution status
+ */
+int ArgParser_getString(ArgParser *obj, const char *name, const char **value);
+
+/**
+ *  @brief Get a bool-type or switch-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getBool(ArgParser *obj, const char *name, bool *value);
+
+/**
+ *  @brief Get an int32_t-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getInt32(ArgParser *obj, const char *name, int32_t *value);
+
+/**
+ *  @brief Get a uint32_t-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getUInt32(ArgParser *obj, const char *name, uint32_t *value);
+
+/**
+ *  @brief Get a float-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getFloat(ArgParser *obj, const char *name, float *value);
+
+/**
+ *  @brief Get a double-type parameter value.
+ *  @param [in]  obj   ArgParser object
+ *  @param [in]  name  Parameter name
+ *  @param [out] value Parameter value
+ *  @return Execution status
+ */
+int ArgParser_getDouble(ArgParser *obj, const char *name, double *value);
+
+/**
+ *  @brief Enable/disable the parse-plan cache.
+ *         For each shape of command line (the sequence of option spellings),
+ *         the resolved parameters are cached. A later command line of the same shape
+ *         skips the argument classification and the option lookup, and goes straight
+ *         to the value conversion.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] enable If true, the plan cache is enabled.
+ *  @return Execution status
+ */
+int ArgParser_setPlanCache(ArgParser *obj, bool enable);
+
+/**
+ *  @brief Route the options under a prefix to another schema.
+ *         An option which starts with the prefix ("--storage-dir" for "--storage-") is looked up
+ *         in the schema of the namespace. All namespaces are served in the same pass over argv.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] prefix Prefix, "--" and a word ending with '-'. ("--storage-")
+ *  @param [in] sub    Schema of the namespace (not owned)
+ *  @return Execution status
+ */
+int ArgParser_addNamespace(ArgParser *obj, const char *prefix, ArgParser *sub);
+
+/**
+ *  @brief Collect the unknown arguments instead of failing.
+ *         Unknown options, extra positional arguments and all arguments after "--"
+ *         are kept for ArgParser_rest().
+ *  @param [in] obj    ArgParser object
+ *  @param [in] enable If true, the leftover arguments are collected.
+ *  @return Execution status
+ */
+int ArgParser_collectRest(ArgParser *obj, bool enable);
+
+/**
+ *  @brief Get the leftover arguments of the last parse, in the order of appearance.
+ *         The array points into argv, and is valid until the next parse.
+ *  @param [in]  obj     ArgParser object
+ *  @param [out] restNum Number of leftover arguments
+ *  @param [out] rest    Leftover arguments
+ *  @return Execution status
  */
 int ArgParser_rest(ArgParser *obj, int *restNum, char ***rest);
 
@@ -204,6 +624,119 @@ int ArgParser_rest(ArgParser *obj, int *restNum, char ***rest);
  */
 int ArgParser_parse(ArgParser *obj,int argc, char **argv);
 
+/**
+ *  @brief Parse the command line of the own process, read from /proc/self/cmdline.
+ *         For libraries and static constructors which have no access to argv.
+ *         The arguments are kept by the object until it is deleted or parses itself again.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_parseSelf(ArgParser *obj);
+
+/**
+ *  @brief Choose whether the config loaders skip the keys which are not options.
+ *         By default, such a key fails the load. (See ArgParser_loadJson(), ArgParser_loadConfDirs())
+ *  @param [in] obj    ArgParser object
+ *  @param [in] ignore If set, the unknown keys are skipped.
+ *  @return Execution status
+ */
+int ArgParser_setIgnoreUnknownConfig(ArgParser *obj, bool ignore);
+
+/**
+ *  @brief Load the option values of a JSON config file.
+ *         Each member of the top-level object sets the long option of its name, and nested
+ *         objects set the options of the dotted path. ({"db": {"port": 5432}} sets --db.port.)
+ *         The values are the default values of this object, so the command line overrides them.
+ *         A negated key sets its flag to the opposite value. ({"no-verbose": true})
+ *         A member which is not an option fails the load, unless ArgParser_setIgnoreUnknownConfig().
+ *         The load is all or nothing: a failed load leaves the default values as they were.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path File path
+ *  @return Execution status
+ */
+int ArgParser_loadJson(ArgParser *obj, const char *path);
+
+/**
+ *  @brief Load the option values of layered conf.d directories.
+ *         Each "*.conf" file holds lines of "name = value" (or a bare "name" for a switch).
+ *         A file in a later directory masks the file of the same name in an earlier one, and
+ *         the files are merged in the lexical order of their names, the later ones overriding.
+ *         The fragments are cached on the object, so a reload parses only the changed ones.
+ *         A negated name ("no-verbose") sets the opposite value of the flag.
+ *         A name which is not an option fails the load, unless ArgParser_setIgnoreUnknownConfig().
+ *         The load is all or nothing: a failed load leaves the default values as they were.
+ *  @param [in] obj     ArgParser object
+ *  @param [in] dirs    Directories, lowest priority first (missing ones are skipped)
+ *  @param [in] numDirs Number of directories
+ *  @return Execution status
+ */
+int ArgParser_loadConfDirs(ArgParser *obj, const char *const *dirs, unsigned int numDirs);
+
+/**
+ *  @brief Enable the on-disk parse cache under $XDG_RUNTIME_DIR.
+ *         A cached parse is keyed by the command line, the values of the given environment
+ *         variables, the identity and modification time of the given files (and of the entries
+ *         of the given directories), and the schema with its default values.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] envNames Environment variables the loader reads (NULL-terminated, or NULL)
+ *  @param [in] paths    Config files and directories the loader reads (NULL-terminated, or NULL)
+ *  @return Execution status
+ */
+int ArgParser_enableParseCache(ArgParser *obj, const char *const *envNames, const char *const *paths);
+
+/**
+ *  @brief Load the configs and parse the command line, or restore the values of the same parse.
+ *         On a miss, the loader runs, the command line is parsed, and the values are stored.
+ *         On a hit, neither runs: the values are restored from the cache file.
+ *         (Without the cache, or its directory, this is a plain load and parse.)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argc Number of command line arguments
+ *  @param [in] argv Command line argument array
+ *  @param [in] load Config loader (NULL: none)
+ *  @param [in] ctx  Context of the loader
+ *  @return Execution status
+ */
+int ArgParser_parseCached(ArgParser *obj, int argc, char **argv, ArgParser_LoadFn load, void *ctx);
+
+/**
+ *  @brief Enable the option-usage telemetry.
+ *         After each successful parse, the given parameters are counted, and the counts are
+ *         appended to the file by a background thread. The file is shared by the process.
+ *  @param [in] obj  ArgParser object
+ *  @param [in] path Output file, or NULL to use $ARGPARSER_TELEMETRY.
+ *  @return Execution status
+ */
+int ArgParser_enableTelemetry(ArgParser *obj, const char *path);
+
+/**
+ *  @brief Write the telemetry collected so far to the file.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_flushTelemetry(ArgParser *obj);
+
+/**
+ *  @brief Enable the parse tracing, or disable it.
+ *         The begin and end times of the classify, lookup and convert phases of each token,
+ *         and of the config files and layers, are recorded into a buffer allocated here.
+ *         The events after the buffer fills up are dropped. Available in the builds with
+ *         APARSER_TRACE defined; the other builds have no hooks, and fail here.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] capacity Number of events kept (0: disable)
+ *  @return Execution status
+ */
+int ArgParser_enableTrace(ArgParser *obj, unsigned int capacity);
+
+/**
+ *  @brief Write the recorded events in the Chrome trace format, and clear them.
+ *         The output loads in chrome://tracing and Perfetto. The timestamps are CLOCK_MONOTONIC,
+ *         as "perf record -k CLOCK_MONOTONIC" records, and the thread IDs are those of perf.
+ *  @param [in] obj ArgParser object
+ *  @param [in] fp  Output file pointer
+ *  @return Execution status
+ */
+int ArgParser_writeTrace(ArgParser *obj, FILE *fp);
+
 /**
  *  @brief Print internal variables.
  *  @param [in] obj ArgParser object
@@ -220,6 +753,46 @@ int ArgParser_dump(ArgParser *obj, FILE *fp);
  */
 int ArgParser_printHelp(ArgParser *obj, FILE *fp);
 
+/**
+ *  @brief Print help message laid out for a terminal width.
+ *         The rendered message is cached for each width.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] fp    Output file pointer
+ *  @param [in] width Terminal width (0: $COLUMNS, the terminal size of fp, or 80)
+ *  @return Execution status
+ */
+int ArgParser_printHelpWidth(ArgParser *obj, FILE *fp, unsigned int width);
+
+/**
+ *  @brief Print help message of the parameters matching a keyword.
+ *         The keyword is matched case-insensitively against the beginning of the words
+ *         in the names, the descriptions and the spellings. ("--help=<keyword>" does the same.)
+ *  @param [in] obj     ArgParser object
+ *  @param [in] fp      Output file pointer
+ *  @param [in] keyword Keyword
+ *  @return Execution status
+ */
+int ArgParser_searchHelp(ArgParser *obj, FILE *fp, const char *keyword);
+
+/**
+ *  @brief Get the memory usage.
+ *         The schema shared by ArgParser_clone() is charged to the object which owns it.
+ *         A clone reports its own parse states in tables, and the borrowed schema in shared.
+ *  @param [in]  obj   ArgParser object
+ *  @param [out] usage Memory usage breakdown
+ *  @return Execution status
+ */
+int ArgParser_memoryUsage(ArgParser *obj, ArgParserMemUsage *usage);
+
+/**
+ *  @brief Release the parameter definitions, the lookup index and the help text.
+ *         Call after the final parse. The destinations keep their values, and
+ *         ArgParser_getErrorMsg() stays available. The other functions fail afterward.
+ *  @param [in] obj ArgParser object
+ *  @return Execution status
+ */
+int ArgParser_shrink(ArgParser *obj);
+
 /**
  *  @brief Get error message.
  *  @param [in] obj ArgParser object
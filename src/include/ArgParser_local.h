@@ -9,13 +9,16 @@
 #ifndef SRC_ARG_PARSER_LOCAL_H_
 #define SRC_ARG_PARSER_LOCAL_H_
 
+#include <stdint.h>
 #include <stdbool.h>
 
 /* Macros */
 /**
  *  @brief Buffer size to store string data.
  */
+#ifndef APARSER_MAX_BUF
 #define APARSER_MAX_BUF      0x1000
+#endif
 
 /**
  *  @brief Maximum size of an error message.
@@ -25,7 +28,91 @@
 /**
  *  @brief Maximum number of optional/positional parameters.
  */
+#ifndef APARSER_MAX_ARG_PRMS
 #define APARSER_MAX_ARG_PRMS     32
+#endif
+
+/**
+ *  @brief Maximum number of option spellings searched linearly.
+ *         Larger schemas are looked up through a hash table.
+ *         Measured with "arg_parser_bench lookup" (release build, mean of 10 runs): the two
+ *         strategies are within the noise up to 8 spellings, and the hash table is faster from
+ *         10 spellings on (59.5 vs 56.4 ns/token at 10, 69.5 vs 56.9 at 24).
+ */
+#ifndef APARSER_LINEAR_LOOKUP_MAX
+#define APARSER_LINEAR_LOOKUP_MAX 10
+#endif
+
+/**
+ *  @brief Number of command line shapes kept in the parse-plan cache.
+ */
+#define APARSER_PLAN_CACHE_SIZE   4
+
+/**
+ *  @brief Help layout: default terminal width, minimum description column width,
+ *         and number of widths whose rendered help is cached.
+ */
+#define APARSER_HELP_WIDTH        80
+#define APARSER_HELP_MIN_DESC     20
+#define APARSER_HELP_CACHE_SIZE   4
+
+/**
+ *  @brief Maximum number of prefix namespaces.
+ */
+#define APARSER_MAX_NAMESPACES    16
+
+/**
+ *  @brief Maximum number of option groups. ("db", "db.pool", ...)
+ */
+#define APARSER_MAX_GROUPS        64
+
+/**
+ *  @brief Maximum length of an option spelling given with a value. ("--option=value")
+ */
+#define APARSER_MAX_SPELLING      128
+
+/**
+ *  @brief Record types of the telemetry file.
+ *         The file is a sequence of records in the host byte order, each starting with its type.
+ *         - 'S' u32 schema ID, u16 optional count, u16 positional count, then per parameter u8 length and name
+ *         - 'P' u32 schema ID, u32 parses
+ *         - 'U' u32 schema ID, u16 parameter index (positional: APARSER_MAX_ARG_PRMS + i), u32 uses
+ *         - 'D' u32 entries dropped on overflow
+ *         A schema record precedes the other records of the schema, in each file. It may repeat.
+ */
+#define APARSER_TELEMETRY_REC_SCHEMA  'S'
+#define APARSER_TELEMETRY_REC_PARSES  'P'
+#define APARSER_TELEMETRY_REC_USES    'U'
+#define APARSER_TELEMETRY_REC_DROPPED 'D'
+
+/**
+ *  @brief Version of the value image layout of the parse cache. (A part of the fingerprint)
+ */
+#define APARSER_CACHE_VERSION     1
+
+/**
+ *  @brief Flags of a parameter in the value image.
+ */
+#define APARSER_CACHE_SET         0x01 ///< Given on the command line
+#define APARSER_CACHE_PROVIDED    0x02 ///< Written by the default value provider
+
+/**
+ *  @brief Maximum size of the label of a trace event. (Longer tokens and paths are truncated.)
+ */
+#define APARSER_TRACE_LABEL       48
+
+/**
+ *  @brief Trace hooks. Without APARSER_TRACE, they compile to nothing.
+ *         APARSER_TRACE_BEGIN() declares the begin time, APARSER_TRACE_END() records the event.
+ */
+#if defined(APARSER_TRACE)
+#define APARSER_TRACE_BEGIN(obj, t)                   uint64_t t = ((obj)->trace != NULL) ? ArgParserTrace_now() : 0
+#define APARSER_TRACE_END(obj, t, phase, token, label) \
+    do { if((obj)->trace != NULL) ArgParserTrace_end((obj), (phase), (t), (token), (label)); } while(0)
+#else
+#define APARSER_TRACE_BEGIN(obj, t)
+#define APARSER_TRACE_END(obj, t, phase, token, label) do { } while(0)
+#endif
 
 
 /* Enums */
@@ -43,7 +130,8 @@ typedef enum VarType_
     VarType_Float  = 6, ///< float type
     VarType_Double = 7, ///< double type
     VarType_True   = 8, ///< Switch type
-    VarType_Num    = 9  ///< Number of definitions
+    VarType_Action = 9, ///< Action type
+    VarType_Num    = 10 ///< Number of definitions
 
 } VarType;
 
@@ -60,6 +148,53 @@ typedef enum ArgType_
 } ArgType;
 
 
+/**
+ *  @brief Lookup strategy of the option index
+ */
+typedef enum LookupType_
+{
+    LookupType_None   = 0, ///< Not built yet.
+    LookupType_Linear = 1, ///< Linear scan over packed 16-byte prefixes.
+    LookupType_Hash   = 2  ///< Open-addressing hash table.
+
+} LookupType;
+
+
+/**
+ *  @brief Result of a value conversion.
+ */
+typedef enum ArgStatus_
+{
+    ArgStatus_OK      = 0, ///< Converted and written.
+    ArgStatus_Invalid = 1, ///< Not a value of the type.
+    ArgStatus_Range   = 2, ///< Out of the range.
+    ArgStatus_Length  = 3, ///< Too short or too long.
+    ArgStatus_Charset = 4, ///< Has a character out of the class.
+    ArgStatus_Utf8    = 5, ///< Not valid UTF-8.
+    ArgStatus_Control = 6  ///< Has a control character.
+
+} ArgStatus;
+
+
+/**
+ *  @brief Phase of a trace event.
+ */
+typedef enum TracePhase_
+{
+    TracePhase_Classify  = 0, ///< Type of a token
+    TracePhase_Lookup    = 1, ///< Option of a token
+    TracePhase_Convert   = 2, ///< Value of a token
+    TracePhase_Defaults  = 3, ///< Default values
+    TracePhase_Providers = 4, ///< Default value providers
+    TracePhase_Json      = 5, ///< JSON config file
+    TracePhase_ConfScan  = 6, ///< Listing of the conf.d layers
+    TracePhase_ConfRead  = 7, ///< Reading of a conf.d fragment (on a reader thread)
+    TracePhase_ConfMerge = 8, ///< Merging of a conf.d fragment
+    TracePhase_Num       = 9  ///< Number of phases
+
+} TracePhase;
+
+
 /* Unions */
 /**
  *  @brief Union to store variable-type data.
@@ -82,7 +217,78 @@ typedef union Val_
 } Val;
 
 
+/**
+ *  @brief Bound of a range, in the widest type of the parameter.
+ */
+typedef union Bound_
+{
+    int64_t i;              ///< for int and int32_t-type
+    uint64_t u;             ///< for unsigned int and uint32_t-type
+    double d;               ///< for float and double-type
+
+} Bound;
+
+
 /* Structs */
+/**
+ *  @brief Word of a description, found at the registration for the help layout.
+ */
+typedef struct HelpWord_
+{
+    uint32_t start;   ///< Offset in the description (APARSER_MAX_BUF may exceed 16 bits)
+    uint32_t len;     ///< Length (0: line break)
+} HelpWord;
+
+
+/**
+ *  @brief Text scanner: validates the encoding of a string, and measures it.
+ */
+typedef size_t (*TextScanFn)(const char *str, bool allowControl, int *status);
+
+
+/**
+ *  @brief Compiled validator of a parameter. (in the arena)
+ */
+typedef struct Validator_
+{
+    Bound min;              ///< Minimum value (numeric types)
+    Bound max;              ///< Maximum value (numeric types)
+    uint32_t minLen;        ///< Minimum length (string type)
+    uint32_t maxLen;        ///< Maximum length (string type)
+    const char *charset;    ///< Character class as given, or NULL (string type)
+    uint64_t charBits[4];   ///< Characters of the class, a bit for each byte value
+    TextScanFn scanText;    ///< UTF-8 validator, or NULL (string type)
+    bool allowControl;      ///< If set, the validator accepts the control characters.
+} Validator;
+
+
+/**
+ *  @brief Group of the dotted options, a node of the option tree.
+ */
+typedef struct Group_
+{
+    const char *path;     ///< Path ("db.pool")
+    uint16_t    pathLen;  ///< Length of the path
+    int16_t     parent;   ///< Parent group index, or -1
+    int16_t     owner;    ///< Bound ancestor whose struct holds the bound struct, or -1
+    uint64_t    hash;     ///< Hash of the path, continued segment by segment
+    char       *base;     ///< Bound struct, or NULL
+    size_t      size;     ///< Size of the bound struct
+    size_t      offset;   ///< Offset of the bound struct in the struct of the owner
+} Group;
+
+
+/**
+ *  @brief Other spelling of a parameter. (in the arena)
+ */
+typedef struct Alias_
+{
+    const char    *str;       ///< Spelling
+    bool           isNegated; ///< If set, the spelling clears the flag. ("--no-...", added automatically)
+    struct Alias_ *next;      ///< Next alias, or NULL
+} Alias;
+
+
 /**
  *  @brief Parameter definition structure
  */
@@ -94,10 +300,191 @@ typedef struct PrmDef_
     char    *desc;    ///< Description
     VarType  varType; ///< Variable type
     void    *dest;    ///< Destinationp pointer
+    uint64_t bitMask; ///< Bit of the flag in the word at dest (0: dest is a bool)
     Val      defVal;  ///< Default value
+    ArgParser_DefaultFn defFn; ///< Default value provider (NULL: use defVal)
+    void    *defCtx;  ///< User context of the default value provider
+    ArgParser_ActionFn action; ///< Action callback (action type)
+    void    *actionCtx; ///< User context of the action
+    Validator *check;  ///< Validator, or NULL
+    Alias   *aliases;  ///< Other spellings, or NULL
+    uint8_t  group;    ///< Group of the dotted long option (index + 1, 0: none)
+    uint8_t  owner;    ///< Bound group whose struct holds the destination (index + 1, 0: none)
+    size_t   offset;   ///< Offset of the destination in the struct of the owner
+    const char *module; ///< Name of the module which defined the parameter (NULL: application)
+    HelpWord *words;  ///< Words of the description (in the arena)
+    uint16_t  numWords; ///< Number of words
 } PrmDef;
 
 
+/**
+ *  @brief Parse state of a parameter. (Per object: the clones share the definitions.)
+ */
+typedef struct PrmState_
+{
+    bool        isSet; ///< If set, the value has been given by the user.
+    const char *raw;   ///< Value token waiting for the conversion (lazy mode), or NULL
+} PrmState;
+
+
+/**
+ *  @brief First 16 bytes of a string packed into two words, zero padded.
+ */
+typedef struct Prefix_
+{
+    uint64_t lo;      ///< Bytes 0-7
+    uint64_t hi;      ///< Bytes 8-15
+} Prefix;
+
+
+/**
+ *  @brief Option spelling registered in the lookup index
+ */
+typedef struct LookupKey_
+{
+    const char *str;  ///< Spelling ("-i", "--intparam", ...)
+    uint64_t    hash; ///< Hash value of the spelling
+    PrmDef     *pdef; ///< Parameter definition
+    bool   isNegated; ///< If set, the spelling clears the flag.
+} LookupKey;
+
+
+/**
+ *  @brief Option lookup index, built by the freeze step.
+ */
+typedef struct LookupIndex_
+{
+    LookupType    type;       ///< Lookup strategy
+    unsigned int  numKeys;    ///< Number of spellings
+    Prefix       *prefixes;   ///< Packed prefix of each spelling (linear)
+    LookupKey    *keys;       ///< Spellings
+    unsigned int  numSlots;   ///< Number of hash slots (power of two)
+    uint16_t     *slots;      ///< Hash slots, key index + 1 (0: empty)
+} LookupIndex;
+
+
+/**
+ *  @brief Word of the bit-packed flags, with the default values of its bits.
+ */
+typedef struct FlagWord_
+{
+    uint64_t *word;   ///< Word
+    uint64_t  mask;   ///< Bits of the flags
+    uint64_t  bits;   ///< Default values of the bits
+} FlagWord;
+
+
+/**
+ *  @brief Trace event
+ */
+typedef struct TraceEvent_
+{
+    uint64_t    begin;  ///< Begin time (CLOCK_MONOTONIC, ns)
+    uint64_t    end;    ///< End time (CLOCK_MONOTONIC, ns)
+    uint32_t    tid;    ///< Thread ID
+    uint8_t     phase;  ///< Phase (TracePhase)
+    int32_t     token;  ///< Index of the token in argv (-1: none)
+    char        label[APARSER_TRACE_LABEL]; ///< Token or file path
+} TraceEvent;
+
+
+/**
+ *  @brief Step of a parse plan: one option (with its value) or one positional argument.
+ */
+typedef struct PlanStep_
+{
+    PrmDef     *pdef;     ///< Parameter definition
+    const char *spelling; ///< Option spelling, or NULL for a positional argument
+    bool       isNegated; ///< If set, the spelling clears the flag.
+} PlanStep;
+
+
+/**
+ *  @brief Parse plan of a command line shape.
+ */
+typedef struct Plan_
+{
+    uint64_t      shape;    ///< Shape hash
+    int           argc;     ///< Number of command line arguments
+    unsigned int  numSteps; ///< Number of steps
+    PlanStep     *steps;    ///< Steps (NULL: empty slot)
+} Plan;
+
+
+/**
+ *  @brief Default value overridden on an instance. (The schema keeps its own.)
+ */
+typedef struct DefaultOverride_
+{
+    PrmDef *pdef;     ///< Parameter definition
+    Val     val;      ///< Default value (an owned copy for strings)
+    bool    isConfig; ///< If set, the value came from a config file, and wins over the provider.
+} DefaultOverride;
+
+
+/**
+ *  @brief Default values saved before a config file is loaded, to undo a failed load.
+ */
+typedef struct ConfigMark_
+{
+    unsigned int     numObjs;                                   ///< Number of objects (the object, then its namespaces)
+    ArgParser       *objs[1 + APARSER_MAX_NAMESPACES];         ///< Objects
+    DefaultOverride *defaults[1 + APARSER_MAX_NAMESPACES];     ///< Copies of their default values
+    unsigned int     numDefaults[1 + APARSER_MAX_NAMESPACES];  ///< Number of the default values
+} ConfigMark;
+
+
+/**
+ *  @brief Prefix namespace: options under the prefix are routed to another schema.
+ */
+typedef struct Namespace_
+{
+    const char    *prefix; ///< Prefix ("--storage-")
+    unsigned int   len;    ///< Prefix length
+    ArgParser     *sub;    ///< Schema of the namespace
+    uint8_t        next;   ///< Next namespace with the same leading character (index + 1, 0: none)
+} Namespace;
+
+
+/**
+ *  @brief Schema saved before a module runs, to roll back a failed module.
+ */
+typedef struct SchemaMark_
+{
+    unsigned int numOptPrms;    ///< Number of optional parameters
+    unsigned int numPosPrms;    ///< Number of positional parameters
+    unsigned int numGroups;     ///< Number of groups
+    unsigned int numNamespaces; ///< Number of namespaces
+    unsigned int bufIdx;        ///< Used size of the arena
+    PrmDef      *prms;          ///< Optional parameters, then positional ones (aliases, validators, providers)
+    char        *buf;           ///< Used part of the arena (alias chains, validator bounds)
+    Group        groups[APARSER_MAX_GROUPS];         ///< Groups (bound structs)
+    Namespace    namespaces[APARSER_MAX_NAMESPACES]; ///< Namespaces (chains)
+    uint8_t      nsHeads[256];  ///< Namespace chain heads
+} SchemaMark;
+
+
+/**
+ *  @brief Entry of the help search index: a lowercased word and a parameter which contains it.
+ */
+typedef struct SearchEntry_
+{
+    const char   *word;   ///< Word (in the index text)
+    unsigned int  param;  ///< Parameter index (positional ones after the optional ones)
+} SearchEntry;
+
+
+/**
+ *  @brief Help message rendered for a width.
+ */
+typedef struct HelpCache_
+{
+    unsigned int  width;  ///< Terminal width
+    size_t        len;    ///< Text length
+    char         *text;   ///< Rendered text (NULL: empty slot)
+} HelpCache;
+
+
 /* Class */
 /**
  *  @brief   Argument parser object structure
@@ -114,14 +501,93 @@ struct ArgParser_
     /* Special Options */
     bool isHelpSpecified;                    ///< Show help message.
     bool isVerSpecified;                     ///< Show version string.
+    bool exitOnHelp;                         ///< If set, the help and version options exit the process.
+    bool isStopped;                          ///< If set, an action stopped the last parse.
 
     bool reqFullPosParams;                   ///< If set, the parser requires all positional parameters.
 
+    /* Lookup Index */
+    bool isFrozen;                           ///< If set, the lookup index is up to date.
+    unsigned int lookupThreshold;            ///< Maximum number of spellings searched linearly.
+    LookupIndex index;                       ///< Option lookup index.
+    LookupIndex names;                       ///< Parameter name index.
+    unsigned int numFlagWords;               ///< Number of words of the bit-packed flags.
+    FlagWord *flagWords;                     ///< Words of the bit-packed flags and their defaults.
+
+    /* Parse-Plan Cache */
+    bool usePlanCache;                       ///< If set, the parse plans are cached.
+    unsigned int nextPlan;                   ///< Plan slot to replace next.
+    Plan plans[APARSER_PLAN_CACHE_SIZE];     ///< Cached plans.
+    PlanStep *planScratch;                   ///< Steps being recorded.
+    unsigned int planScratchLen;             ///< Capacity of the step buffer.
+
+    /* Schema Sharing */
+    ArgParser *schema;                       ///< Object which owns the shared definitions. (NULL: this object)
+    unsigned int refCount;                   ///< Number of objects sharing the definitions. (owner only)
+    unsigned int numDefaults;                ///< Number of overridden default values.
+    unsigned int defaultsLen;                ///< Capacity of the override table.
+    DefaultOverride *defaults;               ///< Overridden default values, copied on write.
+
     /* Argument Definitions */
     unsigned int numOptPrms;                 ///< Number of optional parameters.
-    PrmDef optPrms[APARSER_MAX_ARG_PRMS];     ///< Optional parameters.
+    PrmDef *optPrms;                         ///< Optional parameters. (APARSER_MAX_ARG_PRMS entries)
     unsigned int numPosPrms;                 ///< Number of positional parameters.
-    PrmDef posPrms[APARSER_MAX_ARG_PRMS];     ///< Positional parameters.
+    PrmDef *posPrms;                         ///< Positional parameters. (APARSER_MAX_ARG_PRMS entries)
+    PrmState *optStates;                     ///< Parse states of the optional parameters. (APARSER_MAX_ARG_PRMS entries)
+    PrmState *posStates;                     ///< Parse states of the positional parameters. (APARSER_MAX_ARG_PRMS entries)
+    bool isShrunk;                           ///< If set, the definitions have been released by ArgParser_shrink().
+    bool isLazy;                             ///< If set, values are converted on the first access.
+    const char *curModule;                   ///< Module being added, or NULL.
+
+    /* Prefix Namespaces */
+    unsigned int numNamespaces;              ///< Number of namespaces.
+    Namespace namespaces[APARSER_MAX_NAMESPACES]; ///< Namespaces.
+    uint8_t nsHeads[256];                    ///< First namespace by the character after "--". (index + 1, 0: none)
+
+    /* Option Groups */
+    unsigned int numGroups;                  ///< Number of groups.
+    Group groups[APARSER_MAX_GROUPS];        ///< Groups, parents before children.
+
+    /* Leftover Arguments */
+    bool collectRest;                        ///< If set, unknown arguments are collected instead of failing.
+    int restNum;                             ///< Number of leftover arguments.
+    unsigned int restLen;                    ///< Capacity of the leftover argument array.
+    char **rest;                             ///< Leftover arguments (pointers into argv).
+    int32_t *restIdx;                        ///< Indices of the leftover arguments in argv.
+
+    /* Own Command Line */
+    char *selfArgs;                          ///< Contents of /proc/self/cmdline, split in place.
+    char **selfArgv;                         ///< Arguments pointing into selfArgs.
+
+    /* Help Cache */
+    unsigned int nextHelp;                   ///< Cache slot to replace next.
+    HelpCache helpCache[APARSER_HELP_CACHE_SIZE]; ///< Help messages by width.
+    char *searchText;                        ///< Words of the help search index.
+    size_t searchTextLen;                    ///< Size of the words.
+    unsigned int numSearch;                  ///< Number of search index entries.
+    SearchEntry *search;                     ///< Search index, sorted by word. (NULL: not built yet)
+
+    /* Telemetry */
+    bool useTelemetry;                       ///< If set, the given parameters are counted.
+    unsigned int telemetryId;                ///< Registered schema (index + 1, 0: not yet).
+
+    /* Config Fragments */
+    bool ignoreUnknownConfig;                ///< If set, the config keys which are not options are skipped.
+    unsigned int numFragments;               ///< Number of cached conf.d fragments.
+    struct ConfFragment_ *fragments;         ///< Tokenized fragments, in merge order. (ArgParser_conf.c)
+
+    /* Parse Cache */
+    char *cacheDeps;                         ///< Environment variable names, then file paths. (NUL-separated, NULL: disabled)
+    unsigned int numCacheEnv;                ///< Number of environment variable names.
+    unsigned int numCachePaths;              ///< Number of file paths.
+
+#if defined(APARSER_TRACE)
+    /* Tracing */
+    TraceEvent *trace;                       ///< Event buffer. (NULL: disabled)
+    unsigned int traceLen;                   ///< Capacity of the event buffer.
+    unsigned int numTrace;                   ///< Number of recorded events.
+    unsigned int traceDropped;               ///< Events dropped on overflow.
+#endif
     
     /* Error stauts */
     bool hasError;                           ///< Error flag.
@@ -130,11 +596,184 @@ struct ArgParser_
 
     /* Temporary Buffer */
     unsigned int bufIdx;                     ///< Current buffer index
-    char buf[APARSER_MAX_BUF];               ///< Temporary buffer to store string data.
+    char *buf;                               ///< Temporary buffer to store string data. (APARSER_MAX_BUF bytes)
 
 };
 
 
+/* Internal Functions */
+/**
+ *  @brief Store error message. (ArgParser.c, shared by all the modules)
+ *  @param [in] obj ArgParser object
+ *  @param [in] fmt Format string
+ *  @return Execution status
+ */
+int ArgParserError_set(ArgParser *obj, const char *fmt, ...);
+
+/**
+ *  @brief Record the parameters given in the last parse. (ArgParser_telemetry.c)
+ *  @param [in] obj ArgParser object
+ */
+void ArgParserTelemetry_record(ArgParser *obj);
+
+/**
+ *  @brief Apply a value of a config file to an option, as its default value on this object.
+ *         The command line overrides the value, and the value overrides the default value provider.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] spelling Long option spelling ("--db.pool.size")
+ *  @param [in] value    Value, in the command line format
+ *  @retval 0  Applied
+ *  @retval 1  Error
+ *  @retval -1 Unknown option (skipped)
+ */
+int ArgParserConfig_apply(ArgParser *obj, const char *spelling, const char *value);
+
+/**
+ *  @brief Save the default values of an object and of its namespaces before a config load.
+ *  @param [in]  obj  ArgParser object
+ *  @param [out] mark Saved default values
+ *  @return Execution status
+ */
+int ArgParserConfig_mark(ArgParser *obj, ConfigMark *mark);
+
+/**
+ *  @brief Finish a config load: keep the new default values, or restore the saved ones.
+ *  @param [in] mark     Saved default values (released)
+ *  @param [in] isFailed If set, the saved default values are restored.
+ */
+void ArgParserConfig_release(ConfigMark *mark, bool isFailed);
+
+/**
+ *  @brief Release the cached conf.d fragments. (ArgParser_conf.c)
+ *  @param [in] obj ArgParser object
+ */
+void ArgParserConfig_freeFragments(ArgParser *obj);
+
+/**
+ *  @brief Select the UTF-8 validator for this CPU. (ArgParser_utf8.c)
+ *         The validator measures the string, and reports ArgStatus_Utf8 or ArgStatus_Control.
+ *  @return UTF-8 validator
+ */
+TextScanFn ArgParserText_select(void);
+
+/**
+ *  @brief Get the scalar UTF-8 validator, the reference of the vector one. (ArgParser_utf8.c)
+ *  @return UTF-8 validator
+ */
+TextScanFn ArgParserText_scalar(void);
+
+#if defined(APARSER_TRACE)
+/**
+ *  @brief Get the trace clock. (ArgParser_trace.c)
+ *  @return CLOCK_MONOTONIC time in ns
+ */
+uint64_t ArgParserTrace_now(void);
+
+/**
+ *  @brief Record a trace event of the calling thread, ending now.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] phase Phase
+ *  @param [in] begin Begin time
+ *  @param [in] token Index of the token in argv (-1: none)
+ *  @param [in] label Token or file path (NULL: none)
+ */
+void ArgParserTrace_end(ArgParser *obj, TracePhase phase, uint64_t begin, int token, const char *label);
+
+/**
+ *  @brief Record a trace event.
+ *  @param [in] obj   ArgParser object
+ *  @param [in] phase Phase
+ *  @param [in] tid   Thread ID
+ *  @param [in] begin Begin time
+ *  @param [in] end   End time
+ *  @param [in] token Index of the token in argv (-1: none)
+ *  @param [in] label Token or file path (NULL: none)
+ */
+void ArgParserTrace_record(ArgParser *obj, TracePhase phase, uint32_t tid, uint64_t begin, uint64_t end, int token, const char *label);
+
+/**
+ *  @brief Get the ID of the calling thread. (Cached per thread)
+ *  @return Thread ID
+ */
+uint32_t ArgParserTrace_tid(void);
+#endif
+
+/**
+ *  @brief Make room for the leftover arguments of a command line. (ArgParser.c)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] argc Number of command line arguments
+ *  @return Execution status
+ */
+int ArgParserRest_reserve(ArgParser *obj, int argc);
+
+/**
+ *  @brief Calculate the hash value of a string (FNV-1a). (ArgParser.c)
+ *  @param [in] str String
+ *  @return Hash value
+ */
+uint64_t ArgParserHash_str(const char *str);
+
+/**
+ *  @brief Continue a hash over a value of a parameter. (ArgParser.c)
+ *  @param [in] hash Hash value
+ *  @param [in] pdef Parameter definition
+ *  @param [in] val  Value
+ *  @return Hash value
+ */
+uint64_t ArgParserParam_hashValue(uint64_t hash, PrmDef *pdef, const Val *val);
+
+/**
+ *  @brief Get the size of the destination. (ArgParser.c)
+ *  @param [in] pdef Parameter definition
+ *  @return Destination size (the maximum length for strings)
+ */
+size_t ArgParserParam_size(PrmDef *pdef);
+
+/**
+ *  @brief Get the default value of a parameter on this object. (ArgParser.c)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return Default value
+ */
+const Val* ArgParserParam_default(ArgParser *obj, PrmDef *pdef);
+
+/**
+ *  @brief Check if a parameter has a value from a config file on this object. (ArgParser.c)
+ *  @param [in] obj  ArgParser object
+ *  @param [in] pdef Parameter definition
+ *  @return True if it has, false otherwise.
+ */
+bool ArgParserParam_hasConfig(ArgParser *obj, PrmDef *pdef);
+
+/**
+ *  @brief Write a default value to the destination. (ArgParser.c)
+ *  @param [in] pdef   Parameter definition
+ *  @param [in] defVal Default value
+ *  @return Execution status
+ */
+int ArgParserParam_writeDefault(PrmDef *pdef, const Val *defVal);
+
+/**
+ *  @brief Store the value of a bool-type or switch-type parameter. (ArgParser.c)
+ *  @param [in] pdef  Parameter definition
+ *  @param [in] value Value
+ */
+void ArgParserParam_storeFlag(PrmDef *pdef, bool value);
+
+/**
+ *  @brief Load the value of a bool-type or switch-type parameter. (ArgParser.c)
+ *  @param [in] pdef Parameter definition
+ *  @return Value
+ */
+bool ArgParserParam_loadFlag(PrmDef *pdef);
+
+/**
+ *  @brief Run the default value provider of a parameter. (ArgParser.c)
+ *  @param [in] pdef Parameter definition
+ *  @return Execution status of the provider
+ */
+int ArgParserParam_provide(PrmDef *pdef);
+
 #endif // SRC_ARG_PARSER_LOCAL_H_
 
 
@@ -0,0 +1,120 @@
+/**
+ *  @file      test.h
+ *  @brief     Unit tests.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#ifndef SRC_TEST_TEST_H_
+#define SRC_TEST_TEST_H_
+
+#include <stdbool.h>
+
+/* Macros */
+/**
+ *  @brief Check a condition, and report it if false.
+ */
+#define TEST_ASSERT(cond)   Test_check((cond), #cond, __FILE__, __LINE__)
+
+
+/* Signatures */
+/**
+ *  @brief Record the result of a check.
+ *  @param [in] ok   Result
+ *  @param [in] expr Checked expression
+ *  @param [in] file Source file
+ *  @param [in] line Source line
+ *  @return Result
+ */
+bool Test_check(bool ok, const char *expr, const char *file, int line);
+
+/**
+ *  @brief Run the tests of the default values and their providers.
+ */
+void Test_defaults(void);
+
+/**
+ *  @brief Run the tests of the lazy conversion mode.
+ */
+void Test_lazy(void);
+
+/**
+ *  @brief Run the tests of the schema clones.
+ */
+void Test_clone(void);
+
+/**
+ *  @brief Run the tests of the option modules.
+ */
+void Test_module(void);
+
+/**
+ *  @brief Run the tests of the option-usage telemetry.
+ */
+void Test_telemetry(void);
+
+/**
+ *  @brief Run the tests of the help layout and the help search.
+ */
+void Test_help(void);
+
+/**
+ *  @brief Run the tests of the action options.
+ */
+void Test_action(void);
+
+/**
+ *  @brief Run the tests of the value conversion and the validators.
+ */
+void Test_convert(void);
+
+/**
+ *  @brief Run the tests of the config file loaders.
+ */
+void Test_config(void);
+
+/**
+ *  @brief Run the tests of the on-disk parse cache.
+ */
+void Test_cache(void);
+
+/**
+ *  @brief Run the tests of the option groups bound to structs.
+ */
+void Test_group(void);
+
+/**
+ *  @brief Run the tests of the flags bound to bits.
+ */
+void Test_flags(void);
+
+/**
+ *  @brief Run the tests of the parse-plan cache.
+ */
+void Test_plan(void);
+
+/**
+ *  @brief Run the tests of the prefix namespaces, the leftover arguments and ArgParser_parseSelf().
+ */
+void Test_namespace(void);
+
+/**
+ *  @brief Run the tests of the UTF-8 validation.
+ */
+void Test_utf8(void);
+
+/**
+ *  @brief Run the tests of the memory usage and ArgParser_shrink().
+ */
+void Test_memory(void);
+
+/**
+ *  @brief Run the tests of the parse tracing.
+ */
+void Test_trace(void);
+
+
+#endif // SRC_TEST_TEST_H_
+
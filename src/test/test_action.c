@@ -0,0 +1,88 @@
+/**
+ *  @file      test_action.c
+ *  @brief     Unit tests of the action options.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+static int stopAction(ArgParser *obj, const char *arg, void *ctx);
+static int countingProvider(void *dest, size_t size, void *ctx);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the action options.
+ */
+void Test_action(void)
+{
+    char *argv[] = { "test", "--level", "3", "--stop", "--unknown", NULL };
+    int level, file, calls;
+    int round, k;
+
+    /* A stopped parse keeps the given values, and still runs the providers. (With and without the plan cache) */
+    for(round = 0; round < 2; round++)
+    {
+        ArgParser *obj = ArgParser_new("test", "Test.");
+        TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+        TEST_ASSERT(ArgParser_addInt(obj, &file, 0, NULL, NULL, "file", "File.") == 0);
+        TEST_ASSERT(ArgParser_addAction(obj, stopAction, NULL, "-s", "--stop", "stop", "Stop.") == 0);
+        TEST_ASSERT(ArgParser_setDefaultProvider(obj, "file", countingProvider, &calls) == 0);
+        TEST_ASSERT(ArgParser_setPlanCache(obj, (round == 1)) == 0);
+
+        for(k = 0; k < 2; k++)
+        {
+            calls = 0;
+            file  = -1;
+            TEST_ASSERT(ArgParser_parse(obj, 5, argv) == 0);
+            TEST_ASSERT(ArgParser_isStopped(obj) == true);
+            TEST_ASSERT(level == 3);
+            TEST_ASSERT(calls == 1);
+            TEST_ASSERT(file == 42);
+        }
+
+        ArgParser_delete(obj);
+    }
+}
+
+
+/**
+ *  @brief Action which stops the parse.
+ *  @param [in] obj ArgParser object
+ *  @param [in] arg Unused
+ *  @param [in] ctx Unused
+ *  @return Action result (ArgParserAction)
+ */
+static int stopAction(ArgParser *obj, const char *arg, void *ctx)
+{
+    (void) obj;
+    (void) arg;
+    (void) ctx;
+    return ArgParserAction_Stop;
+}
+
+
+/**
+ *  @brief Default value provider which writes 42, and counts its calls.
+ *  @param [in] dest Destination
+ *  @param [in] size Destination size
+ *  @param [in] ctx  Call counter
+ *  @return Execution status
+ */
+static int countingProvider(void *dest, size_t size, void *ctx)
+{
+    (*(int *) ctx)++;
+    if(size != sizeof(int))
+        return 1;
+
+    *(int *) dest = 42;
+    return 0;
+}
+
@@ -0,0 +1,314 @@
+/**
+ *  @file      test_cache.c
+ *  @brief     Unit tests of the on-disk parse cache.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Structs */
+/**
+ *  @brief Context of the JSON loader.
+ */
+typedef struct LoadCtx_
+{
+    const char *path;       ///< Config file
+    unsigned int loads;     ///< Number of the calls
+} LoadCtx;
+
+
+/* Variables */
+static int level;   ///< Variable of the parameter
+
+
+/* Signatures */
+static int countLoads(ArgParser *obj, void *ctx);
+static int loadConfig(ArgParser *obj, void *ctx);
+static unsigned int parseCounted(char *lOpt, double max, const char *alias);
+static unsigned int parseDeps(LoadCtx *ctx, char **argv, int argc);
+static void writeConfig(const char *path, const char *text, const struct timespec *mtime);
+static void testDeps(const char *dir);
+static void testRest(void);
+static void removeDir(const char *dir);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the on-disk parse cache.
+ */
+void Test_cache(void)
+{
+    char dir[] = "/tmp/arg_parser_test_XXXXXX";
+    char sub[64];
+
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+    const char *saved = getenv("XDG_RUNTIME_DIR");
+    char *restore = (saved != NULL) ? strdup(saved) : NULL;
+    setenv("XDG_RUNTIME_DIR", dir, 1);
+
+    /* The same schema hits. */
+    TEST_ASSERT(parseCounted("--level", 9, NULL) == 1);
+    TEST_ASSERT(parseCounted("--level", 9, NULL) == 0);
+
+    /* A changed spelling, range or alias misses. */
+    TEST_ASSERT(parseCounted("--verbosity", 9, NULL) == 1);
+    TEST_ASSERT(parseCounted("--level", 5, NULL) == 1);
+    TEST_ASSERT(parseCounted("--level", 9, "--old-level") == 1);
+    TEST_ASSERT(parseCounted("--level", 9, "--old-level") == 0);
+
+    testDeps(dir);
+    testRest();
+
+    if(restore != NULL)
+        setenv("XDG_RUNTIME_DIR", restore, 1);
+    else
+        unsetenv("XDG_RUNTIME_DIR");
+    free(restore);
+
+    snprintf(sub, sizeof(sub), "%s/argparser", dir);
+    removeDir(sub);
+    rmdir(dir);
+}
+
+
+/**
+ *  @brief Parse through the cache with a schema, and count the loader calls. (The misses)
+ *  @param [in] lOpt  Long option of the parameter
+ *  @param [in] max   Maximum value of the parameter
+ *  @param [in] alias Alias of the parameter, or NULL
+ *  @return Number of the loader calls
+ */
+static unsigned int parseCounted(char *lOpt, double max, const char *alias)
+{
+    char *argv[] = { "test", NULL };
+    unsigned int loads = 0;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", lOpt, "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_setRange(obj, "level", 0, max) == 0);
+    if(alias != NULL)
+        TEST_ASSERT(ArgParser_addAlias(obj, "level", alias) == 0);
+
+    TEST_ASSERT(ArgParser_enableParseCache(obj, NULL, NULL) == 0);
+    TEST_ASSERT(ArgParser_parseCached(obj, 1, argv, countLoads, &loads) == 0);
+    TEST_ASSERT(level == 7);
+
+    ArgParser_delete(obj);
+    return loads;
+}
+
+
+/**
+ *  @brief Run the tests of the dependencies: a change of the identity or the modification
+ *         time of a config file, or of a tracked environment variable, misses.
+ *  @param [in] dir Temporary directory
+ */
+static void testDeps(const char *dir)
+{
+    char *argv[] = { "test", NULL };
+    char path[64], tmpPath[64];
+    struct stat st;
+    LoadCtx ctx;
+
+    snprintf(path, sizeof(path), "%s/config.json", dir);
+    snprintf(tmpPath, sizeof(tmpPath), "%s/config.json.new", dir);
+    ctx.path = path;
+    unsetenv("ARGPARSER_TEST_CACHE");
+
+    writeConfig(path, "{\"level\": 3}", NULL);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+    TEST_ASSERT(level == 3);
+
+    /* A new modification time misses, with the same size. */
+    TEST_ASSERT(stat(path, &st) == 0);
+    struct timespec mtime = st.st_mtim;
+    mtime.tv_sec -= 10;
+    writeConfig(path, "{\"level\": 4}", &mtime);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    TEST_ASSERT(level == 4);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+
+    /* So does a new file renamed over it, with the same size and modification time. */
+    writeConfig(tmpPath, "{\"level\": 5}", &mtime);
+    TEST_ASSERT(rename(tmpPath, path) == 0);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    TEST_ASSERT(level == 5);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+    TEST_ASSERT(level == 5);
+
+    /* A tracked environment variable misses when set, changed or unset. */
+    setenv("ARGPARSER_TEST_CACHE", "a", 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+    setenv("ARGPARSER_TEST_CACHE", "b", 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    setenv("ARGPARSER_TEST_CACHE", "", 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+    unsetenv("ARGPARSER_TEST_CACHE");
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+
+    // An untracked one does not.
+    setenv("ARGPARSER_TEST_UNTRACKED", "x", 1);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 0);
+    unsetenv("ARGPARSER_TEST_UNTRACKED");
+
+    /* A missing file misses. */
+    unlink(path);
+    TEST_ASSERT(parseDeps(&ctx, argv, 1) == 1);
+}
+
+
+/**
+ *  @brief Run the tests of the leftover arguments restored by a hit.
+ *         They point into the argv of the hit, by their indices.
+ */
+static void testRest(void)
+{
+    char *first[] = { "test", "x", "--unknown", "y", "--", "x", NULL };
+    char *second[] = { "test", "x", "--unknown", "y", "--", "x", NULL };
+    int restNum;
+    char **rest;
+    unsigned int loads = 0;
+    int i;
+
+    // Equal strings at other addresses: the hit must not look them up by content.
+    second[1] = strdup("x");
+    second[5] = strdup("x");
+
+    for(i = 0; i < 2; i++)
+    {
+        char **argv = (i == 0) ? first : second;
+
+        ArgParser *obj = ArgParser_new("test", "Test.");
+        TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+        TEST_ASSERT(ArgParser_collectRest(obj, true) == 0);
+        TEST_ASSERT(ArgParser_enableParseCache(obj, NULL, NULL) == 0);
+        TEST_ASSERT(ArgParser_parseCached(obj, 6, argv, countLoads, &loads) == 0);
+        TEST_ASSERT(ArgParser_rest(obj, &restNum, &rest) == 0);
+        TEST_ASSERT((restNum == 4) && (rest[0] == argv[1]) && (rest[1] == argv[2]) && (rest[2] == argv[3]) && (rest[3] == argv[5]));
+        ArgParser_delete(obj);
+    }
+    TEST_ASSERT(loads == 1);
+
+    free(second[1]);
+    free(second[5]);
+}
+
+
+/**
+ *  @brief Parse through the cache with the config file and the environment variable as
+ *         dependencies, and count the loader calls. (The misses)
+ *  @param [in] ctx  Loader context
+ *  @param [in] argv Command line argument array
+ *  @param [in] argc Number of command line arguments
+ *  @return Number of the loader calls
+ */
+static unsigned int parseDeps(LoadCtx *ctx, char **argv, int argc)
+{
+    const char *envNames[] = { "ARGPARSER_TEST_CACHE", NULL };
+    const char *paths[] = { ctx->path, NULL };
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_enableParseCache(obj, envNames, paths) == 0);
+
+    ctx->loads = 0;
+    TEST_ASSERT(ArgParser_parseCached(obj, argc, argv, loadConfig, ctx) == 0);
+
+    ArgParser_delete(obj);
+    return ctx->loads;
+}
+
+
+/**
+ *  @brief Write a config file.
+ *  @param [in] path  File path
+ *  @param [in] text  Contents
+ *  @param [in] mtime Modification time, or NULL
+ */
+static void writeConfig(const char *path, const char *text, const struct timespec *mtime)
+{
+    FILE *fp = fopen(path, "w");
+    TEST_ASSERT(fp != NULL);
+    if(fp == NULL)
+        return;
+
+    fputs(text, fp);
+    fclose(fp);
+
+    if(mtime != NULL)
+    {
+        struct timespec times[2] = { *mtime, *mtime };
+        TEST_ASSERT(utimensat(AT_FDCWD, path, times, 0) == 0);
+    }
+}
+
+
+/**
+ *  @brief Config loader which loads the JSON file if it exists, and counts its calls.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Loader context
+ *  @return Execution status
+ */
+static int loadConfig(ArgParser *obj, void *ctx)
+{
+    LoadCtx *load = (LoadCtx *) ctx;
+
+    load->loads++;
+    if(access(load->path, F_OK) != 0)
+        return 0;
+    return ArgParser_loadJson(obj, load->path);
+}
+
+
+/**
+ *  @brief Config loader which only counts its calls.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Call counter
+ *  @return Execution status
+ */
+static int countLoads(ArgParser *obj, void *ctx)
+{
+    (void) obj;
+    (*(unsigned int *) ctx)++;
+    return 0;
+}
+
+
+/**
+ *  @brief Remove a directory of files.
+ *  @param [in] dir Directory
+ */
+static void removeDir(const char *dir)
+{
+    char path[512];
+    struct dirent *ent;
+
+    DIR *dp = opendir(dir);
+    if(dp == NULL)
+        return;
+
+    while((ent = readdir(dp)) != NULL)
+    {
+        if(ent->d_name[0] == '.')
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(dp);
+    rmdir(dir);
+}
+
@@ -0,0 +1,59 @@
+/**
+ *  @file      test_clone.c
+ *  @brief     Unit tests of the schema clones.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Functions */
+/**
+ *  @brief Run the tests of the schema clones.
+ */
+void Test_clone(void)
+{
+    char *given[] = { "test", "--level", "3", NULL };
+    char *empty[] = { "test", NULL };
+    int level, value;
+
+    ArgParser *schema = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(schema, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_setLazy(schema, true) == 0);
+
+    ArgParser *first = ArgParser_clone(schema);
+    ArgParser *second = ArgParser_clone(schema);
+    TEST_ASSERT((first != NULL) && (second != NULL));
+
+    /* The pending value of a clone survives the parse of another one. */
+    TEST_ASSERT(ArgParser_parse(first, 3, given) == 0);
+    TEST_ASSERT(ArgParser_parse(second, 1, empty) == 0);
+    TEST_ASSERT(ArgParser_getInt(first, "level", &value) == 0);
+    TEST_ASSERT(value == 3);
+
+    /* The default values and the errors are per clone. */
+    TEST_ASSERT(ArgParser_setDefault(second, "level", "5") == 0);
+    TEST_ASSERT(ArgParser_parse(first, 1, empty) == 0);
+    TEST_ASSERT(level == 7);
+    TEST_ASSERT(ArgParser_parse(second, 1, empty) == 0);
+    TEST_ASSERT(level == 5);
+
+    TEST_ASSERT(ArgParser_getInt(second, "unknown", &value) == 1);
+    TEST_ASSERT(strcmp(ArgParser_getErrorMsg(first), "OK.") == 0);
+
+    /* The shared schema is read-only, and outlives the owner. */
+    TEST_ASSERT(ArgParser_addInt(first, &value, 0, "-x", "--extra", "extra", "Extra.") == 1);
+    ArgParser_delete(schema);
+    TEST_ASSERT(ArgParser_parse(second, 3, given) == 0);
+    TEST_ASSERT(ArgParser_getInt(second, "level", &value) == 0);
+    TEST_ASSERT(value == 3);
+
+    ArgParser_delete(first);
+    ArgParser_delete(second);
+}
+
@@ -0,0 +1,295 @@
+/**
+ *  @file      test_config.c
+ *  @brief     Unit tests of the config file loaders.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+static void writeFile(const char *path, const char *text);
+static bool loadString(ArgParser *obj, const char *path, size_t pad, const char *escaped, const char *expected, char *dest);
+static void testJson(void);
+static void testJsonSyntax(void);
+static void testConf(void);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the config file loaders.
+ */
+void Test_config(void)
+{
+    testJson();
+    testJsonSyntax();
+    testConf();
+}
+
+
+/**
+ *  @brief Run the tests of the JSON loader.
+ */
+static void testJson(void)
+{
+    char *argv[] = { "test", NULL };
+    char path[] = "/tmp/arg_parser_test_XXXXXX";
+    int level;
+    bool quiet;
+
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(obj, &quiet, "-q", "--quiet", "quiet", "Quiet.") == 0);
+
+    /* A negated key sets the opposite value. */
+    writeFile(path, "{\"level\": 3, \"no-quiet\": false}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 3) && (quiet == true));
+
+    /* An unknown key fails the load, and the values before it are undone. */
+    writeFile(path, "{\"level\": 5, \"no-quiet\": true, \"unknown\": 1}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Unknown option 'unknown'") != NULL);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 3) && (quiet == true));
+
+    /* So does an invalid value. */
+    writeFile(path, "{\"level\": 5, \"quiet\": \"x\"}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT(level == 3);
+
+    /* The unknown keys can be skipped. */
+    writeFile(path, "{\"level\": 5, \"no-quiet\": true, \"unknown\": 1}");
+    TEST_ASSERT(ArgParser_setIgnoreUnknownConfig(obj, true) == 0);
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 5) && (quiet == false));
+
+    ArgParser_delete(obj);
+    unlink(path);
+}
+
+
+/**
+ *  @brief Run the tests of the JSON syntax: the strings and escapes across the 64-byte blocks
+ *         of the first stage, the nested objects, the arrays, the surrogate pairs, and the
+ *         malformed documents.
+ */
+static void testJsonSyntax(void)
+{
+    char *argv[] = { "test", NULL };
+    char path[] = "/tmp/arg_parser_test_XXXXXX";
+    char name[256], host[32];
+    int port, deep, level;
+    size_t i;
+
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addString(obj, name, "", sizeof(name), "-n", "--name", "name", "Name.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &port, 1, "", "--db.port", "port", "Port.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, host, "", sizeof(host), "", "--db.host", "host", "Host.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &deep, 2, "", "--a.b.c", "deep", "Deep.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 3, "-l", "--level", "level", "Level.") == 0);
+
+    /* The value starts at offset 10: each escape is placed across the block boundary at 64. */
+    TEST_ASSERT(loadString(obj, path, 53, "\\\"tail", "\"tail", name));             // '\\' at 63, '"' at 64
+    TEST_ASSERT(loadString(obj, path, 54, "\\\"tail", "\"tail", name));             // '\\' at 64
+    TEST_ASSERT(loadString(obj, path, 51, "\\\\\\\\\\\\\\\"x", "\\\\\\\"x", name));  // Odd run over the boundary
+    TEST_ASSERT(loadString(obj, path, 48, "\\\\\\\\\\\\", "\\\\\\", name));         // Even run, the quote at 64 closes
+    TEST_ASSERT(loadString(obj, path, 54, "", "", name));                               // Closing quote at 64
+    TEST_ASSERT(loadString(obj, path, 50, "\\u00e9\\n", "\xc3\xa9\n", name));         // \u across the boundary
+    TEST_ASSERT(loadString(obj, path, 117, "\\\"", "\"", name));                     // '\\' at 127, '"' at 128
+    TEST_ASSERT(loadString(obj, path, 150, "{}[],:", "{}[],:", name));                  // Structurals inside a string
+
+    /* Surrogate pairs are combined, and the lone surrogates fail. */
+    TEST_ASSERT(loadString(obj, path, 0, "\\ud83d\\ude00", "\xf0\x9f\x98\x80", name));
+    TEST_ASSERT(loadString(obj, path, 0, "\\uDBFF\\uDFFF", "\xf4\x8f\xbf\xbf", name));
+    TEST_ASSERT(loadString(obj, path, 0, "\\u0041\\u07ff", "A\xdf\xbf", name));
+    TEST_ASSERT(loadString(obj, path, 0, "\\ud83d", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\ud83dx", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\ud83d\\u0041", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\ude00", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\u12", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\u12g4", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\\x", NULL, name) == false);
+    TEST_ASSERT(loadString(obj, path, 0, "\t", NULL, name) == false);               // Raw control byte
+
+    /* The nested objects set the dotted options, and a path too long is unknown. */
+    writeFile(path, "{\"db\": {\"port\": 5432, \"host\": \"localhost\"}, \"a\": {\"b\": {\"c\": 9}, \"x\": {}}, \"level\": 4}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((port == 5432) && (strcmp(host, "localhost") == 0) && (deep == 9) && (level == 4));
+
+    writeFile(path, "{\"db\": {\"db\": {\"port\": 1}}}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Unknown option 'db.db.port'") != NULL);
+
+    char text[1024];
+    int len = snprintf(text, sizeof(text), "{");
+    for(i = 0; i < 40; i++)
+        len += snprintf(text + len, sizeof(text) - len, "\"key%02zu\": {", i);
+    TEST_ASSERT((size_t) len + 80 < sizeof(text));
+    snprintf(text + len, sizeof(text) - len, "}}");
+    writeFile(path, text);
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Too deep nesting") != NULL);
+
+    /* The arrays are skipped, with their brackets and strings, and the next members apply. */
+    writeFile(path, "{\"name\": [1, \"]\", [{\"level\": 7}], {}], \"level\": 5, \"db\": {\"host\": []}, \"a\": {\"b\": {\"c\": 6}}}");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 5) && (deep == 6) && (port == 5432) && (strcmp(host, "localhost") == 0));
+
+    /* Malformed documents fail, and leave the defaults as they were. */
+    static const char *malformed[] =
+    {
+        "[1, 2]",
+        "\"level\"",
+        "{",
+        "{\"level\": 1",
+        "{\"level\" 1}",
+        "{\"level\": 1,}",
+        "{\"level\": 1}}",
+        "{\"level\": 1} x",
+        "{\"level\": 1 2}",
+        "{level: 1}",
+        "{\"level\": \"1}",
+        "{\"level\": [1}",
+        "{\"level\": tru}",
+        "{\"level\": 1, \"db\": {\"port\": 2}",
+        "{\"level\": 1111111111111111111111111111111111111111111111111111111111111111111111}",
+        " ",
+    };
+    for(i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        writeFile(path, malformed[i]);
+        TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    }
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 5) && (port == 5432));
+
+    writeFile(path, "");
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    unlink(path);
+    TEST_ASSERT(ArgParser_loadJson(obj, path) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Cannot open") != NULL);
+
+    ArgParser_delete(obj);
+}
+
+
+/**
+ *  @brief Run the tests of the conf.d loader.
+ */
+static void testConf(void)
+{
+    char *argv[] = { "test", NULL };
+    char dir[] = "/tmp/arg_parser_test_XXXXXX";
+    char base[64], local[64];
+    const char *dirs[1];
+    int level;
+    bool quiet;
+
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+    dirs[0] = dir;
+    snprintf(base, sizeof(base), "%s/10-base.conf", dir);
+    snprintf(local, sizeof(local), "%s/20-local.conf", dir);
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(obj, &quiet, "-q", "--quiet", "quiet", "Quiet.") == 0);
+
+    /* A negated name sets the opposite value. */
+    writeFile(base, "level = 3\nno-quiet = 0\n");
+    TEST_ASSERT(ArgParser_loadConfDirs(obj, dirs, 1) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 3) && (quiet == true));
+
+    /* An unknown name fails the load, and the values of the earlier fragments are undone. */
+    writeFile(local, "no-quiet\nunknown = 1\n");
+    TEST_ASSERT(ArgParser_setDefault(obj, "level", "4") == 0);
+    TEST_ASSERT(ArgParser_loadConfDirs(obj, dirs, 1) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Unknown option 'unknown'") != NULL);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 4) && (quiet == true));
+
+    /* The unknown names can be skipped. */
+    TEST_ASSERT(ArgParser_setIgnoreUnknownConfig(obj, true) == 0);
+    TEST_ASSERT(ArgParser_loadConfDirs(obj, dirs, 1) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT((level == 3) && (quiet == false));
+
+    ArgParser_delete(obj);
+    unlink(base);
+    unlink(local);
+    rmdir(dir);
+}
+
+
+/**
+ *  @brief Load {"name": "<pad x><escaped>"}, and compare the value.
+ *  @param [in]  obj      ArgParser object (with --name)
+ *  @param [in]  path     File path
+ *  @param [in]  pad      Number of the padding characters
+ *  @param [in]  escaped  Escaped value after the padding
+ *  @param [in]  expected Expected value after the padding (NULL: any)
+ *  @param [out] dest     Destination of --name
+ *  @retval true  Loaded, and the value is as expected.
+ *  @retval false Otherwise.
+ */
+static bool loadString(ArgParser *obj, const char *path, size_t pad, const char *escaped, const char *expected, char *dest)
+{
+    char *argv[] = { "test", NULL };
+    char text[256];
+    size_t i;
+
+    int len = snprintf(text, sizeof(text), "{\"name\": \"%*s%s\"}", (int) pad, "", escaped);
+    if((len < 0) || ((size_t) len >= sizeof(text)))
+        return false;
+    memset(text + 10, 'x', pad);
+    writeFile(path, text);
+
+    if((ArgParser_loadJson(obj, path) != 0) || (ArgParser_parse(obj, 1, argv) != 0))
+        return false;
+
+    for(i = 0; i < pad; i++)
+    {
+        if(dest[i] != 'x')
+            return false;
+    }
+    return (expected == NULL) || (strcmp(dest + pad, expected) == 0);
+}
+
+
+/**
+ *  @brief Write a text file.
+ *  @param [in] path File path
+ *  @param [in] text Contents
+ */
+static void writeFile(const char *path, const char *text)
+{
+    FILE *fp = fopen(path, "w");
+    TEST_ASSERT(fp != NULL);
+    if(fp == NULL)
+        return;
+
+    fputs(text, fp);
+    fclose(fp);
+}
+
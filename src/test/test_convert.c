@@ -0,0 +1,90 @@
+/**
+ *  @file      test_convert.c
+ *  @brief     Unit tests of the value conversion and the validators.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+#include "test.h"
+
+/* Functions */
+/**
+ *  @brief Parse a single option.
+ *  @param [in] obj    ArgParser object
+ *  @param [in] option Option spelling
+ *  @param [in] value  Value
+ *  @return Execution status
+ */
+static int parseOne(ArgParser *obj, char *option, char *value)
+{
+    char *argv[] = { "test", option, value, NULL };
+    return ArgParser_parse(obj, 3, argv);
+}
+
+
+/**
+ *  @brief Run the tests of the value conversion and the validators.
+ */
+void Test_convert(void)
+{
+    int i;
+    unsigned int u;
+    int32_t i32;
+    uint32_t u32;
+    char name[16];
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &i, 0, "-i", "--int", "int", "Int.") == 0);
+    TEST_ASSERT(ArgParser_addUInt(obj, &u, 0, "-u", "--uint", "uint", "UInt.") == 0);
+    TEST_ASSERT(ArgParser_addInt32(obj, &i32, 0, "-j", "--int32", "int32", "Int32.") == 0);
+    TEST_ASSERT(ArgParser_addUInt32(obj, &u32, 0, "-k", "--uint32", "uint32", "UInt32.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, name, "abc", sizeof(name), "-n", "--name", "name", "Name.") == 0);
+
+    /* The limits of the types are accepted. */
+    TEST_ASSERT((parseOne(obj, "--int", "-2147483648") == 0) && (i == INT32_MIN));
+    TEST_ASSERT((parseOne(obj, "--uint", "0xFFFFFFFF") == 0) && (u == UINT32_MAX));
+    TEST_ASSERT((parseOne(obj, "--int32", "2147483647") == 0) && (i32 == INT32_MAX));
+    TEST_ASSERT((parseOne(obj, "--uint32", "4294967295") == 0) && (u32 == UINT32_MAX));
+
+    /* The values out of the types are rejected, not truncated. */
+    TEST_ASSERT(parseOne(obj, "--int", "2147483648") == 1);
+    TEST_ASSERT(parseOne(obj, "--int", "0xFFFFFFFF") == 1);
+    TEST_ASSERT(parseOne(obj, "--int32", "-2147483649") == 1);
+    TEST_ASSERT(parseOne(obj, "--uint", "4294967296") == 1);
+    TEST_ASSERT(parseOne(obj, "--uint32", "99999999999999999999") == 1);
+    TEST_ASSERT(parseOne(obj, "--int", "") == 1);
+
+    /* A negative value of an unsigned type is rejected, not wrapped around. */
+    TEST_ASSERT(parseOne(obj, "--uint", "-1") == 1);
+    TEST_ASSERT(parseOne(obj, "--uint32", " -5") == 1);
+
+    /* The range is checked before the narrowing. */
+    TEST_ASSERT(ArgParser_setRange(obj, "uint32", 0, 100) == 0);
+    TEST_ASSERT(parseOne(obj, "--uint32", "4294967396") == 1);
+    TEST_ASSERT((parseOne(obj, "--uint32", "100") == 0) && (u32 == 100));
+
+    /* The default values go through the validators too. */
+    TEST_ASSERT(ArgParser_setLength(obj, "name", 2, 4) == 0);
+    TEST_ASSERT(ArgParser_setCharset(obj, "name", "a-z") == 0);
+    TEST_ASSERT(ArgParser_setDefault(obj, "name", "toolong") == 1);
+    TEST_ASSERT(ArgParser_setDefault(obj, "name", "AB") == 1);
+    TEST_ASSERT(ArgParser_setDefault(obj, "uint32", "101") == 1);
+    TEST_ASSERT(ArgParser_setDefault(obj, "uint", "-1") == 1);
+    TEST_ASSERT(ArgParserConfig_apply(obj, "--name", "x") == 1);
+    TEST_ASSERT(ArgParserConfig_apply(obj, "--uint32", "500") == 1);
+
+    TEST_ASSERT(ArgParser_setDefault(obj, "name", "ok") == 0);
+    TEST_ASSERT(ArgParserConfig_apply(obj, "--uint32", "50") == 0);
+    TEST_ASSERT(parseOne(obj, "--int", "1") == 0);
+    TEST_ASSERT((strcmp(name, "ok") == 0) && (u32 == 50));
+
+    ArgParser_delete(obj);
+}
+
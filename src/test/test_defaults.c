@@ -0,0 +1,130 @@
+/**
+ *  @file      test_defaults.c
+ *  @brief     Unit tests of the default values and their providers.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+static int failingProvider(void *dest, size_t size, void *ctx);
+static int fixedProvider(void *dest, size_t size, void *ctx);
+static int levelModule(ArgParser *obj, void *ctx);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the default values and their providers.
+ */
+void Test_defaults(void)
+{
+    char *argv[] = { "test", "--level", "3", NULL };
+    int level, calls;
+
+    /* A failing provider leaves the static default value. */
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "level", failingProvider, &calls) == 0);
+
+    calls = 0;
+    level = 99;
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT(calls == 1);
+    TEST_ASSERT(level == 7);
+
+    /* An override of the object is the default value under the provider. */
+    TEST_ASSERT(ArgParser_setDefault(obj, "level", "5") == 0);
+    level = 99;
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT(level == 5);
+
+    /* The provider does not run for a given option. */
+    calls = 0;
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(calls == 0);
+    TEST_ASSERT(level == 3);
+    ArgParser_delete(obj);
+
+    /* A successful provider replaces the default value. */
+    obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "level", fixedProvider, NULL) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv) == 0);
+    TEST_ASSERT(level == 42);
+    ArgParser_delete(obj);
+
+    /* A name shared by two modules does not select either of them. */
+    int levels[2];
+    obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addModule(obj, "first", levelModule, &(levels[0])) == 0);
+    TEST_ASSERT(ArgParser_addModule(obj, "second", levelModule, &(levels[1])) == 0);
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "level", fixedProvider, NULL) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Ambiguous") != NULL);
+    TEST_ASSERT(ArgParser_setDefault(obj, "level", "1") == 1);
+    ArgParser_delete(obj);
+
+    /* So is a name shared by an option and a positional parameter. */
+    int file;
+    obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-f", "--file", "file", "File number.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &file, 0, NULL, NULL, "file", "File.") == 0);
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "file", fixedProvider, NULL) == 1);
+    ArgParser_delete(obj);
+}
+
+
+/**
+ *  @brief Default value provider which fails without writing.
+ *  @param [in] dest Destination
+ *  @param [in] size Destination size
+ *  @param [in] ctx  Call counter
+ *  @return Execution status
+ */
+static int failingProvider(void *dest, size_t size, void *ctx)
+{
+    (void) dest;
+    (void) size;
+    (*(int *) ctx)++;
+    return 1;
+}
+
+
+/**
+ *  @brief Default value provider which writes 42.
+ *  @param [in] dest Destination
+ *  @param [in] size Destination size
+ *  @param [in] ctx  Unused
+ *  @return Execution status
+ */
+static int fixedProvider(void *dest, size_t size, void *ctx)
+{
+    (void) ctx;
+    if(size != sizeof(int))
+        return 1;
+
+    *(int *) dest = 42;
+    return 0;
+}
+
+
+/**
+ *  @brief Module with a parameter named "level", under its own spelling.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Destination
+ *  @return Execution status
+ */
+static int levelModule(ArgParser *obj, void *ctx)
+{
+    static unsigned int num;
+    char spelling[32];
+
+    snprintf(spelling, sizeof(spelling), "--level-%u", num++);
+    return ArgParser_addInt(obj, (int *) ctx, 0, NULL, spelling, "level", "Level.");
+}
+
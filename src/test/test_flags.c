@@ -0,0 +1,100 @@
+/**
+ *  @file      test_flags.c
+ *  @brief     Unit tests of the flags bound to bits.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Macros */
+#define BIT(n)  ((uint64_t) 1 << (n))
+
+
+/* Signatures */
+static int setProvider(void *dest, size_t size, void *ctx);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the flags bound to bits.
+ */
+void Test_flags(void)
+{
+    uint64_t words[2];
+    bool value;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addBoolBit(obj, words, 0, true, "-j", "--jit", "jit", "JIT.") == 0);
+    TEST_ASSERT(ArgParser_addTrueBit(obj, words, 5, "-s", "--simd", "simd", "SIMD.") == 0);
+    TEST_ASSERT(ArgParser_addTrueBit(obj, words, 64 + 5, "", "--trace", "trace", "Trace.") == 0);
+    TEST_ASSERT(ArgParser_addTrueBit(obj, words, 6, "", "--probe", "probe", "Probe.") == 0);
+
+    /* A bit holds one flag: the same word and bit is rejected, whichever the kind. */
+    TEST_ASSERT(ArgParser_addTrueBit(obj, words, 5, "", "--vector", "vector", "Vector.") == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "simd") != NULL);
+    TEST_ASSERT(ArgParser_addBoolBit(obj, words, 64 + 5, false, "", "--log", "log", "Log.") == 1);
+    TEST_ASSERT(ArgParser_addBoolBit(obj, &(words[1]), 5, false, "", "--log", "log", "Log.") == 1);
+
+    /* The defaults are written into their bits, and the other bits are kept. */
+    char *argv0[] = { "test", NULL };
+    words[0] = 0xF000;
+    words[1] = BIT(0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv0) == 0);
+    TEST_ASSERT(words[0] == (0xF000 | BIT(0)));
+    TEST_ASSERT(words[1] == BIT(0));
+
+    /* Set, cleared by "--no-", and given a value. */
+    char *argv1[] = { "test", "-s", "--trace", "--no-jit", "--probe", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 5, argv1) == 0);
+    TEST_ASSERT(words[0] == (0xF000 | BIT(5) | BIT(6)));
+    TEST_ASSERT(words[1] == (BIT(0) | BIT(5)));
+    TEST_ASSERT((ArgParser_getBool(obj, "jit", &value) == 0) && (value == false));
+    TEST_ASSERT((ArgParser_getBool(obj, "simd", &value) == 0) && (value == true));
+
+    char *argv2[] = { "test", "--jit", "1", "--no-probe", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 4, argv2) == 0);
+    TEST_ASSERT(words[0] == (0xF000 | BIT(0)));
+    TEST_ASSERT(words[1] == BIT(0));
+
+    /* The default values set on the object, and the providers writing a bool. */
+    TEST_ASSERT(ArgParser_setDefault(obj, "jit", "0") == 0);
+    TEST_ASSERT(ArgParser_setDefault(obj, "probe", "1") == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv0) == 0);
+    TEST_ASSERT(words[0] == (0xF000 | BIT(6)));
+
+    bool provided = true;
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "trace", setProvider, &provided) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv0) == 0);
+    TEST_ASSERT(words[1] == (BIT(0) | BIT(5)));
+    TEST_ASSERT(ArgParser_parse(obj, 2, (char *[]) { "test", "--trace", NULL }) == 0);
+    TEST_ASSERT(words[1] == (BIT(0) | BIT(5)));
+    provided = false;
+    TEST_ASSERT(ArgParser_parse(obj, 1, argv0) == 0);
+    TEST_ASSERT(words[1] == BIT(0));
+
+    ArgParser_delete(obj);
+}
+
+
+/**
+ *  @brief Default value provider which writes a bool.
+ *  @param [in] dest Destination
+ *  @param [in] size Destination size
+ *  @param [in] ctx  Value
+ *  @return Execution status
+ */
+static int setProvider(void *dest, size_t size, void *ctx)
+{
+    if(size != sizeof(bool))
+        return 1;
+
+    *(bool *) dest = *(bool *) ctx;
+    return 0;
+}
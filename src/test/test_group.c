@@ -0,0 +1,171 @@
+/**
+ *  @file      test_group.c
+ *  @brief     Unit tests of the option groups bound to structs.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Structs */
+/**
+ *  @brief Struct of the group "db.pool".
+ */
+typedef struct Pool_
+{
+    int    size;     ///< --db.pool.size
+    double timeout;  ///< --db.pool.timeout
+} Pool;
+
+/**
+ *  @brief Struct of the group "db".
+ */
+typedef struct Db_
+{
+    int      level;  ///< --db.level
+    char     name[16]; ///< --db.name
+    uint64_t flags;  ///< --db.trace (bit 3)
+    Pool     pool;   ///< Nested struct of "db.pool"
+} Db;
+
+
+/* Signatures */
+static int parseArgs(ArgParser *obj, const char *a0, const char *a1);
+static char *dumpToString(ArgParser *obj, const char *path, int *status);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the option groups bound to structs.
+ */
+void Test_group(void)
+{
+    Db db1, db2, defaults;
+    Pool pool, other;
+    int outside;
+    char *out;
+    int status;
+
+    /* A subgroup bound to a struct of its own stays there when the parent is bound again. */
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db1, sizeof(db1)) == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &db1.level, 1, "", "--db.level", "db.level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db.pool", &pool, sizeof(pool)) == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &pool.size, 4, "", "--db.pool.size", "db.pool.size", "Size.") == 0);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db2, sizeof(db2)) == 0);
+    db1.level = -1;
+    TEST_ASSERT(parseArgs(obj, "--db.pool.size", "5") == 0);
+    TEST_ASSERT(pool.size == 5);
+    TEST_ASSERT((db2.level == 1) && (db1.level == -1));
+    TEST_ASSERT(parseArgs(obj, "--db.level", "3") == 0);
+    TEST_ASSERT((db2.level == 3) && (pool.size == 4));
+
+    /* Binding the subgroup again moves only its own fields. */
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db.pool", &other, sizeof(other)) == 0);
+    TEST_ASSERT(parseArgs(obj, "--db.pool.size", "6") == 0);
+    TEST_ASSERT((other.size == 6) && (pool.size == 4));
+
+    /* A destination outside the bound struct is rejected, when added and when bound. */
+    TEST_ASSERT(ArgParser_addInt(obj, &outside, 0, "", "--db.outside", "db.outside", "Outside.") == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "--db.outside") != NULL);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db2, sizeof(int)) == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &db2.pool.size, 0, "", "--db.size", "db.size", "Size.") == 1);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db1, sizeof(db1)) == 0);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &outside, sizeof(char)) == 1);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", NULL, sizeof(db1)) == 1);
+    TEST_ASSERT(parseArgs(obj, "--db.level", "8") == 0);
+    TEST_ASSERT(db1.level == 8);
+    ArgParser_delete(obj);
+
+    /* A subgroup bound to a nested struct moves with the parent, and takes the defaults from it. */
+    memset(&db1, 0, sizeof(db1));
+    memset(&db2, 0, sizeof(db2));
+    obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &db1.level, 1, "", "--db.level", "db.level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, db1.name, "main", sizeof(db1.name), "", "--db.name", "db.name", "Name.") == 0);
+    TEST_ASSERT(ArgParser_addTrueBit(obj, &db1.flags, 3, "", "--db.trace", "db.trace", "Trace.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &db1.pool.size, 4, "", "--db.pool.size", "db.pool.size", "Size.") == 0);
+    TEST_ASSERT(ArgParser_addDouble(obj, &db1.pool.timeout, 1.5, "", "--db.pool.timeout", "db.pool.timeout", "Timeout.") == 0);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db1, sizeof(db1)) == 0);
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db.pool", &db1.pool, sizeof(db1.pool)) == 0);
+    TEST_ASSERT(parseArgs(obj, "--db.trace", NULL) == 0);
+    TEST_ASSERT((db1.flags == ((uint64_t) 1 << 3)) && (db1.pool.size == 4));
+    memset(&db1, 0xff, sizeof(db1));
+    TEST_ASSERT(ArgParser_bindGroup(obj, "db", &db2, sizeof(db2)) == 0);
+    TEST_ASSERT(parseArgs(obj, "--db.pool.size", "9") == 0);
+    TEST_ASSERT((db2.pool.size == 9) && (db2.pool.timeout == 1.5) && (strcmp(db2.name, "main") == 0));
+    TEST_ASSERT(parseArgs(obj, "--db.trace", NULL) == 0);
+    TEST_ASSERT((db2.flags == ((uint64_t) 1 << 3)) && (db2.pool.size == 4));
+    TEST_ASSERT((db1.flags == UINT64_MAX) && (db1.pool.size == -1) && (db1.level == -1));
+
+    memset(&defaults, 0, sizeof(defaults));
+    defaults.level        = 2;
+    defaults.flags        = (uint64_t) 1 << 3;
+    defaults.pool.size    = 16;
+    defaults.pool.timeout = 0.25;
+    strcpy(defaults.name, "replica");
+    TEST_ASSERT(ArgParser_setGroupDefaults(obj, "db", &defaults) == 0);
+    TEST_ASSERT(parseArgs(obj, "--db.level", "7") == 0);
+    TEST_ASSERT((db2.level == 7) && (db2.pool.size == 16) && (db2.pool.timeout == 0.25));
+    TEST_ASSERT((strcmp(db2.name, "replica") == 0) && ((db2.flags >> 3) & 1));
+
+    /* The subtree is printed, a line for each parameter. */
+    out = dumpToString(obj, "db.pool", &status);
+    TEST_ASSERT(status == 0);
+    TEST_ASSERT(strcmp(out, "db.pool.size = 16\ndb.pool.timeout = 0.25\n") == 0);
+    free(out);
+    out = dumpToString(obj, "db", &status);
+    TEST_ASSERT(status == 0);
+    TEST_ASSERT(strcmp(out, "db.level = 7\ndb.name = \"replica\"\ndb.trace = 1\ndb.pool.size = 16\ndb.pool.timeout = 0.25\n") == 0);
+    free(out);
+
+    /* Unknown or unbound groups fail. */
+    out = dumpToString(obj, "cache", &status);
+    TEST_ASSERT(status == 1);
+    free(out);
+    TEST_ASSERT(ArgParser_setGroupDefaults(obj, "cache", &defaults) == 1);
+    TEST_ASSERT(ArgParser_addInt(obj, &outside, 0, "", "--cache.size", "cache.size", "Size.") == 0);
+    TEST_ASSERT(ArgParser_setGroupDefaults(obj, "cache", &defaults) == 1);
+    ArgParser_delete(obj);
+}
+
+
+/**
+ *  @brief Parse an option and its value.
+ *  @param [in] obj ArgParser object
+ *  @param [in] a0  Option
+ *  @param [in] a1  Value, or NULL
+ *  @return Execution status
+ */
+static int parseArgs(ArgParser *obj, const char *a0, const char *a1)
+{
+    char *argv[] = { "test", (char *) a0, (char *) a1, NULL };
+    return ArgParser_parse(obj, (a1 != NULL) ? 3 : 2, argv);
+}
+
+
+/**
+ *  @brief Print a group subtree into a string.
+ *  @param [in]  obj    ArgParser object
+ *  @param [in]  path   Group path
+ *  @param [out] status Status of ArgParser_dumpGroup()
+ *  @return Output (free() it)
+ */
+static char *dumpToString(ArgParser *obj, const char *path, int *status)
+{
+    char *buf = NULL;
+    size_t len = 0;
+
+    FILE *fp = open_memstream(&buf, &len);
+    *status = ArgParser_dumpGroup(obj, fp, path);
+    fclose(fp);
+
+    return buf;
+}
@@ -0,0 +1,82 @@
+/**
+ *  @file      test_help.c
+ *  @brief     Unit tests of the help layout and the help search.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+#include "test.h"
+
+/* Functions */
+/**
+ *  @brief Get the memory taken by the help search index.
+ *  @param [in] obj ArgParser object
+ *  @return Size in bytes
+ */
+static size_t searchIndexSize(ArgParser *obj)
+{
+    ArgParserMemUsage before, after;
+    FILE *fp = fopen("/dev/null", "w");
+
+    ArgParser_memoryUsage(obj, &before);
+    ArgParser_searchHelp(obj, fp, "log");
+    ArgParser_memoryUsage(obj, &after);
+    fclose(fp);
+
+    return after.helpCache - before.helpCache;
+}
+
+
+/**
+ *  @brief Run the tests of the help layout and the help search.
+ */
+void Test_help(void)
+{
+    char *text = NULL;
+    size_t len = 0;
+    int level;
+    bool quiet;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level of the log.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(obj, &quiet, "-q", "--quiet", "quiet", "Quiet.") == 0);
+
+    /* The cell of an option with a value shows its name, the one of a switch does not. */
+    FILE *mem = open_memstream(&text, &len);
+    TEST_ASSERT(ArgParser_printHelpWidth(obj, mem, 100) == 0);
+    fclose(mem);
+    TEST_ASSERT(strstr(text, "-l / --level <level> [int]") != NULL);
+    TEST_ASSERT(strstr(text, "-q / --quiet  ") != NULL);
+    free(text);
+
+    /* The search finds the words of the descriptions. */
+    mem = open_memstream(&text, &len);
+    TEST_ASSERT(ArgParser_searchHelp(obj, mem, "LOG") == 0);
+    fclose(mem);
+    TEST_ASSERT(strstr(text, "--level") != NULL);
+    TEST_ASSERT(strstr(text, "--quiet") == NULL);
+    free(text);
+
+    ArgParser_delete(obj);
+
+    /* The search index takes one entry per word, and the usage reports it. */
+    ArgParser *one = ArgParser_new("test", "Test.");
+    ArgParser *two = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(one, &level, 7, "-l", "--level", "level", "Level of the log.") == 0);
+    TEST_ASSERT(ArgParser_addInt(two, &level, 7, "-l", "--level", "level", "Level of the log.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(two, &quiet, "-q", "--quiet", "quiet", "Be quiet, very quiet.") == 0);
+
+    // quiet / be quiet very quiet / q / quiet: 7 words, 34 bytes with the NULs
+    TEST_ASSERT(searchIndexSize(two) - searchIndexSize(one) == 7 * sizeof(SearchEntry) + 34);
+
+    ArgParser_delete(one);
+    ArgParser_delete(two);
+}
+
@@ -0,0 +1,78 @@
+/**
+ *  @file      test_lazy.c
+ *  @brief     Unit tests of the lazy conversion mode.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+static int fixedProvider(void *dest, size_t size, void *ctx);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the lazy conversion mode.
+ */
+void Test_lazy(void)
+{
+    char *invalid[] = { "test", "--level", "abc", NULL };
+    char *outOfRange[] = { "test", "--level", "50", NULL };
+    char *valid[] = { "test", "--level", "3", NULL };
+    int level, value;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_setRange(obj, "level", 0, 10) == 0);
+    TEST_ASSERT(ArgParser_setLazy(obj, true) == 0);
+
+    /* The conversion runs on the first access. */
+    TEST_ASSERT(ArgParser_parse(obj, 3, valid) == 0);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 0);
+    TEST_ASSERT(value == 3);
+
+    /* A failed value is reported once, then the default value is kept. */
+    TEST_ASSERT(ArgParser_parse(obj, 3, invalid) == 0);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "level") != NULL);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 0);
+    TEST_ASSERT(value == 7);
+
+    TEST_ASSERT(ArgParser_parse(obj, 3, outOfRange) == 0);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 1);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 0);
+    TEST_ASSERT(value == 7);
+
+    /* The parameter is unset again, so its provider runs. */
+    TEST_ASSERT(ArgParser_setDefaultProvider(obj, "level", fixedProvider, NULL) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, invalid) == 0);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 1);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 0);
+    TEST_ASSERT(value == 5);
+    ArgParser_delete(obj);
+}
+
+
+/**
+ *  @brief Default value provider which writes 5.
+ *  @param [in] dest Destination
+ *  @param [in] size Destination size
+ *  @param [in] ctx  Unused
+ *  @return Execution status
+ */
+static int fixedProvider(void *dest, size_t size, void *ctx)
+{
+    (void) ctx;
+    if(size != sizeof(int))
+        return 1;
+
+    *(int *) dest = 5;
+    return 0;
+}
+
@@ -0,0 +1,102 @@
+/**
+ *  @file      test_main.c
+ *  @brief     Unit test main function.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+
+/* Structs */
+/**
+ *  @brief Test suite definition
+ */
+typedef struct TestDef_
+{
+    const char *name;       ///< Suite name
+    void (*run)(void);      ///< Suite function
+} TestDef;
+
+
+/* Variables */
+static const TestDef testDefs[] =
+{
+    { "defaults",  Test_defaults  },
+    { "lazy",      Test_lazy      },
+    { "clone",     Test_clone     },
+    { "module",    Test_module    },
+    { "telemetry", Test_telemetry },
+    { "help",      Test_help      },
+    { "action",    Test_action    },
+    { "convert",   Test_convert   },
+    { "config",    Test_config    },
+    { "cache",     Test_cache     },
+    { "group",     Test_group     },
+    { "flags",     Test_flags     },
+    { "plan",      Test_plan      },
+    { "namespace", Test_namespace },
+    { "utf8",      Test_utf8      },
+    { "memory",    Test_memory    },
+    { "trace",     Test_trace     },
+};
+
+static unsigned int numChecks;   ///< Number of checks
+static unsigned int numFailures; ///< Number of failed checks
+
+
+/* Functions */
+/**
+ *  @brief Record the result of a check.
+ *  @param [in] ok   Result
+ *  @param [in] expr Checked expression
+ *  @param [in] file Source file
+ *  @param [in] line Source line
+ *  @return Result
+ */
+bool Test_check(bool ok, const char *expr, const char *file, int line)
+{
+    numChecks++;
+    if(ok == false)
+    {
+        numFailures++;
+        fprintf(stderr, "%s:%d: Failed: %s\n", file, line, expr);
+    }
+
+    return ok;
+}
+
+
+/**
+ *  @brief Main function
+ *         Runs all suites, or the suites given by name.
+ *  @param [in] argc     Number of command line arguments
+ *  @param [in] argv[]   Command line argument array
+ *  @return   Execution status
+ */
+int main(int argc, char *argv[])
+{
+    unsigned int numDefs = sizeof(testDefs) / sizeof(testDefs[0]);
+    unsigned int i;
+    int j;
+
+    for(i = 0; i < numDefs; i++)
+    {
+        bool selected = (argc < 2);
+        for(j = 1; j < argc; j++)
+            selected = selected || (strcmp(argv[j], testDefs[i].name) == 0);
+        if(selected == false)
+            continue;
+
+        unsigned int failures = numFailures;
+        testDefs[i].run();
+        printf("%-10s : %s\n", testDefs[i].name, (numFailures == failures) ? "OK" : "FAILED");
+    }
+
+    printf("Info: %u checks, %u failures.\n", numChecks, numFailures);
+    return (numFailures == 0) ? 0 : 1;
+}
+
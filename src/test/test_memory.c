@@ -0,0 +1,128 @@
+/**
+ *  @file      test_memory.c
+ *  @brief     Unit tests of the memory usage and ArgParser_shrink().
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+static void testClones(void);
+static void testShrink(void);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the memory usage and ArgParser_shrink().
+ */
+void Test_memory(void)
+{
+    testClones();
+    testShrink();
+}
+
+
+/**
+ *  @brief Run the tests of the memory usage of the clones.
+ *         The shared schema is charged to its owner only.
+ */
+static void testClones(void)
+{
+    char *argv[] = { "test", "--level", "3", NULL };
+    ArgParserMemUsage owner, clone, nested;
+    int level;
+
+    ArgParser *schema = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(schema, &level, 7, "-l", "--level", "level", "Level of the log.") == 0);
+
+    ArgParser *first = ArgParser_clone(schema);
+    ArgParser *second = ArgParser_clone(first);
+    TEST_ASSERT((first != NULL) && (second != NULL));
+    TEST_ASSERT(ArgParser_parse(first, 3, argv) == 0);
+
+    TEST_ASSERT(ArgParser_memoryUsage(schema, &owner) == 0);
+    TEST_ASSERT(ArgParser_memoryUsage(first, &clone) == 0);
+    TEST_ASSERT(ArgParser_memoryUsage(second, &nested) == 0);
+
+    TEST_ASSERT((owner.shared == 0) && (owner.arena != 0) && (owner.index != 0) && (owner.help != 0));
+    TEST_ASSERT((clone.arena == 0) && (clone.arenaUsed == 0) && (clone.index == 0) && (clone.help == 0));
+    TEST_ASSERT((clone.tables != 0) && (clone.tables < owner.tables));
+    TEST_ASSERT(clone.shared == owner.tables - clone.tables + owner.arena + owner.index);
+    TEST_ASSERT(clone.total < owner.total);
+    TEST_ASSERT(clone.total == clone.object + clone.tables + clone.plans + clone.defaults + clone.helpCache);
+
+    // A clone of a clone borrows from the same owner.
+    TEST_ASSERT((nested.shared == clone.shared) && (nested.tables == clone.tables));
+
+    /* The overridden defaults are charged to the clone which holds them. */
+    TEST_ASSERT(ArgParser_setDefault(second, "level", "5") == 0);
+    TEST_ASSERT(ArgParser_memoryUsage(second, &nested) == 0);
+    TEST_ASSERT((nested.defaults != 0) && (nested.total > clone.total));
+
+    /* The shared schema cannot be released. */
+    TEST_ASSERT(ArgParser_shrink(first) == 1);
+    TEST_ASSERT(ArgParser_shrink(schema) == 1);
+
+    ArgParser_delete(second);
+    ArgParser_delete(first);
+    ArgParser_delete(schema);
+}
+
+
+/**
+ *  @brief Run the tests of ArgParser_shrink().
+ *         The destinations keep their values, and the later calls fail cleanly.
+ */
+static void testShrink(void)
+{
+    char *argv[] = { "test", "--level", "3", "--name", "abc", "-q", "in.txt", NULL };
+    ArgParserMemUsage before, after;
+    char name[16], file[16];
+    int level, value;
+    bool quiet;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, name, "none", sizeof(name), "-n", "--name", "name", "Name.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(obj, &quiet, "-q", "--quiet", "quiet", "Quiet.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, file, "", sizeof(file), NULL, NULL, "file", "File.") == 0);
+    TEST_ASSERT(ArgParser_setLazy(obj, true) == 0);
+    TEST_ASSERT(ArgParser_setDefault(obj, "name", "dflt") == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 7, argv) == 0);
+    TEST_ASSERT(ArgParser_memoryUsage(obj, &before) == 0);
+
+    /* The pending values of the lazy mode are converted, and the destinations keep them. */
+    TEST_ASSERT(ArgParser_shrink(obj) == 0);
+    TEST_ASSERT((level == 3) && (strcmp(name, "abc") == 0) && (quiet == true) && (strcmp(file, "in.txt") == 0));
+
+    TEST_ASSERT(ArgParser_memoryUsage(obj, &after) == 0);
+    TEST_ASSERT((after.tables == 0) && (after.arena == 0) && (after.index == 0) && (after.help == 0));
+    TEST_ASSERT((after.plans == 0) && (after.defaults == 0) && (after.helpCache == 0));
+    TEST_ASSERT(after.total == after.object);
+    TEST_ASSERT(after.total < before.total);
+
+    /* The later calls fail without touching the destinations. */
+    const char *msg = "The parameter definitions have been released by ArgParser_shrink().";
+    char *again[] = { "test", "--level", "9", NULL };
+    FILE *fp = fopen("/dev/null", "w");
+    TEST_ASSERT(ArgParser_parse(obj, 3, again) == 1);
+    TEST_ASSERT(strcmp(ArgParser_getErrorMsg(obj), msg) == 0);
+    TEST_ASSERT(ArgParser_getInt(obj, "level", &value) == 1);
+    TEST_ASSERT(ArgParser_setDefault(obj, "level", "1") == 1);
+    TEST_ASSERT(ArgParser_addInt(obj, &value, 0, "-x", "--extra", "extra", "Extra.") == 1);
+    TEST_ASSERT(ArgParser_printHelp(obj, fp) == 1);
+    TEST_ASSERT(ArgParser_clone(obj) == NULL);
+    TEST_ASSERT(strcmp(ArgParser_getErrorMsg(obj), msg) == 0);
+    TEST_ASSERT(level == 3);
+    fclose(fp);
+
+    // Shrinking again does nothing.
+    TEST_ASSERT(ArgParser_shrink(obj) == 0);
+    ArgParser_delete(obj);
+}
@@ -0,0 +1,102 @@
+/**
+ *  @file      test_module.c
+ *  @brief     Unit tests of the option modules.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Variables */
+static int extra;   ///< Variable of the module parameter
+
+
+/* Functions */
+/**
+ *  @brief Register a parameter, an alias and a range, then fail with a message.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Unused
+ *  @return Execution status
+ */
+static int addFailingModule(ArgParser *obj, void *ctx)
+{
+    (void) ctx;
+    ArgParser_addInt(obj, &extra, 0, "-x", "--extra", "extra", "Extra.");
+    ArgParser_addAlias(obj, "level", "--old-level");
+    ArgParser_setRange(obj, "level", 0, 5);
+    ArgParser_getInt(obj, "unknown", &extra);
+    return 1;
+}
+
+
+/**
+ *  @brief Fail without a message.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Unused
+ *  @return Execution status
+ */
+static int addSilentModule(ArgParser *obj, void *ctx)
+{
+    (void) obj;
+    (void) ctx;
+    return 1;
+}
+
+
+/**
+ *  @brief Succeed without registering anything.
+ *  @param [in] obj ArgParser object
+ *  @param [in] ctx Unused
+ *  @return Execution status
+ */
+static int addEmptyModule(ArgParser *obj, void *ctx)
+{
+    (void) obj;
+    (void) ctx;
+    return 0;
+}
+
+
+/**
+ *  @brief Run the tests of the option modules.
+ */
+void Test_module(void)
+{
+    char *high[] = { "test", "--level", "9", NULL };
+    char *old[]  = { "test", "--old-level", "3", NULL };
+    char *ext[]  = { "test", "--extra", "3", NULL };
+    int level;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, high) == 0);
+
+    /* A failed module leaves no parameter, alias or range behind, and keeps its own message. */
+    TEST_ASSERT(ArgParser_addModule(obj, "failing", addFailingModule, NULL) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Unknown parameter name") != NULL);
+    TEST_ASSERT(ArgParser_parse(obj, 3, ext) == 1);
+    TEST_ASSERT(ArgParser_parse(obj, 3, old) == 1);
+    TEST_ASSERT(ArgParser_parse(obj, 3, high) == 0);
+    TEST_ASSERT(level == 9);
+
+    /* The same names can be added again. */
+    TEST_ASSERT(ArgParser_addInt(obj, &extra, 0, "-x", "--extra", "extra", "Extra.") == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, ext) == 0);
+    TEST_ASSERT(extra == 3);
+
+    /* A module which fails silently gets a message. */
+    TEST_ASSERT(ArgParser_addModule(obj, "silent", addSilentModule, NULL) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Cannot add module 'silent'") != NULL);
+
+    /* A module which succeeds does not touch the earlier message. */
+    TEST_ASSERT(ArgParser_addModule(obj, "empty", addEmptyModule, NULL) == 0);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Cannot add module 'silent'") != NULL);
+
+    ArgParser_delete(obj);
+}
+
@@ -0,0 +1,227 @@
+/**
+ *  @file      test_namespace.c
+ *  @brief     Unit tests of the prefix namespaces, the leftover arguments and ArgParser_parseSelf().
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Macros */
+/**
+ *  @brief Environment variable which makes the suite the re-executed child of the parseSelf test.
+ */
+#define SELF_ENV    "ARGPARSER_TEST_PARSE_SELF"
+
+/**
+ *  @brief Length of the long argument of the parseSelf test. (Longer than the first read buffer)
+ */
+#define SELF_LONG   10000
+
+
+/* Structs */
+/**
+ *  @brief Destinations of the host and the namespaces.
+ */
+typedef struct Values_
+{
+    int  level;      ///< Host: -l/--level
+    char file[64];   ///< Host: positional
+    char dir[64];    ///< Storage: --storage-dir
+    bool sync;       ///< Storage: --storage-sync
+    int  size;       ///< Cache: --cache-size
+} Values;
+
+
+/* Signatures */
+static ArgParser *newHost(Values *v, ArgParser **storage, ArgParser **cache);
+static bool isRest(ArgParser *obj, int num, const char **expected);
+static void testParseSelf(void);
+static int runSelfChild(void);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the prefix namespaces, the leftover arguments and ArgParser_parseSelf().
+ */
+void Test_namespace(void)
+{
+    ArgParser *storage, *cache;
+    Values v;
+
+    if(getenv(SELF_ENV) != NULL)
+        _exit(runSelfChild());
+
+    ArgParser *obj = newHost(&v, &storage, &cache);
+
+    /* The options are routed to the schema of their prefix, with either value syntax. */
+    char *argv1[] = { "test", "--storage-dir", "/data", "--level", "2", "--cache-size=64", "--storage-sync", "in.txt", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 8, argv1) == 0);
+    TEST_ASSERT((strcmp(v.dir, "/data") == 0) && (v.sync == true) && (v.size == 64));
+    TEST_ASSERT((v.level == 2) && (strcmp(v.file, "in.txt") == 0));
+    TEST_ASSERT(isRest(obj, 0, NULL));
+
+    /* The next parse gives the namespaces their defaults again. */
+    char *argv2[] = { "test", "--storage-dir=/srv", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 2, argv2) == 0);
+    TEST_ASSERT((strcmp(v.dir, "/srv") == 0) && (v.sync == false) && (v.size == 16) && (v.level == 1));
+
+    /* Without the collection, an unknown option fails, in a namespace too. */
+    char *argv3[] = { "test", "--storage-bogus", "1", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv3) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "--storage-bogus") != NULL);
+    char *argv4[] = { "test", "a", "b", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv4) == 1);
+
+    /* With it, the leftovers are kept in order, and everything after "--" as is. */
+    TEST_ASSERT(ArgParser_collectRest(obj, true) == 0);
+    char *argv5[] = { "test", "--unknown", "in.txt", "--storage-bogus", "--cache-size", "8", "extra",
+                      "--", "--level", "9", "--", "-x", NULL };
+    const char *rest5[] = { "--unknown", "--storage-bogus", "extra", "--level", "9", "--", "-x" };
+    TEST_ASSERT(ArgParser_parse(obj, 12, argv5) == 0);
+    TEST_ASSERT(isRest(obj, 7, rest5));
+    TEST_ASSERT((v.level == 1) && (v.size == 8) && (strcmp(v.file, "in.txt") == 0));
+
+    char *argv6[] = { "test", "--", NULL };
+    TEST_ASSERT(ArgParser_parse(obj, 2, argv6) == 0);
+    TEST_ASSERT(isRest(obj, 0, NULL));
+
+    /* Invalid prefixes and schemas. */
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--storage", storage) == 1);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "-s-", storage) == 1);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--a-b-", storage) == 1);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--storage-", storage) == 1);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--self-", obj) == 1);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--none-", NULL) == 1);
+
+    ArgParser_delete(obj);
+    ArgParser_delete(storage);
+    ArgParser_delete(cache);
+
+    testParseSelf();
+}
+
+
+/**
+ *  @brief Create the host parser and its namespaces.
+ *  @param [in]  v       Destinations
+ *  @param [out] storage Schema of "--storage-"
+ *  @param [out] cache   Schema of "--cache-"
+ *  @return Host parser
+ */
+static ArgParser *newHost(Values *v, ArgParser **storage, ArgParser **cache)
+{
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &(v->level), 1, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, v->file, "", sizeof(v->file), NULL, NULL, "file", "File.") == 0);
+
+    *storage = ArgParser_new("storage", "Storage.");
+    TEST_ASSERT(ArgParser_addString(*storage, v->dir, "/var/lib", sizeof(v->dir), "", "--storage-dir", "dir", "Directory.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(*storage, &(v->sync), "", "--storage-sync", "sync", "Sync.") == 0);
+
+    *cache = ArgParser_new("cache", "Cache.");
+    TEST_ASSERT(ArgParser_addInt(*cache, &(v->size), 16, "", "--cache-size", "size", "Size.") == 0);
+
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--storage-", *storage) == 0);
+    TEST_ASSERT(ArgParser_addNamespace(obj, "--cache-", *cache) == 0);
+    return obj;
+}
+
+
+/**
+ *  @brief Compare the leftover arguments of the last parse.
+ *  @param [in] obj      ArgParser object
+ *  @param [in] num      Expected number
+ *  @param [in] expected Expected arguments
+ *  @retval true  Equal
+ *  @retval false Otherwise.
+ */
+static bool isRest(ArgParser *obj, int num, const char **expected)
+{
+    int restNum, i;
+    char **rest;
+
+    if(ArgParser_rest(obj, &restNum, &rest) != 0)
+        return false;
+    if(restNum != num)
+        return false;
+
+    for(i = 0; i < num; i++)
+    {
+        if(strcmp(rest[i], expected[i]) != 0)
+            return false;
+    }
+    return true;
+}
+
+
+/**
+ *  @brief Run this program again in a forked child with a known command line, which parses it
+ *         with ArgParser_parseSelf(). (See runSelfChild())
+ */
+static void testParseSelf(void)
+{
+    static char longArg[SELF_LONG + 1];
+    int status;
+
+    memset(longArg, 'a', SELF_LONG);
+    longArg[SELF_LONG] = '\0';
+
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        char *argv[] = { "unit_test", "namespace", "--level", "3", "", longArg, "--", "-x", NULL };
+        setenv(SELF_ENV, "1", 1);
+        execv("/proc/self/exe", argv);
+        _exit(127);
+    }
+
+    TEST_ASSERT(pid > 0);
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    TEST_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+
+/**
+ *  @brief Parse the own command line of the child, and check it.
+ *  @return Exit status (0: as expected)
+ */
+static int runSelfChild(void)
+{
+    char suite[16], empty[16], tail[SELF_LONG + 1];
+    int level, restNum, i;
+    char **rest;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    if((ArgParser_addInt(obj, &level, 1, "-l", "--level", "level", "Level.") != 0) ||
+       (ArgParser_addString(obj, suite, "", sizeof(suite), NULL, NULL, "suite", "Suite.") != 0) ||
+       (ArgParser_addString(obj, empty, "-", sizeof(empty), NULL, NULL, "empty", "Empty.") != 0) ||
+       (ArgParser_addString(obj, tail, "", sizeof(tail), NULL, NULL, "tail", "Tail.") != 0) ||
+       (ArgParser_collectRest(obj, true) != 0))
+        return 1;
+
+    if((ArgParser_parseSelf(obj) != 0) || (ArgParser_rest(obj, &restNum, &rest) != 0))
+        return 2;
+
+    if((level != 3) || (strcmp(suite, "namespace") != 0) || (empty[0] != '\0'))
+        return 3;
+
+    for(i = 0; (i < SELF_LONG) && (tail[i] == 'a'); i++)
+        ;
+    if((i != SELF_LONG) || (tail[i] != '\0'))
+        return 4;
+
+    if((restNum != 1) || (strcmp(rest[0], "-x") != 0))
+        return 5;
+
+    ArgParser_delete(obj);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ *  @file      test_plan.c
+ *  @brief     Unit tests of the parse-plan cache.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Structs */
+/**
+ *  @brief Destinations of the test schema.
+ */
+typedef struct Values_
+{
+    int  level;     ///< -l/--level
+    char name[16];  ///< -n/--name
+    bool verbose;   ///< -v/--verbose
+    int  count;     ///< Positional
+} Values;
+
+
+/* Signatures */
+static ArgParser *newParser(Values *values, bool usePlanCache);
+static int parseBoth(ArgParser *cached, ArgParser *plain, int argc, char **argv, size_t *plans);
+static size_t planSize(ArgParser *obj);
+
+
+/* Variables */
+static Values cachedValues; ///< Destinations of the parser with the plan cache
+static Values plainValues;  ///< Destinations of the parser without it
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the parse-plan cache.
+ */
+void Test_plan(void)
+{
+    size_t plans;
+
+    ArgParser *cached = newParser(&cachedValues, true);
+    ArgParser *plain  = newParser(&plainValues, false);
+
+    /* Recorded, then replayed with other values. */
+    char *argv1[] = { "test", "--level", "3", "--name", "a", "--verbose", "7", NULL };
+    char *argv2[] = { "test", "--level", "5", "--name", "bb", "--verbose", "9", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv1, &plans) == 0);
+    TEST_ASSERT(plans > 0);
+    TEST_ASSERT((cachedValues.level == 3) && (strcmp(cachedValues.name, "a") == 0) && (cachedValues.count == 7));
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv2, &plans) == 0);
+    TEST_ASSERT(plans == 0);
+    TEST_ASSERT((cachedValues.level == 5) && (strcmp(cachedValues.name, "bb") == 0) && (cachedValues.count == 9));
+
+    /* Another spelling of the same options misses, and makes a plan of its own. */
+    char *argv3[] = { "test", "-l", "4", "-n", "c", "--no-verbose", "1", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv3, &plans) == 0);
+    TEST_ASSERT(plans > 0);
+    TEST_ASSERT((cachedValues.level == 4) && (cachedValues.verbose == false));
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv1, &plans) == 0);
+    TEST_ASSERT(plans == 0);
+
+    /* The same length and leading characters, other spellings. */
+    char *argv4[] = { "test", "--lorem", "3", "--nope", "a", "--verbose", "7", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv4, &plans) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(cached), "--lorem") != NULL);
+
+    /* "--option=value" is parsed, but not recorded. */
+    char *argv5[] = { "test", "--level=6", "--name=d", "2", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 4, argv5, &plans) == 0);
+    TEST_ASSERT(plans == 0);
+    TEST_ASSERT((cachedValues.level == 6) && (strcmp(cachedValues.name, "d") == 0));
+
+    /* A value which starts with '-' is a spelling of the shape. */
+    char *argv6[] = { "test", "--level", "-2", "3", NULL };
+    char *argv7[] = { "test", "--level", "-3", "4", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 4, argv6, &plans) == 0);
+    TEST_ASSERT(cachedValues.level == -2);
+    TEST_ASSERT(parseBoth(cached, plain, 4, argv7, &plans) == 0);
+    TEST_ASSERT(plans > 0);
+    TEST_ASSERT((cachedValues.level == -3) && (cachedValues.count == 4));
+
+    /* A positional slot given a token which starts with '-' fails, as without the cache. */
+    char *argv8[] = { "test", "--level", "5", "--name", "bb", "--verbose", "-9", NULL };
+    TEST_ASSERT(parseBoth(cached, plain, 7, argv8, &plans) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(cached), "-9") != NULL);
+
+    ArgParser_delete(cached);
+    ArgParser_delete(plain);
+}
+
+
+/**
+ *  @brief Create a parser of the test schema.
+ *  @param [in] values       Destinations
+ *  @param [in] usePlanCache If set, the plan cache is enabled.
+ *  @return ArgParser object
+ */
+static ArgParser *newParser(Values *values, bool usePlanCache)
+{
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &(values->level), 1, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, values->name, "", sizeof(values->name), "-n", "--name", "name", "Name.") == 0);
+    TEST_ASSERT(ArgParser_addTrue(obj, &(values->verbose), "-v", "--verbose", "verbose", "Verbose.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &(values->count), 0, NULL, NULL, "count", "Count.") == 0);
+    TEST_ASSERT(ArgParser_setPlanCache(obj, usePlanCache) == 0);
+    return obj;
+}
+
+
+/**
+ *  @brief Parse a command line with and without the plan cache, and compare the results.
+ *  @param [in]  cached Parser with the plan cache
+ *  @param [in]  plain  Parser without it
+ *  @param [in]  argc   Number of command line arguments
+ *  @param [in]  argv   Command line argument array
+ *  @param [out] plans  Growth of the plan cache (0: the command line was replayed or not recorded)
+ *  @return Execution status of the cached parse
+ */
+static int parseBoth(ArgParser *cached, ArgParser *plain, int argc, char **argv, size_t *plans)
+{
+    size_t before = planSize(cached);
+
+    int status = ArgParser_parse(cached, argc, argv);
+    TEST_ASSERT(ArgParser_parse(plain, argc, argv) == status);
+    *plans = planSize(cached) - before;
+
+    if(status == 0)
+    {
+        TEST_ASSERT(cachedValues.level == plainValues.level);
+        TEST_ASSERT(strcmp(cachedValues.name, plainValues.name) == 0);
+        TEST_ASSERT(cachedValues.verbose == plainValues.verbose);
+        TEST_ASSERT(cachedValues.count == plainValues.count);
+    }
+    return status;
+}
+
+
+/**
+ *  @brief Get the size of the plan cache.
+ *  @param [in] obj ArgParser object
+ *  @return Size
+ */
+static size_t planSize(ArgParser *obj)
+{
+    ArgParserMemUsage usage;
+    TEST_ASSERT(ArgParser_memoryUsage(obj, &usage) == 0);
+    return usage.plans;
+}
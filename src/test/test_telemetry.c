@@ -0,0 +1,110 @@
+/**
+ *  @file      test_telemetry.c
+ *  @brief     Unit tests of the option-usage telemetry.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+#include "test.h"
+
+/* Functions */
+/**
+ *  @brief Sum the parse records of a telemetry file.
+ *  @param [in] path Telemetry file
+ *  @return Number of parses
+ */
+static unsigned int countParses(const char *path)
+{
+    unsigned int parses = 0;
+    uint8_t buf[4096];
+    size_t len, pos = 0;
+
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL)
+        return 0;
+    len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    while(pos < len)
+    {
+        uint8_t type = buf[pos++];
+        if(type == APARSER_TELEMETRY_REC_SCHEMA)
+        {
+            uint16_t numOptPrms, numPosPrms;
+            memcpy(&numOptPrms, buf + pos + 4, 2);
+            memcpy(&numPosPrms, buf + pos + 6, 2);
+            pos += 8;
+            for(unsigned int i = 0; i < (unsigned int) numOptPrms + numPosPrms; i++)
+                pos += 1 + buf[pos];
+        }
+        else if(type == APARSER_TELEMETRY_REC_PARSES)
+        {
+            uint32_t n;
+            memcpy(&n, buf + pos + 4, 4);
+            parses += n;
+            pos += 8;
+        }
+        else if(type == APARSER_TELEMETRY_REC_USES)
+            pos += 10;
+        else
+            pos += 4;
+    }
+
+    return parses;
+}
+
+
+/**
+ *  @brief Run the tests of the option-usage telemetry.
+ */
+void Test_telemetry(void)
+{
+    char *given[] = { "test", "--level", "3", NULL };
+    char path[] = "/tmp/arg_parser_test_XXXXXX";
+    int level, status;
+
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+    TEST_ASSERT(ArgParser_enableTelemetry(obj, path) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, given) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, given) == 0);
+
+    /* A forked child exits cleanly, and does not write the counts of the parent again. */
+    fflush(NULL);
+    pid_t pid = fork();
+    if(pid == 0)
+        exit(0);
+    TEST_ASSERT(pid > 0);
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    TEST_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+    TEST_ASSERT(ArgParser_flushTelemetry(obj) == 0);
+    TEST_ASSERT(countParses(path) == 2);
+
+    /* The counts of the child are its own. */
+    pid = fork();
+    if(pid == 0)
+    {
+        ArgParser_parse(obj, 3, given);
+        exit(0);
+    }
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    TEST_ASSERT(countParses(path) == 3);
+
+    ArgParser_delete(obj);
+    unlink(path);
+}
+
@@ -0,0 +1,108 @@
+/**
+ *  @file      test_trace.c
+ *  @brief     Unit tests of the parse tracing.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ArgParser.h"
+#include "test.h"
+
+/* Signatures */
+#if defined(APARSER_TRACE)
+static char *writeToString(ArgParser *obj, int *status);
+#endif
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the parse tracing.
+ */
+void Test_trace(void)
+{
+    char *argv[] = { "test", "--level", "3", NULL };
+    int level;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 7, "-l", "--level", "level", "Level.") == 0);
+
+#if defined(APARSER_TRACE)
+    int status;
+    char *out;
+
+    /* Nothing to write before the tracing is enabled. */
+    FILE *fp = tmpfile();
+    TEST_ASSERT(ArgParser_writeTrace(obj, fp) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "not enabled") != NULL);
+    fclose(fp);
+
+    /* The phases of each token are recorded, and cleared by the write. */
+    TEST_ASSERT(ArgParser_enableTrace(obj, 64) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(level == 3);
+    out = writeToString(obj, &status);
+    TEST_ASSERT(status == 0);
+    TEST_ASSERT(strncmp(out, "{\"traceEvents\":[", 16) == 0);
+    TEST_ASSERT(strstr(out, "\"name\":\"classify\"") != NULL);
+    TEST_ASSERT(strstr(out, "\"name\":\"lookup\"") != NULL);
+    TEST_ASSERT(strstr(out, "\"name\":\"convert\"") != NULL);
+    TEST_ASSERT(strstr(out, "\"token\":1,\"label\":\"--level\"") != NULL);
+    TEST_ASSERT(strstr(out, "\"dropped\":0") != NULL);
+    free(out);
+
+    out = writeToString(obj, &status);
+    TEST_ASSERT(status == 0);
+    TEST_ASSERT(strstr(out, "\"name\"") == NULL);
+    free(out);
+
+    /* The events past the capacity are dropped and counted. */
+    TEST_ASSERT(ArgParser_enableTrace(obj, 1) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    out = writeToString(obj, &status);
+    TEST_ASSERT(status == 0);
+    TEST_ASSERT(strstr(out, "\"dropped\":0") == NULL);
+    free(out);
+
+    /* Capacity 0 disables it. */
+    TEST_ASSERT(ArgParser_enableTrace(obj, 0) == 0);
+    out = writeToString(obj, &status);
+    TEST_ASSERT(status == 1);
+    free(out);
+#else
+    /* Without the hooks, both calls fail with a message, and the parse is unaffected. */
+    TEST_ASSERT(ArgParser_enableTrace(obj, 64) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "APARSER_TRACE") != NULL);
+    TEST_ASSERT(ArgParser_writeTrace(obj, stdout) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "APARSER_TRACE") != NULL);
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(level == 3);
+#endif
+
+    ArgParser_delete(obj);
+}
+
+
+#if defined(APARSER_TRACE)
+/**
+ *  @brief Write the recorded events into a string.
+ *  @param [in]  obj    ArgParser object
+ *  @param [out] status Status of ArgParser_writeTrace()
+ *  @return Output (free() it)
+ */
+static char *writeToString(ArgParser *obj, int *status)
+{
+    char *buf = NULL;
+    size_t len = 0;
+
+    FILE *fp = open_memstream(&buf, &len);
+    *status = ArgParser_writeTrace(obj, fp);
+    fclose(fp);
+
+    return buf;
+}
+#endif
@@ -0,0 +1,270 @@
+/**
+ *  @file      test_utf8.c
+ *  @brief     Unit tests of the UTF-8 validation of string arguments.
+ *             The selected scanner (SSSE3 where supported) is checked against the scalar one.
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+#include "test.h"
+
+/* Macros */
+/**
+ *  @brief Maximum padding around a sequence. (Over a 64-byte block on each side)
+ */
+#define UTF8_MAX_PAD    80
+
+
+/* Structs */
+/**
+ *  @brief Byte sequence and its expected result.
+ */
+typedef struct Utf8Case_
+{
+    const char *bytes;  ///< Sequence
+    int status;         ///< Expected result without the control characters allowed
+} Utf8Case;
+
+
+/* Variables */
+static const Utf8Case cases[] =
+{
+    { "A",                  ArgStatus_OK      },
+    { "\xc2\x80",           ArgStatus_OK      },    // U+0080
+    { "\xdf\xbf",           ArgStatus_OK      },    // U+07FF
+    { "\xe0\xa0\x80",       ArgStatus_OK      },    // U+0800
+    { "\xed\x9f\xbf",       ArgStatus_OK      },    // U+D7FF
+    { "\xee\x80\x80",       ArgStatus_OK      },    // U+E000
+    { "\xef\xbf\xbf",       ArgStatus_OK      },    // U+FFFF
+    { "\xf0\x90\x80\x80",   ArgStatus_OK      },    // U+10000
+    { "\xf0\x9f\x98\x80",   ArgStatus_OK      },    // U+1F600
+    { "\xf4\x8f\xbf\xbf",   ArgStatus_OK      },    // U+10FFFF
+    { "\xc0\x80",           ArgStatus_Utf8    },    // Overlong
+    { "\xc1\xbf",           ArgStatus_Utf8    },
+    { "\xe0\x80\x80",       ArgStatus_Utf8    },
+    { "\xe0\x9f\xbf",       ArgStatus_Utf8    },
+    { "\xf0\x80\x80\x80",   ArgStatus_Utf8    },
+    { "\xf0\x8f\xbf\xbf",   ArgStatus_Utf8    },
+    { "\xed\xa0\x80",       ArgStatus_Utf8    },    // Surrogates
+    { "\xed\xbf\xbf",       ArgStatus_Utf8    },
+    { "\xf4\x90\x80\x80",   ArgStatus_Utf8    },    // Above U+10FFFF
+    { "\xf5\x80\x80\x80",   ArgStatus_Utf8    },
+    { "\xf7\xbf\xbf\xbf",   ArgStatus_Utf8    },
+    { "\xf8\x88\x80\x80\x80", ArgStatus_Utf8  },
+    { "\xfe",               ArgStatus_Utf8    },
+    { "\xff",               ArgStatus_Utf8    },
+    { "\x80",               ArgStatus_Utf8    },    // Lone continuation
+    { "\xc3\xa9\xa9",       ArgStatus_Utf8    },
+    { "\xc3",               ArgStatus_Utf8    },    // Cut sequences
+    { "\xc3" "A",           ArgStatus_Utf8    },
+    { "\xe2\x82",           ArgStatus_Utf8    },
+    { "\xe2" "A" "\xac",    ArgStatus_Utf8    },
+    { "\xf0\x9f\x98",       ArgStatus_Utf8    },
+    { "\xf0\x9f" "A",       ArgStatus_Utf8    },
+    { "\x01",               ArgStatus_Control },    // Control characters
+    { "\t",                 ArgStatus_Control },
+    { "\x1f",               ArgStatus_Control },
+    { "\x7f",               ArgStatus_Control },
+    { "\x1b[31m",           ArgStatus_Control },
+    { "\x01\xc3",           ArgStatus_Utf8    },    // An encoding error takes precedence.
+    { "\xc3\x28\x7f",       ArgStatus_Utf8    },
+};
+
+
+/* Signatures */
+static char *fill(char *dest, size_t len, bool isAscii);
+static unsigned int compareScanners(char *page, size_t pageSize, const Utf8Case *c, bool isAscii);
+static void testScanners(void);
+static void testOption(void);
+
+
+/* Functions */
+/**
+ *  @brief Run the tests of the UTF-8 validation.
+ */
+void Test_utf8(void)
+{
+    testScanners();
+    testOption();
+}
+
+
+/**
+ *  @brief Compare the selected scanner with the scalar one, with each case at every offset
+ *         around the 16- and 64-byte boundaries, in strings which end at a page boundary
+ *         (followed by an inaccessible page) and in strings surrounded by invalid bytes.
+ */
+static void testScanners(void)
+{
+    size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t i;
+
+    char *map = (char *) mmap(NULL, pageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_ASSERT(map != MAP_FAILED);
+    if(map == MAP_FAILED)
+        return;
+    TEST_ASSERT(mprotect(map + pageSize, pageSize, PROT_NONE) == 0);
+
+    TEST_ASSERT(ArgParserText_select() != NULL);
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        TEST_ASSERT(compareScanners(map, pageSize, &cases[i], true) == 0);
+        TEST_ASSERT(compareScanners(map, pageSize, &cases[i], false) == 0);
+    }
+
+    munmap(map, pageSize * 2);
+}
+
+
+/**
+ *  @brief Scan a case with the padding of every length before and after it.
+ *  @param [in] page     Accessible page (followed by an inaccessible one)
+ *  @param [in] pageSize Page size
+ *  @param [in] c        Case
+ *  @param [in] isAscii  If set, the padding is ASCII; otherwise, 2-byte sequences.
+ *  @return Number of the mismatches
+ */
+static unsigned int compareScanners(char *page, size_t pageSize, const Utf8Case *c, bool isAscii)
+{
+    TextScanFn scanScalar = ArgParserText_scalar();
+    TextScanFn scanSelected = ArgParserText_select();
+    size_t bytesLen = strlen(c->bytes);
+    unsigned int mismatches = 0;
+    size_t pre, post;
+    int place, allow;
+
+    for(pre = 0; pre <= UTF8_MAX_PAD; pre++)
+    {
+        for(post = 0; post <= UTF8_MAX_PAD; post++)
+        {
+            size_t len = pre + bytesLen + post;
+
+            for(place = 0; place < 2; place++)
+            {
+                char *str;
+                if(place == 0)
+                {
+                    // The terminator is the last byte of the page.
+                    str = page + pageSize - len - 1;
+                }
+                else
+                {
+                    // Invalid bytes before and after it, in the same 16-byte blocks.
+                    memset(page, 0xff, len + 64);
+                    str = page + 17 + (pre % 16);
+                }
+
+                char *p = fill(str, pre, isAscii);
+                memcpy(p, c->bytes, bytesLen);
+                fill(p + bytesLen, post, isAscii);
+                str[len] = '\0';
+
+                for(allow = 0; allow < 2; allow++)
+                {
+                    int expected = ((c->status == ArgStatus_Control) && (allow == 1)) ? ArgStatus_OK : c->status;
+                    int scalarStatus, selectedStatus;
+                    size_t scalarLen = scanScalar(str, (allow == 1), &scalarStatus);
+                    size_t selectedLen = scanSelected(str, (allow == 1), &selectedStatus);
+
+                    if((scalarLen != len) || (selectedLen != len) || (scalarStatus != expected) || (selectedStatus != expected))
+                        mismatches++;
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+
+/**
+ *  @brief Fill valid padding.
+ *  @param [out] dest    Destination
+ *  @param [in]  len     Length in bytes
+ *  @param [in]  isAscii If set, 'a'; otherwise, U+00E9 (an odd length starts with 'a').
+ *  @return End of the padding
+ */
+static char *fill(char *dest, size_t len, bool isAscii)
+{
+    size_t i = 0;
+
+    if(isAscii == true)
+    {
+        memset(dest, 'a', len);
+        return dest + len;
+    }
+
+    if((len % 2) != 0)
+        dest[i++] = 'a';
+
+    for(; i < len; i += 2)
+    {
+        dest[i]     = (char) 0xc3;
+        dest[i + 1] = (char) 0xa9;
+    }
+
+    return dest + len;
+}
+
+
+/**
+ *  @brief Run the tests of ArgParser_setUtf8().
+ */
+static void testOption(void)
+{
+    char *argv[] = { "test", "--name", NULL, NULL };
+    char name[128], path[128];
+    int level;
+
+    ArgParser *obj = ArgParser_new("test", "Test.");
+    TEST_ASSERT(ArgParser_addString(obj, name, "", sizeof(name), "-n", "--name", "name", "Name.") == 0);
+    TEST_ASSERT(ArgParser_addString(obj, path, "", sizeof(path), "-p", "--path", "path", "Path.") == 0);
+    TEST_ASSERT(ArgParser_addInt(obj, &level, 1, "-l", "--level", "level", "Level.") == 0);
+
+    /* Only the string parameters can be validated. */
+    TEST_ASSERT(ArgParser_setUtf8(obj, "level", false) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "not a string") != NULL);
+    TEST_ASSERT(ArgParser_setUtf8(obj, "unknown", false) == 1);
+
+    /* Without the validation, any bytes pass. */
+    argv[2] = "\xff\x01";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(strcmp(name, "\xff\x01") == 0);
+
+    TEST_ASSERT(ArgParser_setUtf8(obj, "name", false) == 0);
+    argv[2] = "caf\xc3\xa9 \xf0\x9f\x98\x80";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(strcmp(name, argv[2]) == 0);
+
+    /* The invalid bytes are not echoed in the message. */
+    argv[2] = "\xed\xa0\x80";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "Invalid UTF-8") != NULL);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), argv[2]) == NULL);
+
+    argv[2] = "a\x1b[2J";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 1);
+    TEST_ASSERT(strstr(ArgParser_getErrorMsg(obj), "control character") != NULL);
+
+    /* The control characters can be allowed; the encoding is still checked. */
+    TEST_ASSERT(ArgParser_setUtf8(obj, "name", true) == 0);
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+    TEST_ASSERT(strcmp(name, "a\x1b[2J") == 0);
+    argv[2] = "\xf4\x90\x80\x80";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 1);
+
+    /* The other parameters are not validated. */
+    argv[1] = "--path";
+    argv[2] = "\xff";
+    TEST_ASSERT(ArgParser_parse(obj, 3, argv) == 0);
+
+    ArgParser_delete(obj);
+}
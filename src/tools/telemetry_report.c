@@ -0,0 +1,247 @@
+/**
+ *  @file      telemetry_report.c
+ *  @brief     Aggregator of the option-usage telemetry files.
+ *             Sums the records of all given files, and prints the uses of each parameter
+ *             per schema, the unused ones marked. (Run on the host which wrote the files.)
+ *  @author    fire-peregrine
+ *  @date      2020/11/01
+ *  @copyright Copyright (C) peregrine all rights reserved.
+ *             Released under the MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ArgParser.h"
+#include "ArgParser_local.h"
+
+/* Macros */
+/**
+ *  @brief Maximum number of schemas in a report.
+ */
+#define REPORT_MAX_SCHEMAS  1024
+
+
+/* Structs */
+/**
+ *  @brief Aggregated schema
+ */
+typedef struct Schema_
+{
+    uint32_t      id;         ///< Schema ID
+    unsigned int  numOptPrms; ///< Number of optional parameters
+    unsigned int  numPosPrms; ///< Number of positional parameters
+    char         *names[2 * APARSER_MAX_ARG_PRMS]; ///< Parameter names (NULL: no schema record yet)
+    uint64_t      parses;     ///< Parses
+    uint64_t      uses[2 * APARSER_MAX_ARG_PRMS];  ///< Uses by parameter index
+} Schema;
+
+
+/* Variables */
+static Schema   schemas[REPORT_MAX_SCHEMAS];
+static unsigned int numSchemas;
+static uint64_t numDropped;
+
+
+/* Signatures */
+static Schema* findSchema(uint32_t id);
+static int readFile(const char *path);
+static void printReport(FILE *fp);
+
+
+/* Functions */
+/**
+ *  @brief Main function.
+ *  @param [in] argc   Number of command line arguments
+ *  @param [in] argv[] Command line argument array
+ *  @return Exit status
+ */
+int main(int argc, char **argv)
+{
+    int i;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <telemetry_file> ...\n", argv[0]);
+        return 1;
+    }
+
+    for(i = 1; i < argc; i++)
+    {
+        if(readFile(argv[i]) != 0)
+            return 1;
+    }
+
+    printReport(stdout);
+    return 0;
+}
+
+
+/**
+ *  @brief Find a schema, or add a new one.
+ *  @param [in] id Schema ID
+ *  @return Schema if success, NULL otherwise.
+ */
+static Schema* findSchema(uint32_t id)
+{
+    unsigned int i;
+    for(i = 0; i < numSchemas; i++)
+    {
+        if(schemas[i].id == id)
+            return &(schemas[i]);
+    }
+
+    if(numSchemas == REPORT_MAX_SCHEMAS)
+    {
+        fprintf(stderr, "Error: Too many schemas.\n");
+        return NULL;
+    }
+
+    Schema *schema = &(schemas[numSchemas++]);
+    schema->id = id;
+    return schema;
+}
+
+
+/**
+ *  @brief Read a telemetry file and sum its records.
+ *  @param [in] path File path
+ *  @return Execution status
+ */
+static int readFile(const char *path)
+{
+    uint8_t type;
+    uint32_t id, count;
+    uint16_t idx, numOpt, numPos;
+    unsigned int i;
+
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        fprintf(stderr, "Error: Cannot open '%s'.\n", path);
+        return 1;
+    }
+
+    #define GET(var) do { if(fread(&(var), sizeof(var), 1, fp) != 1) goto error; } while(0)
+
+    while(fread(&type, 1, 1, fp) == 1)
+    {
+        switch(type)
+        {
+            case APARSER_TELEMETRY_REC_SCHEMA:
+            {
+                GET(id);
+                GET(numOpt);
+                GET(numPos);
+                if((numOpt > APARSER_MAX_ARG_PRMS) || (numPos > APARSER_MAX_ARG_PRMS))
+                    goto error;
+
+                Schema *schema = findSchema(id);
+                if(schema == NULL)
+                    goto error;
+
+                schema->numOptPrms = numOpt;
+                schema->numPosPrms = numPos;
+                for(i = 0; i < (unsigned int) (numOpt + numPos); i++)
+                {
+                    uint8_t len;
+                    GET(len);
+
+                    char *name = (char *) malloc(len + 1);
+                    if((name == NULL) || (fread(name, 1, len, fp) != len))
+                    {
+                        free(name);
+                        goto error;
+                    }
+                    name[len] = '\0';
+
+                    // Positional parameters are indexed after all optional slots.
+                    unsigned int slot = (i < numOpt) ? i : (APARSER_MAX_ARG_PRMS + i - numOpt);
+                    free(schema->names[slot]);
+                    schema->names[slot] = name;
+                }
+                break;
+            }
+
+            case APARSER_TELEMETRY_REC_PARSES:
+            {
+                GET(id);
+                GET(count);
+
+                Schema *schema = findSchema(id);
+                if(schema == NULL)
+                    goto error;
+                schema->parses += count;
+                break;
+            }
+
+            case APARSER_TELEMETRY_REC_USES:
+            {
+                GET(id);
+                GET(idx);
+                GET(count);
+                if(idx >= 2 * APARSER_MAX_ARG_PRMS)
+                    goto error;
+
+                Schema *schema = findSchema(id);
+                if(schema == NULL)
+                    goto error;
+                schema->uses[idx] += count;
+                break;
+            }
+
+            case APARSER_TELEMETRY_REC_DROPPED:
+                GET(count);
+                numDropped += count;
+                break;
+
+            default:
+                goto error;
+        }
+    }
+
+    #undef GET
+
+    fclose(fp);
+    return 0;
+
+error: /* error handling */
+
+    fprintf(stderr, "Error: Broken telemetry file '%s' at offset %ld.\n", path, ftell(fp));
+    fclose(fp);
+    return 1;
+}
+
+
+/**
+ *  @brief Print the uses of each parameter per schema.
+ *  @param [in] fp Output file pointer
+ */
+static void printReport(FILE *fp)
+{
+    unsigned int i, j;
+
+    for(i = 0; i < numSchemas; i++)
+    {
+        Schema *schema = &(schemas[i]);
+        fprintf(fp, "schema %08x: %llu parses\n", schema->id, (unsigned long long) schema->parses);
+
+        for(j = 0; j < 2 * APARSER_MAX_ARG_PRMS; j++)
+        {
+            bool isDefined = (j < APARSER_MAX_ARG_PRMS) ? (j < schema->numOptPrms) : (j - APARSER_MAX_ARG_PRMS < schema->numPosPrms);
+            if((isDefined == false) && (schema->uses[j] == 0))
+                continue;
+
+            double ratio = (schema->parses != 0) ? (100.0 * schema->uses[j] / schema->parses) : 0.0;
+            fprintf(fp, "    %-32s %12llu %7.2f%%%s\n",
+                    (schema->names[j] != NULL) ? schema->names[j] : "(unknown)",
+                    (unsigned long long) schema->uses[j], ratio,
+                    (schema->uses[j] == 0) ? "  unused" : "");
+        }
+        fprintf(fp, "\n");
+    }
+
+    if(numDropped != 0)
+        fprintf(fp, "dropped: %llu entries (the ring buffer was full)\n", (unsigned long long) numDropped);
+}